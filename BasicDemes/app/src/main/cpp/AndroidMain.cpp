@@ -40,9 +40,10 @@ void android_main(struct android_app* app) {
   int events;
   android_poll_source* source;
 
-  // Main loop
+  // Main loop: render without waiting while Vulkan is ready, otherwise block
+  // until the next app command instead of spinning
   do {
-    if (ALooper_pollOnce(IsVulkanReady() ? 1 : 0, nullptr,
+    if (ALooper_pollOnce(IsVulkanReady() ? 0 : -1, nullptr,
                         &events, (void**)&source) >= 0) {
       if (source != NULL) source->process(app, source);
     }
@@ -0,0 +1,192 @@
+/*
+ * cullbench
+ * Times the frustum culling kernels over bounding sphere and box arrays
+ *
+ *   cullbench [--counts 1000,10000,100000,1000000] [--workers <n>] [--chunk 16384] [--repeat 50]
+ *
+ * Every count is run with the scalar kernel, the SIMD kernel on one thread and the
+ * chunked cull() on the job system (one worker per fast core by default), over
+ * bounds scattered around the camera so that about a third of them are visible.
+ * The SIMD results are checked against the scalar ones. Exit codes: 0 pass,
+ * 1 mismatch, 2 usage.
+ */
+
+#include "FrustumCuller.hpp"
+#include "MatrixUtils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int EXIT_PASS = 0;
+constexpr int EXIT_MISMATCH = 1;
+constexpr int EXIT_USAGE = 2;
+
+struct Options {
+    std::vector<uint32_t> counts = {1000, 10000, 100000, 1000000};
+    uint32_t workers = JobSystem::AUTO;
+    uint32_t chunk = 16384;
+    uint32_t repeat = 50;
+};
+
+void printUsage() {
+    fprintf(stderr, "usage: cullbench [--counts <n,n,...>] [--workers <n>] [--chunk <n>] [--repeat <n>]\n");
+}
+
+bool parseUint(const char *text, uint32_t &value, bool allowZero = false) {
+    char *end = nullptr;
+    unsigned long number = strtoul(text, &end, 10);
+    if (end == text || (number == 0 && !allowZero) || number >= UINT32_MAX) {
+        return false;
+    }
+    value = static_cast<uint32_t>(number);
+    return *end == '\0' || *end == ',';
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--counts") == 0) {
+            options.counts.clear();
+            for (const char *item = value; item != nullptr; item = strchr(item, ',')) {
+                if (*item == ',') {
+                    item++;
+                }
+                uint32_t count;
+                if (!parseUint(item, count)) {
+                    return false;
+                }
+                options.counts.push_back(count);
+            }
+        } else if (strcmp(arg, "--workers") == 0) {
+            if (!parseUint(value, options.workers, true)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--chunk") == 0) {
+            if (!parseUint(value, options.chunk)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--repeat") == 0) {
+            if (!parseUint(value, options.repeat)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Camera at the origin looking down -z, as the sample's camera does
+Frustum createFrustum() {
+    float projection[16];
+    float view[16];
+    float viewProjection[16];
+    createPerspectiveMatrix(projection, 60.0f * 3.14159265f / 180.0f, 16.0f / 9.0f, 0.1f, 256.0f);
+    projection[5] *= -1.0f;
+    createLookAtMatrix(view, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f);
+    multiplyMatrix(viewProjection, projection, view);
+    return Frustum::fromMatrix(viewProjection);
+}
+
+// Bounds in a box around the camera reaching past the far plane
+void createBounds(uint32_t count, BoundingSpheres &spheres, BoundingBoxes &boxes) {
+    std::mt19937 random(count);
+    std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+    std::uniform_real_distribution<float> depth(-300.0f, 20.0f);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+    spheres.resize(count);
+    boxes.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        float x = position(random);
+        float y = position(random);
+        float z = depth(random);
+        float r = size(random);
+        spheres.set(i, x, y, z, r);
+        const float min[3] = {x - r, y - 0.5f * r, z - r};
+        const float max[3] = {x + r, y + 0.5f * r, z + r};
+        boxes.set(i, min, max);
+    }
+}
+
+// Median wall time of repeat calls in milliseconds
+template <typename Function>
+double measure(uint32_t repeat, Function &&function) {
+    std::vector<double> samples(repeat);
+    for (double &sample: samples) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        sample = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    std::nth_element(samples.begin(), samples.begin() + repeat / 2, samples.end());
+    return samples[repeat / 2];
+}
+
+template <typename Bounds>
+bool run(const char *name, const Frustum &frustum, const Bounds &bounds, JobSystem &jobs, const Options &options) {
+    const uint32_t count = bounds.size();
+    std::vector<uint32_t> scalarVisible(count);
+    std::vector<uint32_t> simdVisible(count);
+    std::vector<uint32_t> parallelVisible;
+    FrustumCuller culler;
+    culler.setJobSystem(&jobs);
+    culler.setChunkSize(options.chunk);
+
+    uint32_t scalarCount = 0;
+    uint32_t simdCount = 0;
+    double scalarMs = measure(options.repeat, [&]() {
+        scalarCount = FrustumCuller::cullRangeScalar(frustum, bounds, 0, count, scalarVisible.data());
+    });
+    double simdMs = measure(options.repeat, [&]() {
+        simdCount = FrustumCuller::cullRange(frustum, bounds, 0, count, simdVisible.data());
+    });
+    double parallelMs = measure(options.repeat, [&]() {
+        culler.cull(frustum, bounds, parallelVisible);
+    });
+
+    bool match = simdCount == scalarCount && parallelVisible.size() == scalarCount &&
+                 std::equal(scalarVisible.begin(), scalarVisible.begin() + scalarCount, simdVisible.begin()) &&
+                 std::equal(parallelVisible.begin(), parallelVisible.end(), scalarVisible.begin());
+    printf("  %-7s %8u  visible %8u  scalar %8.3f ms  simd %8.3f ms (%4.1fx)  parallel %8.3f ms (%4.1fx)  %s\n",
+           name, count, scalarCount, scalarMs, simdMs, scalarMs / simdMs, parallelMs, scalarMs / parallelMs,
+           match ? "ok" : "MISMATCH");
+    return match;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_USAGE;
+    }
+
+    JobSystem jobs;
+    jobs.start(options.workers);
+    const CpuTopology &topology = jobs.getTopology();
+    printf("kernels: %s, parallel: %u workers (%zu of %u cores fast), %u bounds per chunk, median of %u runs\n",
+           FrustumCuller::getSimdName(), jobs.getWorkerCount(), topology.fastCores.size(), topology.coreCount,
+           options.chunk, options.repeat);
+    Frustum frustum = createFrustum();
+    bool passed = true;
+    for (uint32_t count: options.counts) {
+        BoundingSpheres spheres;
+        BoundingBoxes boxes;
+        createBounds(count, spheres, boxes);
+        passed = run("spheres", frustum, spheres, jobs, options) && passed;
+        passed = run("boxes", frustum, boxes, jobs, options) && passed;
+    }
+    return passed ? EXIT_PASS : EXIT_MISMATCH;
+}
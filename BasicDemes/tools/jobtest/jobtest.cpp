@@ -0,0 +1,192 @@
+/*
+ * jobtest
+ * Stress test of the job system and the startup scheduler running on it
+ *
+ *   jobtest [--workers <n>] [--iterations 300]
+ *
+ * Every iteration runs nested parallelFor() calls, a continuation chain ending in a
+ * main thread job and a startup task graph with a main thread task, then jobs are
+ * submitted from a thread outside the pool and stop() has to run what is still
+ * queued. Meant to be built with ThreadSanitizer as well (JOBTEST_TSAN in
+ * CMakeLists.txt). Exit codes: 0 pass, 1 failure, 2 usage.
+ */
+
+#include "JobSystem.hpp"
+#include "StartupScheduler.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+constexpr int EXIT_PASS = 0;
+constexpr int EXIT_FAILURE_FOUND = 1;
+constexpr int EXIT_USAGE = 2;
+
+struct Options {
+    uint32_t workers = JobSystem::AUTO;
+    uint32_t iterations = 300;
+};
+
+void printUsage() {
+    fprintf(stderr, "usage: jobtest [--workers <n>] [--iterations <n>]\n");
+}
+
+bool parseUint(const char *text, uint32_t &value, bool allowZero = false) {
+    char *end = nullptr;
+    unsigned long number = strtoul(text, &end, 10);
+    if (end == text || *end != '\0' || (number == 0 && !allowZero) || number >= UINT32_MAX) {
+        return false;
+    }
+    value = static_cast<uint32_t>(number);
+    return true;
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--workers") == 0) {
+            if (!parseUint(value, options.workers, true)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--iterations") == 0) {
+            if (!parseUint(value, options.iterations)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t failures = 0;
+
+void check(bool condition, const char *what, uint32_t iteration) {
+    if (!condition) {
+        printf("  FAILED %s (iteration %u)\n", what, iteration);
+        failures++;
+    }
+}
+
+// Every index of an inner parallelFor per outer range is visited exactly once
+void testNestedParallelFor(JobSystem &jobs, uint32_t iteration) {
+    constexpr uint32_t COUNT = 1000;
+    std::atomic<uint64_t> sum{0};
+    jobs.parallelFor(COUNT, 7, [&](uint32_t begin, uint32_t end) {
+        jobs.parallelFor(end - begin, 2, [&, begin](uint32_t innerBegin, uint32_t innerEnd) {
+            for (uint32_t i = innerBegin; i < innerEnd; i++) {
+                sum += begin + i;
+            }
+        });
+    });
+    check(sum.load() == uint64_t(COUNT - 1) * COUNT / 2, "nested parallelFor", iteration);
+}
+
+// Ten jobs, a continuation after them and a main thread continuation after that
+void testContinuations(JobSystem &jobs, uint32_t iteration) {
+    JobCounter first;
+    JobCounter second;
+    JobCounter last;
+    std::atomic<uint32_t> stage{0};
+    std::atomic<bool> secondInOrder{false};
+    std::atomic<bool> lastInOrder{false};
+    std::atomic<uint32_t> lastThread{JobSystem::NOT_IN_POOL};
+    for (uint32_t i = 0; i < 10; i++) {
+        jobs.submit([&]() { stage++; }, &first);
+    }
+    jobs.continueWith(first, [&]() {
+        secondInOrder = stage.load() == 10;
+        stage += 100;
+    }, &second);
+    jobs.continueWith(second, [&]() {
+        lastInOrder = stage.load() == 110;
+        lastThread = jobs.getThreadIndex();
+    }, &last, true);
+    jobs.wait(last);
+    check(secondInOrder && lastInOrder, "continuation order", iteration);
+    check(lastThread.load() == 0, "main thread continuation", iteration);
+}
+
+// A chain of two tasks, a main thread task after both and eight tasks fanning out
+void testStartupScheduler(JobSystem &jobs, uint32_t iteration) {
+    StartupScheduler scheduler;
+    std::atomic<uint32_t> order{0};
+    uint32_t first = 0;
+    uint32_t second = 0;
+    uint32_t third = 0;
+    StartupScheduler::TaskId a = scheduler.add("a", [&]() { first = order++; });
+    StartupScheduler::TaskId b = scheduler.add("b", [&]() { second = order++; }, {a});
+    scheduler.add("c", [&]() { third = order++; }, {a, b}, true);
+    for (uint32_t i = 0; i < 8; i++) {
+        scheduler.add("fan out", [&]() { order++; }, {a});
+    }
+    scheduler.run(jobs);
+
+    check(first < second && second < third, "startup task order", iteration);
+    check(scheduler.getTimeline().size() == 11, "startup timeline size", iteration);
+    for (const auto &entry: scheduler.getTimeline()) {
+        if (entry.name == "c") {
+            check(entry.thread == 0, "startup main thread task", iteration);
+        }
+    }
+}
+
+// Jobs submitted and waited for by a thread outside the pool
+void testForeignThread(JobSystem &jobs) {
+    JobCounter counter;
+    std::atomic<uint32_t> count{0};
+    std::thread thread([&]() {
+        for (uint32_t i = 0; i < 100; i++) {
+            jobs.submit([&]() { count++; }, &counter);
+        }
+        jobs.wait(counter);
+    });
+    thread.join();
+    check(count.load() == 100, "submit from outside the pool", 0);
+}
+
+// stop() runs the queued main thread jobs and any continuations they queue
+void testStop(JobSystem &jobs) {
+    std::atomic<uint32_t> count{0};
+    JobCounter counter;
+    for (uint32_t i = 0; i < 10; i++) {
+        jobs.submit([&]() { count++; }, &counter, true);
+    }
+    jobs.continueWith(counter, [&]() { count++; });
+    jobs.stop();
+    check(count.load() == 11, "jobs left to stop()", 0);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_USAGE;
+    }
+
+    JobSystem jobs;
+    jobs.start(options.workers);
+    const CpuTopology &topology = jobs.getTopology();
+    printf("%u workers (%zu of %u cores fast), %u iterations\n", jobs.getWorkerCount(),
+           topology.fastCores.size(), topology.coreCount, options.iterations);
+
+    for (uint32_t iteration = 0; iteration < options.iterations; iteration++) {
+        testNestedParallelFor(jobs, iteration);
+        testContinuations(jobs, iteration);
+        testStartupScheduler(jobs, iteration);
+    }
+    testForeignThread(jobs);
+    testStop(jobs);
+
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? EXIT_PASS : EXIT_FAILURE_FOUND;
+}
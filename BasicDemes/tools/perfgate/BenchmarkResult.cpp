@@ -0,0 +1,221 @@
+/*
+ * Benchmark Result Implementation
+ */
+
+#include "BenchmarkResult.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Just enough JSON for flat objects of strings, numbers and number arrays; any other
+// value is parsed and skipped
+class Parser {
+public:
+    explicit Parser(const std::string &text) : text(text) {}
+
+    bool parse(BenchmarkResult &result, std::string &error) {
+        if (!expect('{')) {
+            return fail(error, "expected an object");
+        }
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            std::string key;
+            if (!parseString(key) || !expect(':')) {
+                return fail(error, "expected a key");
+            }
+            bool ok;
+            if (key == "scenario") {
+                ok = parseString(result.scenario);
+            } else if (key == "device") {
+                ok = parseString(result.device);
+            } else if (key == "driverVersion") {
+                ok = parseUint(result.driverVersion);
+            } else if (key == "width") {
+                ok = parseUint(result.width);
+            } else if (key == "height") {
+                ok = parseUint(result.height);
+            } else if (key == "cpuFrameMs") {
+                ok = parseNumbers(result.cpuFrameMs);
+            } else if (key == "gpuFrameMs") {
+                ok = parseNumbers(result.gpuFrameMs);
+            } else {
+                ok = skipValue();
+            }
+            if (!ok) {
+                return fail(error, "bad value for \"" + key + "\"");
+            }
+        } while (consume(','));
+        if (!expect('}')) {
+            return fail(error, "expected '}'");
+        }
+        skipWhitespace();
+        if (position != text.size()) {
+            return fail(error, "trailing characters");
+        }
+        return true;
+    }
+
+private:
+    const std::string &text;
+    size_t position = 0;
+
+    bool fail(std::string &error, const std::string &message) const {
+        error = message + " at offset " + std::to_string(position);
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (position < text.size() && isspace(static_cast<unsigned char>(text[position]))) {
+            position++;
+        }
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (position < text.size() && text[position] == c) {
+            position++;
+            return true;
+        }
+        return false;
+    }
+
+    bool expect(char c) { return consume(c); }
+
+    bool parseString(std::string &value) {
+        if (!consume('"')) {
+            return false;
+        }
+        value.clear();
+        while (position < text.size() && text[position] != '"') {
+            char c = text[position++];
+            if (c == '\\') {
+                if (position >= text.size()) {
+                    return false;
+                }
+                c = text[position++];
+                switch (c) {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'u':
+                        // Not produced by the writer; keep the escape as text
+                        value += "\\u";
+                        continue;
+                    default: break;
+                }
+            }
+            value += c;
+        }
+        return consume('"');
+    }
+
+    bool parseNumber(double &value) {
+        skipWhitespace();
+        const char *start = text.c_str() + position;
+        char *end = nullptr;
+        value = strtod(start, &end);
+        if (end == start) {
+            return false;
+        }
+        position += static_cast<size_t>(end - start);
+        return true;
+    }
+
+    bool parseUint(uint32_t &value) {
+        double number;
+        if (!parseNumber(number) || number < 0.0 || number > 4294967295.0) {
+            return false;
+        }
+        value = static_cast<uint32_t>(number);
+        return true;
+    }
+
+    bool parseNumbers(std::vector<double> &values) {
+        values.clear();
+        if (!consume('[')) {
+            return false;
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            double number;
+            if (!parseNumber(number)) {
+                return false;
+            }
+            values.push_back(number);
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool skipValue() {
+        skipWhitespace();
+        if (position >= text.size()) {
+            return false;
+        }
+        char c = text[position];
+        if (c == '"') {
+            std::string ignored;
+            return parseString(ignored);
+        }
+        if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            position++;
+            if (consume(close)) {
+                return true;
+            }
+            do {
+                if (c == '{') {
+                    std::string key;
+                    if (!parseString(key) || !expect(':')) {
+                        return false;
+                    }
+                }
+                if (!skipValue()) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(close);
+        }
+        for (const char *literal: {"true", "false", "null"}) {
+            if (text.compare(position, strlen(literal), literal) == 0) {
+                position += strlen(literal);
+                return true;
+            }
+        }
+        double ignored;
+        return parseNumber(ignored);
+    }
+};
+
+}  // namespace
+
+bool BenchmarkResult::load(const std::string &path, BenchmarkResult &result, std::string &error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    result = BenchmarkResult();
+    Parser parser(text);
+    if (!parser.parse(result, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    if (result.cpuFrameMs.empty()) {
+        error = path + ": no CPU frame time samples";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+/*
+ * Benchmark Result
+ * Frame time samples of one benchmark run, as written by FrameBenchmark on the device
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One scenario's benchmark run, loaded from JSON
+ *
+ * The format is the one FrameBenchmark writes (triangle/src/main/cpp/FrameBenchmark.cpp):
+ * a flat object with the scenario, device description and the cpuFrameMs and
+ * gpuFrameMs sample arrays. Unknown keys are ignored so the format can grow.
+ * gpuFrameMs is empty on devices without timestamp queries.
+ */
+struct BenchmarkResult {
+    std::string scenario;
+    std::string device;
+    uint32_t driverVersion = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<double> cpuFrameMs;
+    std::vector<double> gpuFrameMs;
+
+    // Returns false with a message in error if the file is missing or malformed
+    static bool load(const std::string &path, BenchmarkResult &result, std::string &error);
+};
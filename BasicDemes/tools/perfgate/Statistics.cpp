@@ -0,0 +1,69 @@
+/*
+ * Statistics Implementation
+ */
+
+#include "Statistics.hpp"
+#include <algorithm>
+#include <random>
+
+double Statistics::median(std::vector<double> samples) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    size_t middle = samples.size() / 2;
+    std::nth_element(samples.begin(), samples.begin() + middle, samples.end());
+    double upper = samples[middle];
+    if (samples.size() % 2 != 0) {
+        return upper;
+    }
+    double lower = *std::max_element(samples.begin(), samples.begin() + middle);
+    return (lower + upper) * 0.5;
+}
+
+Statistics::Comparison Statistics::compareMedians(const std::vector<double> &baseline,
+                                                  const std::vector<double> &current,
+                                                  uint32_t iterations, double confidence,
+                                                  uint64_t seed) {
+    Comparison comparison;
+    comparison.baselineMedian = median(baseline);
+    comparison.currentMedian = median(current);
+    if (baseline.empty() || current.empty() || comparison.baselineMedian <= 0.0) {
+        return comparison;
+    }
+    comparison.ratio = comparison.currentMedian / comparison.baselineMedian;
+
+    std::mt19937_64 random(seed);
+    std::vector<double> resampled;
+    auto resampledMedian = [&](const std::vector<double> &samples) {
+        std::uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+        resampled.resize(samples.size());
+        for (double &value: resampled) {
+            value = samples[pick(random)];
+        }
+        return median(resampled);
+    };
+
+    std::vector<double> ratios;
+    ratios.reserve(iterations);
+    for (uint32_t i = 0; i < iterations; i++) {
+        double baselineMedian = resampledMedian(baseline);
+        double currentMedian = resampledMedian(current);
+        if (baselineMedian > 0.0) {
+            ratios.push_back(currentMedian / baselineMedian);
+        }
+    }
+    if (ratios.empty()) {
+        return comparison;
+    }
+
+    // Percentile interval
+    std::sort(ratios.begin(), ratios.end());
+    double tail = (1.0 - confidence) * 0.5;
+    auto percentile = [&](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(ratios.size() - 1) + 0.5);
+        return ratios[std::min(index, ratios.size() - 1)];
+    };
+    comparison.ratioLow = percentile(tail);
+    comparison.ratioHigh = percentile(1.0 - tail);
+    return comparison;
+}
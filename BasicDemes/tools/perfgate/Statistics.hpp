@@ -0,0 +1,36 @@
+/*
+ * Statistics
+ * Robust comparison of two frame time distributions
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Median based comparison of a new run against a baseline
+ *
+ * Frame times are skewed and have outliers (a missed vsync, a thermal step), so
+ * runs are compared by their medians rather than their means. The uncertainty of
+ * the ratio current / baseline median comes from a percentile bootstrap: both
+ * sample sets are resampled with replacement and the ratio recomputed many times.
+ * The random generator is seeded, so a comparison is reproducible.
+ */
+class Statistics {
+public:
+    struct Comparison {
+        double baselineMedian = 0.0;
+        double currentMedian = 0.0;
+        double ratio = 1.0;     // current / baseline median
+        double ratioLow = 1.0;  // Bootstrap confidence interval of the ratio
+        double ratioHigh = 1.0;
+    };
+
+    static double median(std::vector<double> samples);
+
+    static Comparison compareMedians(const std::vector<double> &baseline,
+                                     const std::vector<double> &current,
+                                     uint32_t iterations = 2000, double confidence = 0.95,
+                                     uint64_t seed = 1);
+};
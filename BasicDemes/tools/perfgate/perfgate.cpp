@@ -0,0 +1,177 @@
+/*
+ * perfgate
+ * Compares a benchmark run against the stored baseline of its scenario
+ *
+ *   perfgate compare --baseline <json> --current <json> [--threshold 0.05] [--gpu-threshold 0.05]
+ *   perfgate record --current <json> --baseline <json>
+ *
+ * Exit codes: 0 pass, 1 regression, 2 usage or malformed input, 77 baseline or run
+ * missing (reported by CTest as skipped).
+ */
+
+#include "BenchmarkResult.hpp"
+#include "Statistics.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+
+constexpr int EXIT_PASS = 0;
+constexpr int EXIT_REGRESSION = 1;
+constexpr int EXIT_USAGE = 2;
+constexpr int EXIT_SKIP = 77;
+
+struct Options {
+    std::string command;
+    std::string baseline;
+    std::string current;
+    double threshold = 0.05;
+    double gpuThreshold = -1.0;  // Defaults to threshold
+};
+
+void printUsage() {
+    fprintf(stderr,
+            "usage: perfgate compare --baseline <json> --current <json> [--threshold <fraction>]"
+            " [--gpu-threshold <fraction>]\n"
+            "       perfgate record --current <json> --baseline <json>\n");
+}
+
+bool parseFraction(const char *text, double &value) {
+    char *end = nullptr;
+    value = strtod(text, &end);
+    return end != text && *end == '\0' && value >= 0.0;
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.command = argv[1];
+    if (options.command != "compare" && options.command != "record") {
+        return false;
+    }
+    for (int i = 2; i < argc; i++) {
+        const char *arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--baseline") == 0) {
+            options.baseline = value;
+        } else if (strcmp(arg, "--current") == 0) {
+            options.current = value;
+        } else if (strcmp(arg, "--threshold") == 0) {
+            if (!parseFraction(value, options.threshold)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--gpu-threshold") == 0) {
+            if (!parseFraction(value, options.gpuThreshold)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    if (options.gpuThreshold < 0.0) {
+        options.gpuThreshold = options.threshold;
+    }
+    return !options.baseline.empty() && !options.current.empty();
+}
+
+bool fileExists(const std::string &path) {
+    return std::ifstream(path).good();
+}
+
+// A regression needs both a median above the threshold and a confidence interval
+// entirely above 1, so noise alone cannot fail the gate
+bool checkMetric(const char *name, const std::vector<double> &baseline,
+                 const std::vector<double> &current, double threshold) {
+    Statistics::Comparison comparison = Statistics::compareMedians(baseline, current);
+    bool regressed = comparison.ratio > 1.0 + threshold && comparison.ratioLow > 1.0;
+    printf("  %-4s median %8.3f ms -> %8.3f ms  ratio %.3f  95%% CI [%.3f, %.3f]  limit %.3f  %s\n",
+           name, comparison.baselineMedian, comparison.currentMedian, comparison.ratio,
+           comparison.ratioLow, comparison.ratioHigh, 1.0 + threshold,
+           regressed ? "REGRESSION" : "ok");
+    return !regressed;
+}
+
+int compare(const Options &options) {
+    if (!fileExists(options.baseline)) {
+        printf("no baseline at %s, record one with 'perfgate record'\n", options.baseline.c_str());
+        return EXIT_SKIP;
+    }
+    if (!fileExists(options.current)) {
+        printf("no benchmark run at %s\n", options.current.c_str());
+        return EXIT_SKIP;
+    }
+
+    BenchmarkResult baseline;
+    BenchmarkResult current;
+    std::string error;
+    if (!BenchmarkResult::load(options.baseline, baseline, error) ||
+        !BenchmarkResult::load(options.current, current, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_USAGE;
+    }
+    if (baseline.scenario != current.scenario) {
+        fprintf(stderr, "scenario mismatch: baseline '%s', current '%s'\n",
+                baseline.scenario.c_str(), current.scenario.c_str());
+        return EXIT_USAGE;
+    }
+
+    printf("%s: %zu baseline / %zu current frames\n", current.scenario.c_str(),
+           baseline.cpuFrameMs.size(), current.cpuFrameMs.size());
+    if (baseline.device != current.device || baseline.driverVersion != current.driverVersion ||
+        baseline.width != current.width || baseline.height != current.height) {
+        printf("  warning: baseline from '%s' (driver %u, %ux%u), current from '%s' (driver %u, %ux%u)\n",
+               baseline.device.c_str(), baseline.driverVersion, baseline.width, baseline.height,
+               current.device.c_str(), current.driverVersion, current.width, current.height);
+    }
+
+    bool passed = checkMetric("cpu", baseline.cpuFrameMs, current.cpuFrameMs, options.threshold);
+    if (!baseline.gpuFrameMs.empty() && !current.gpuFrameMs.empty()) {
+        passed = checkMetric("gpu", baseline.gpuFrameMs, current.gpuFrameMs, options.gpuThreshold) && passed;
+    } else {
+        printf("  gpu  no samples, not compared\n");
+    }
+    return passed ? EXIT_PASS : EXIT_REGRESSION;
+}
+
+// Validates a run before it becomes the baseline, then copies it byte for byte
+int record(const Options &options) {
+    BenchmarkResult current;
+    std::string error;
+    if (!BenchmarkResult::load(options.current, current, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_USAGE;
+    }
+    std::ifstream source(options.current, std::ios::binary);
+    std::ofstream destination(options.baseline, std::ios::binary | std::ios::trunc);
+    if (!destination) {
+        fprintf(stderr, "cannot write %s\n", options.baseline.c_str());
+        return EXIT_USAGE;
+    }
+    destination << source.rdbuf();
+    destination.close();
+    if (!destination) {
+        fprintf(stderr, "cannot write %s\n", options.baseline.c_str());
+        return EXIT_USAGE;
+    }
+    printf("%s: recorded %zu frames from '%s' as baseline %s\n", current.scenario.c_str(),
+           current.cpuFrameMs.size(), current.device.c_str(), options.baseline.c_str());
+    return EXIT_PASS;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_USAGE;
+    }
+    return options.command == "compare" ? compare(options) : record(options);
+}
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Runs benchmark scenarios on the connected device and pulls the results.
+#   run_benchmarks.sh <results dir> [scenario...]
+# Then: ctest --test-dir <perfgate build> -L perf  (configured with PERFGATE_RESULTS_DIR=<results dir>)
+# The app must be a debuggable build of the triangle sample.
+set -e
+
+PACKAGE=com.ahao.triangle
+RESULTS=${1:?usage: run_benchmarks.sh <results dir> [scenario...]}
+shift
+SCENARIOS=${*:-"triangle instanced_1000 instanced_100000 upload_16"}
+TIMEOUT=${PERFGATE_TIMEOUT:-120}
+
+mkdir -p "$RESULTS"
+for scenario in $SCENARIOS; do
+    file=benchmark_$scenario.json
+    adb shell run-as $PACKAGE rm -f files/$file files/$file.tmp
+    adb shell setprop debug.vulkan.benchmark "$scenario"
+    adb shell am start -S -W -n $PACKAGE/.MainActivity > /dev/null
+
+    # The app finishes itself once the results are written; it renames them into place
+    # when complete, so the file showing up means it can be copied
+    elapsed=0
+    until adb shell run-as $PACKAGE ls files/$file > /dev/null 2>&1; do
+        if [ "$elapsed" -ge "$TIMEOUT" ]; then
+            echo "$scenario: no results after ${TIMEOUT}s" >&2
+            adb shell setprop debug.vulkan.benchmark "''"
+            exit 1
+        fi
+        sleep 2
+        elapsed=$((elapsed + 2))
+    done
+    adb exec-out run-as $PACKAGE cat files/$file > "$RESULTS/$file"
+    echo "$scenario: $RESULTS/$file"
+done
+adb shell setprop debug.vulkan.benchmark "''"
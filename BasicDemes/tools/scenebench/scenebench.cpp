@@ -0,0 +1,285 @@
+/*
+ * scenebench
+ * Times the scene graph's incremental world matrix updates
+ *
+ *   scenebench [--counts 1000,10000,100000] [--workers <n>] [--grain 16384] [--repeat 50]
+ *
+ * Every count builds a tree with random parents under one root and times update()
+ * on one thread and on the job system (one worker per fast core by default) with
+ * nothing dirty, one dirty leaf near the front and one near the back, 0.1% and 1%
+ * of the nodes dirty, and the root dirty, which rewrites every matrix. The parallel
+ * results are checked against the single threaded ones, and a graph built in random
+ * order against the same graph built depth-first. Exit codes: 0 pass, 1 mismatch,
+ * 2 usage.
+ */
+
+#include "SceneGraph.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int EXIT_PASS = 0;
+constexpr int EXIT_MISMATCH = 1;
+constexpr int EXIT_USAGE = 2;
+
+constexpr uint32_t MAX_INSERTION_CHECK_COUNT = 5000;
+
+struct Options {
+    std::vector<uint32_t> counts = {1000, 10000, 100000};
+    uint32_t workers = JobSystem::AUTO;
+    uint32_t grain = 16384;
+    uint32_t repeat = 50;
+};
+
+void printUsage() {
+    fprintf(stderr, "usage: scenebench [--counts <n,n,...>] [--workers <n>] [--grain <n>] [--repeat <n>]\n");
+}
+
+bool parseUint(const char *text, uint32_t &value, bool allowZero = false) {
+    char *end = nullptr;
+    unsigned long number = strtoul(text, &end, 10);
+    if (end == text || (number == 0 && !allowZero) || number >= UINT32_MAX) {
+        return false;
+    }
+    value = static_cast<uint32_t>(number);
+    return *end == '\0' || *end == ',';
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--counts") == 0) {
+            options.counts.clear();
+            for (const char *item = value; item != nullptr; item = strchr(item, ',')) {
+                if (*item == ',') {
+                    item++;
+                }
+                uint32_t count;
+                if (!parseUint(item, count)) {
+                    return false;
+                }
+                options.counts.push_back(count);
+            }
+        } else if (strcmp(arg, "--workers") == 0) {
+            if (!parseUint(value, options.workers, true)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--grain") == 0) {
+            if (!parseUint(value, options.grain)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--repeat") == 0) {
+            if (!parseUint(value, options.repeat)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tree shape and local transforms, indexed by node in creation order
+struct Tree {
+    std::vector<uint32_t> parents;
+    std::vector<float> transforms;  // Translation, rotation angle and axis, scale
+};
+
+// Node 0 is the root, every other node hangs off a random earlier one
+Tree createTree(uint32_t count) {
+    std::mt19937 random(count);
+    std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    std::uniform_real_distribution<float> scale(0.9f, 1.1f);
+    Tree tree;
+    tree.parents.resize(count);
+    tree.transforms.resize(static_cast<size_t>(count) * 8);
+    for (uint32_t node = 0; node < count; node++) {
+        tree.parents[node] = node == 0 ? SceneGraph::NO_PARENT : random() % node;
+        float *transform = &tree.transforms[static_cast<size_t>(node) * 8];
+        for (uint32_t i = 0; i < 3; i++) {
+            transform[i] = offset(random);
+            transform[4 + i] = offset(random);
+        }
+        transform[3] = angle(random);
+        transform[7] = scale(random);
+    }
+    return tree;
+}
+
+void setTransform(SceneGraph &graph, uint32_t handle, const float *transform) {
+    graph.setTranslation(handle, transform[0], transform[1], transform[2]);
+    graph.setRotation(handle, transform[3], transform + 4);
+    graph.setScale(handle, transform[7], transform[7], transform[7]);
+}
+
+// Nodes added in creation order, which inserts most of them between existing ones;
+// handles equal the tree's node numbers
+SceneGraph buildInCreationOrder(const Tree &tree) {
+    SceneGraph graph;
+    for (uint32_t node = 0; node < tree.parents.size(); node++) {
+        graph.addNode(tree.parents[node]);
+        setTransform(graph, node, &tree.transforms[static_cast<size_t>(node) * 8]);
+    }
+    return graph;
+}
+
+// Nodes added depth-first, which only appends; handles[node] is the tree node's handle
+SceneGraph buildDepthFirst(const Tree &tree, std::vector<uint32_t> &handles) {
+    const uint32_t count = static_cast<uint32_t>(tree.parents.size());
+    std::vector<std::vector<uint32_t>> children(count);
+    for (uint32_t node = 1; node < count; node++) {
+        children[tree.parents[node]].push_back(node);
+    }
+
+    SceneGraph graph;
+    graph.reserve(count);
+    handles.assign(count, SceneGraph::NO_PARENT);
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        uint32_t node = stack.back();
+        stack.pop_back();
+        const uint32_t parent = tree.parents[node];
+        handles[node] = graph.addNode(parent == SceneGraph::NO_PARENT ? parent : handles[parent]);
+        setTransform(graph, handles[node], &tree.transforms[static_cast<size_t>(node) * 8]);
+        stack.insert(stack.end(), children[node].rbegin(), children[node].rend());
+    }
+    graph.update();
+    return graph;
+}
+
+bool sameWorldMatrices(const SceneGraph &a, const SceneGraph &b, const std::vector<uint32_t> &bHandles) {
+    for (uint32_t node = 0; node < a.size(); node++) {
+        if (a.getParent(node) != SceneGraph::NO_PARENT &&
+            bHandles[a.getParent(node)] != b.getParent(bHandles[node])) {
+            return false;
+        }
+        if (memcmp(a.getWorldMatrix(node), b.getWorldMatrix(bHandles[node]), 16 * sizeof(float)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Median wall time of repeat update() calls in milliseconds, dirtying the nodes
+// before each one
+double measure(SceneGraph &graph, const std::vector<uint32_t> &dirtyNodes, uint32_t repeat) {
+    std::vector<double> samples(repeat);
+    for (double &sample: samples) {
+        for (uint32_t node: dirtyNodes) {
+            graph.setScale(node, 1.0f, 1.0f, 1.0f);
+        }
+        auto start = std::chrono::steady_clock::now();
+        graph.update();
+        auto end = std::chrono::steady_clock::now();
+        sample = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    std::nth_element(samples.begin(), samples.begin() + repeat / 2, samples.end());
+    return samples[repeat / 2];
+}
+
+bool run(uint32_t count, JobSystem &jobs, const Options &options) {
+    const Tree tree = createTree(count);
+    std::vector<uint32_t> handles;
+    SceneGraph serial = buildDepthFirst(tree, handles);
+    serial.setGrainSize(options.grain);
+
+    // Random insertion order must give the same hierarchy and matrices. Most insertions
+    // move the nodes after them, so this is checked on a smaller tree.
+    const Tree smallTree = createTree(std::min(count, MAX_INSERTION_CHECK_COUNT));
+    std::vector<uint32_t> smallHandles;
+    SceneGraph inserted = buildInCreationOrder(smallTree);
+    inserted.update();
+    bool passed = sameWorldMatrices(inserted, buildDepthFirst(smallTree, smallHandles), smallHandles);
+    printf("  %8u nodes  insertion order %s\n", count, passed ? "ok" : "MISMATCH");
+
+    SceneGraph parallel = serial;
+    parallel.setJobSystem(&jobs);
+
+    // Leaves stored first and last
+    std::vector<bool> hasChildren(count, false);
+    for (uint32_t node = 1; node < count; node++) {
+        hasChildren[tree.parents[node]] = true;
+    }
+    uint32_t frontLeaf = handles[0];
+    uint32_t backLeaf = handles[0];
+    for (uint32_t node = 0; node < count; node++) {
+        if (hasChildren[node]) {
+            continue;
+        }
+        if (hasChildren[0] && (frontLeaf == handles[0] || serial.getIndex(handles[node]) < serial.getIndex(frontLeaf))) {
+            frontLeaf = handles[node];
+        }
+        if (serial.getIndex(handles[node]) > serial.getIndex(backLeaf)) {
+            backLeaf = handles[node];
+        }
+    }
+    std::vector<uint32_t> allHandles(handles);
+    std::shuffle(allHandles.begin(), allHandles.end(), std::mt19937(count));
+    auto randomNodes = [&](uint32_t permille) {
+        return std::vector<uint32_t>(allHandles.begin(),
+                                     allHandles.begin() + std::max(1u, count * permille / 1000));
+    };
+
+    struct Case {
+        const char *name;
+        std::vector<uint32_t> dirtyNodes;
+    };
+    const Case cases[] = {
+            {"clean",      {}},
+            {"front leaf", {frontLeaf}},
+            {"back leaf",  {backLeaf}},
+            {"0.1%",       randomNodes(1)},
+            {"1%",         randomNodes(10)},
+            {"root",       {handles[0]}},
+    };
+    for (const Case &testCase: cases) {
+        double serialMs = measure(serial, testCase.dirtyNodes, options.repeat);
+        double parallelMs = measure(parallel, testCase.dirtyNodes, options.repeat);
+        // Different values than the timed runs, so stale matrices can't match
+        for (uint32_t node: testCase.dirtyNodes) {
+            serial.setScale(node, 1.05f, 1.05f, 1.05f);
+            parallel.setScale(node, 1.05f, 1.05f, 1.05f);
+        }
+        const uint32_t updated = serial.update();
+        parallel.update();
+        bool match = serial.getWorldMatrices() == parallel.getWorldMatrices();
+        printf("    %-10s  updated %8u  serial %8.3f ms  parallel %8.3f ms (%4.1fx)  %s\n", testCase.name,
+               updated, serialMs, parallelMs, parallelMs > 0.0 ? serialMs / parallelMs : 0.0,
+               match ? "ok" : "MISMATCH");
+        passed = match && passed;
+    }
+    return passed;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_USAGE;
+    }
+
+    JobSystem jobs;
+    jobs.start(options.workers);
+    const CpuTopology &topology = jobs.getTopology();
+    printf("parallel: %u workers (%zu of %u cores fast), grain %u nodes, median of %u runs\n",
+           jobs.getWorkerCount(), topology.fastCores.size(), topology.coreCount, options.grain, options.repeat);
+    bool passed = true;
+    for (uint32_t count: options.counts) {
+        passed = run(count, jobs, options) && passed;
+    }
+    return passed ? EXIT_PASS : EXIT_MISMATCH;
+}
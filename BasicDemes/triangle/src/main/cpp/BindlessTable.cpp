@@ -0,0 +1,175 @@
+/*
+ * Bindless Table Implementation
+ */
+
+#include "BindlessTable.hpp"
+#include <algorithm>
+
+uint32_t BindlessTable::HandleAllocator::allocate() {
+    if (!freeHandles.empty()) {
+        uint32_t handle = freeHandles.back();
+        freeHandles.pop_back();
+        return handle;
+    }
+    return next < capacity ? next++ : INVALID_HANDLE;
+}
+
+void BindlessTable::HandleAllocator::release(uint32_t handle) {
+    if (handle < next) {
+        freeHandles.push_back(handle);
+    }
+}
+
+VkResult BindlessTable::create(VkDevice device, const VkPhysicalDeviceDescriptorIndexingPropertiesEXT &limits,
+                               const Capacity &capacity) {
+    this->device = device;
+
+    // A combined image sampler counts against both the sampler and the sampled image limits
+    this->capacity.textures = std::min({capacity.textures,
+                                        limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                        limits.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                        limits.maxDescriptorSetUpdateAfterBindSampledImages,
+                                        limits.maxDescriptorSetUpdateAfterBindSamplers});
+    this->capacity.buffers = std::min({capacity.buffers,
+                                       limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+                                       limits.maxDescriptorSetUpdateAfterBindStorageBuffers});
+    textures = HandleAllocator();
+    textures.capacity = this->capacity.textures;
+    buffers = HandleAllocator();
+    buffers.capacity = this->capacity.buffers;
+
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[TEXTURE_BINDING].binding = TEXTURE_BINDING;
+    bindings[TEXTURE_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[TEXTURE_BINDING].descriptorCount = this->capacity.textures;
+    bindings[TEXTURE_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+    bindings[BUFFER_BINDING].binding = BUFFER_BINDING;
+    bindings[BUFFER_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[BUFFER_BINDING].descriptorCount = this->capacity.buffers;
+    bindings[BUFFER_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+
+    const VkDescriptorBindingFlagsEXT bindingFlag = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                                    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                                    VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+    const VkDescriptorBindingFlagsEXT bindingFlags[2] = {bindingFlag, bindingFlag};
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCI{};
+    bindingFlagsCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsCI.bindingCount = 2;
+    bindingFlagsCI.pBindingFlags = bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCI{};
+    setLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCI.pNext = &bindingFlagsCI;
+    setLayoutCI.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    setLayoutCI.bindingCount = 2;
+    setLayoutCI.pBindings = bindings;
+    VkResult result = vkCreateDescriptorSetLayout(device, &setLayoutCI, nullptr, &setLayout);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkDescriptorPoolSize poolSizes[2] = {
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, this->capacity.textures},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         this->capacity.buffers}
+    };
+    VkDescriptorPoolCreateInfo poolCI{};
+    poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCI.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    poolCI.maxSets = 1;
+    poolCI.poolSizeCount = 2;
+    poolCI.pPoolSizes = poolSizes;
+    result = vkCreateDescriptorPool(device, &poolCI, nullptr, &descriptorPool);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+    return vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+}
+
+void BindlessTable::destroy() {
+    // The set is freed with its pool
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    }
+    if (setLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    }
+    descriptorPool = VK_NULL_HANDLE;
+    setLayout = VK_NULL_HANDLE;
+    descriptorSet = VK_NULL_HANDLE;
+}
+
+uint32_t BindlessTable::addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t handle = textures.allocate();
+    if (handle == INVALID_HANDLE) {
+        return INVALID_HANDLE;
+    }
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = sampler;
+    imageInfo.imageView = view;
+    imageInfo.imageLayout = layout;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = TEXTURE_BINDING;
+    write.dstArrayElement = handle;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    return handle;
+}
+
+uint32_t BindlessTable::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t handle = buffers.allocate();
+    if (handle == INVALID_HANDLE) {
+        return INVALID_HANDLE;
+    }
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = BUFFER_BINDING;
+    write.dstArrayElement = handle;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    return handle;
+}
+
+void BindlessTable::removeTexture(uint32_t handle) {
+    // The stale descriptor stays until the handle is reused; partially bound arrays
+    // allow it as long as shaders don't index it
+    std::lock_guard<std::mutex> lock(mutex);
+    textures.release(handle);
+}
+
+void BindlessTable::removeBuffer(uint32_t handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.release(handle);
+}
+
+uint32_t BindlessTable::getTextureCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return textures.count();
+}
+
+uint32_t BindlessTable::getBufferCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffers.count();
+}
@@ -0,0 +1,78 @@
+/*
+ * Bindless Table
+ * Device wide descriptor arrays of textures and storage buffers, indexed by handle
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief One update-after-bind descriptor set holding every registered resource
+ *
+ * Binding 0 is an array of combined image samplers, binding 1 an array of storage
+ * buffers (VK_EXT_descriptor_indexing). Resources are registered once and referred
+ * to by their 32-bit handle, the array index, which shaders receive through push
+ * constants or instance data. The set is bound once per command buffer, so draws
+ * switching textures or buffers need no vkCmdBindDescriptorSets.
+ *
+ * Bindings are partially bound and may be updated while the set is in use by
+ * pending command buffers, as long as those don't access the updated elements.
+ * A handle must therefore only be removed once no submitted work can still use
+ * it, e.g. from a retired resource deleter; it is reused by the next add.
+ */
+class BindlessTable {
+public:
+    static constexpr uint32_t TEXTURE_BINDING = 0;
+    static constexpr uint32_t BUFFER_BINDING = 1;
+    static constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+
+    // Array sizes, clamped to the device's update-after-bind limits in create()
+    struct Capacity {
+        uint32_t textures = 4096;
+        uint32_t buffers = 1024;
+    };
+
+    VkResult create(VkDevice device, const VkPhysicalDeviceDescriptorIndexingPropertiesEXT &limits,
+                    const Capacity &capacity);
+    void destroy();
+    bool isCreated() const { return descriptorSet != VK_NULL_HANDLE; }
+
+    VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+    VkDescriptorSet getSet() const { return descriptorSet; }
+    const Capacity &getCapacity() const { return capacity; }
+
+    // INVALID_HANDLE once the array is full
+    uint32_t addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout);
+    uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+    void removeTexture(uint32_t handle);
+    void removeBuffer(uint32_t handle);
+
+    uint32_t getTextureCount() const;
+    uint32_t getBufferCount() const;
+
+private:
+    // Handles in use, plus released ones handed out again before new ones
+    struct HandleAllocator {
+        uint32_t capacity = 0;
+        uint32_t next = 0;
+        std::vector<uint32_t> freeHandles;
+
+        uint32_t allocate();
+        void release(uint32_t handle);
+        uint32_t count() const { return next - static_cast<uint32_t>(freeHandles.size()); }
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    Capacity capacity;
+
+    mutable std::mutex mutex;
+    HandleAllocator textures;
+    HandleAllocator buffers;
+};
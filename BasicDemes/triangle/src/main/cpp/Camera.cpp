@@ -0,0 +1,64 @@
+/*
+ * Camera Implementation
+ */
+
+#include "Camera.hpp"
+#include "MatrixUtils.hpp"
+#include <cstring>
+
+Camera::Camera() {
+    createIdentityMatrix(projectionMatrix);
+    createIdentityMatrix(viewMatrix);
+}
+
+void Camera::setPerspective(float fov, float near, float far) {
+    if (fov == this->fov && near == this->near && far == this->far) {
+        return;
+    }
+    this->fov = fov;
+    this->near = near;
+    this->far = far;
+    projectionDirty = true;
+    version++;
+}
+
+void Camera::setExtent(uint32_t width, uint32_t height) {
+    if (width == this->width && height == this->height) {
+        return;
+    }
+    this->width = width;
+    this->height = height;
+    projectionDirty = true;
+    version++;
+}
+
+void Camera::setLookAt(const float eye[3], const float center[3], const float up[3]) {
+    if (memcmp(eye, this->eye, sizeof(this->eye)) == 0 && memcmp(center, this->center, sizeof(this->center)) == 0 &&
+        memcmp(up, this->up, sizeof(this->up)) == 0) {
+        return;
+    }
+    memcpy(this->eye, eye, sizeof(this->eye));
+    memcpy(this->center, center, sizeof(this->center));
+    memcpy(this->up, up, sizeof(this->up));
+    viewDirty = true;
+    version++;
+}
+
+const float *Camera::getProjectionMatrix() {
+    if (projectionDirty) {
+        float aspect = static_cast<float>(width) / static_cast<float>(height > 0 ? height : 1);
+        createPerspectiveMatrix(projectionMatrix, fov * 3.14159265f / 180.0f, aspect, near, far);
+        // Vulkan's Y axis points down
+        projectionMatrix[5] *= -1.0f;
+        projectionDirty = false;
+    }
+    return projectionMatrix;
+}
+
+const float *Camera::getViewMatrix() {
+    if (viewDirty) {
+        createLookAtMatrix(viewMatrix, eye[0], eye[1], eye[2], center[0], center[1], center[2], up[0], up[1], up[2]);
+        viewDirty = false;
+    }
+    return viewMatrix;
+}
@@ -0,0 +1,48 @@
+/*
+ * Camera
+ * Perspective camera with cached projection and view matrices
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Projection and view matrices rebuilt only when their inputs change
+ *
+ * Setters compare against the current values and do nothing if they are equal, so
+ * they can be called every frame. Matrices are rebuilt on the next get after a
+ * change. The version counts changes, letting per frame copies of the matrices
+ * (e.g. uniform buffers) skip the upload when they are already current.
+ *
+ * The projection has Y flipped for Vulkan clip space, where Y points down.
+ */
+class Camera {
+public:
+    Camera();
+
+    // Vertical field of view in degrees
+    void setPerspective(float fov, float near, float far);
+    void setExtent(uint32_t width, uint32_t height);
+    void setLookAt(const float eye[3], const float center[3], const float up[3]);
+
+    const float *getProjectionMatrix();
+    const float *getViewMatrix();
+    uint64_t getVersion() const { return version; }
+
+private:
+    float fov = 60.0f;
+    float near = 0.1f;
+    float far = 256.0f;
+    uint32_t width = 1;
+    uint32_t height = 1;
+    float eye[3] = {0.0f, 0.0f, 1.0f};
+    float center[3] = {0.0f, 0.0f, 0.0f};
+    float up[3] = {0.0f, 1.0f, 0.0f};
+
+    float projectionMatrix[16];
+    float viewMatrix[16];
+    bool projectionDirty = true;
+    bool viewDirty = true;
+    uint64_t version = 1;
+};
@@ -0,0 +1,83 @@
+/*
+ * Debug Utils Implementation
+ */
+
+#include "DebugUtils.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+const char *DebugUtils::getInstanceExtension() {
+#if VULKAN_DEBUG_UTILS
+    uint32_t extensionCount = 0;
+    if (vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr) != VK_SUCCESS) {
+        return nullptr;
+    }
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    if (vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data()) !=
+        VK_SUCCESS) {
+        return nullptr;
+    }
+    for (const auto &extension: extensions) {
+        if (strcmp(extension.extensionName, VK_EXT_DEBUG_UTILS_EXTENSION_NAME) == 0) {
+            return VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+        }
+    }
+#endif
+    return nullptr;
+}
+
+void DebugUtils::setup(VkInstance instance, VkDevice device, bool instanceExtensionEnabled) {
+#if VULKAN_DEBUG_UTILS
+    if (!instanceExtensionEnabled) {
+        return;
+    }
+    this->device = device;
+    setObjectNameFn = reinterpret_cast<PFN_vkSetDebugUtilsObjectNameEXT>(
+            vkGetInstanceProcAddr(instance, "vkSetDebugUtilsObjectNameEXT"));
+    beginLabelFn = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(
+            vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT"));
+    endLabelFn = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(
+            vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT"));
+    insertLabelFn = reinterpret_cast<PFN_vkCmdInsertDebugUtilsLabelEXT>(
+            vkGetInstanceProcAddr(instance, "vkCmdInsertDebugUtilsLabelEXT"));
+    // Begin and end are only usable as a pair
+    if (beginLabelFn == nullptr || endLabelFn == nullptr) {
+        beginLabelFn = nullptr;
+        endLabelFn = nullptr;
+    }
+#endif
+}
+
+#if VULKAN_DEBUG_UTILS
+void DebugUtils::nameObject(VkObjectType type, uint64_t handle, const char *format, va_list args) {
+    if (handle == 0) {
+        return;
+    }
+    char name[128];
+    vsnprintf(name, sizeof(name), format, args);
+
+    VkDebugUtilsObjectNameInfoEXT nameInfo{};
+    nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+    nameInfo.objectType = type;
+    nameInfo.objectHandle = handle;
+    nameInfo.pObjectName = name;
+    setObjectNameFn(device, &nameInfo);
+}
+
+void DebugUtils::recordLabel(VkCommandBuffer cmdBuffer, const char *name, float r, float g,
+                             float b, bool insert) {
+    VkDebugUtilsLabelEXT label{};
+    label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+    label.pLabelName = name;
+    label.color[0] = r;
+    label.color[1] = g;
+    label.color[2] = b;
+    label.color[3] = 1.0f;
+    if (insert) {
+        insertLabelFn(cmdBuffer, &label);
+    } else {
+        beginLabelFn(cmdBuffer, &label);
+    }
+}
+#endif
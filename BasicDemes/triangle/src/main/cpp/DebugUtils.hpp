@@ -0,0 +1,108 @@
+/*
+ * Debug Utils
+ * Object names and command buffer labels through VK_EXT_debug_utils
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdarg>
+#include <cstdint>
+
+// Set by the ENABLE_DEBUG_UTILS CMake option (on by default for debug builds)
+#ifndef VULKAN_DEBUG_UTILS
+#define VULKAN_DEBUG_UTILS 0
+#endif
+
+/**
+ * @brief Names Vulkan objects and labels command buffer regions for capture tools
+ *
+ * Names and labels show up in RenderDoc, AGI and vendor profilers instead of raw
+ * handles. Without VULKAN_DEBUG_UTILS every call is an empty inline function and the
+ * name arguments are never formatted. With it, each call is a single null check when
+ * the instance or driver does not provide the extension.
+ */
+class DebugUtils {
+public:
+    // Instance extension to enable, nullptr if compiled out or not available
+    static const char *getInstanceExtension();
+
+    // Load entry points; only enabled if the instance was created with the extension
+    void setup(VkInstance instance, VkDevice device, bool instanceExtensionEnabled);
+    bool isEnabled() const {
+#if VULKAN_DEBUG_UTILS
+        return setObjectNameFn != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    // printf style name; works for dispatchable and non-dispatchable handles, which are
+    // plain 64-bit integers on 32-bit targets
+    template<typename Handle>
+    void setObjectName(VkObjectType type, Handle handle, const char *format, ...) {
+#if VULKAN_DEBUG_UTILS
+        if (setObjectNameFn != nullptr) {
+            va_list args;
+            va_start(args, format);
+            nameObject(type, (uint64_t) handle, format, args);
+            va_end(args);
+        }
+#endif
+    }
+
+    // Label regions nest; every beginLabel() needs an endLabel() in the same command buffer
+    void beginLabel(VkCommandBuffer cmdBuffer, const char *name,
+                    float r = 1.0f, float g = 1.0f, float b = 1.0f) {
+#if VULKAN_DEBUG_UTILS
+        if (beginLabelFn != nullptr) {
+            recordLabel(cmdBuffer, name, r, g, b, false);
+        }
+#endif
+    }
+    void endLabel(VkCommandBuffer cmdBuffer) {
+#if VULKAN_DEBUG_UTILS
+        if (endLabelFn != nullptr) {
+            endLabelFn(cmdBuffer);
+        }
+#endif
+    }
+    void insertLabel(VkCommandBuffer cmdBuffer, const char *name,
+                     float r = 1.0f, float g = 1.0f, float b = 1.0f) {
+#if VULKAN_DEBUG_UTILS
+        if (insertLabelFn != nullptr) {
+            recordLabel(cmdBuffer, name, r, g, b, true);
+        }
+#endif
+    }
+
+    // Label region for the lifetime of the scope
+    class LabelScope {
+    public:
+        LabelScope(DebugUtils &debugUtils, VkCommandBuffer cmdBuffer, const char *name,
+                   float r = 1.0f, float g = 1.0f, float b = 1.0f)
+                : debugUtils(debugUtils), cmdBuffer(cmdBuffer) {
+            debugUtils.beginLabel(cmdBuffer, name, r, g, b);
+        }
+        ~LabelScope() { debugUtils.endLabel(cmdBuffer); }
+        LabelScope(const LabelScope &) = delete;
+        LabelScope &operator=(const LabelScope &) = delete;
+
+    private:
+        DebugUtils &debugUtils;
+        VkCommandBuffer cmdBuffer;
+    };
+
+private:
+#if VULKAN_DEBUG_UTILS
+    VkDevice device = VK_NULL_HANDLE;
+    PFN_vkSetDebugUtilsObjectNameEXT setObjectNameFn = nullptr;
+    PFN_vkCmdBeginDebugUtilsLabelEXT beginLabelFn = nullptr;
+    PFN_vkCmdEndDebugUtilsLabelEXT endLabelFn = nullptr;
+    PFN_vkCmdInsertDebugUtilsLabelEXT insertLabelFn = nullptr;
+
+    void nameObject(VkObjectType type, uint64_t handle, const char *format, va_list args);
+    void recordLabel(VkCommandBuffer cmdBuffer, const char *name, float r, float g, float b,
+                     bool insert);
+#endif
+};
@@ -0,0 +1,47 @@
+/*
+ * Deletion Queue Implementation
+ */
+
+#include "DeletionQueue.hpp"
+#include <algorithm>
+
+void DeletionQueue::retire(Deleter deleter) {
+    unstamped.push_back(std::move(deleter));
+}
+
+void DeletionQueue::retire(uint64_t timelineValue, Deleter deleter) {
+    // Values normally arrive in order, keep the queue sorted if one does not
+    auto position = std::upper_bound(entries.begin(), entries.end(), timelineValue,
+                                     [](uint64_t value, const Entry &entry) {
+                                         return value < entry.timelineValue;
+                                     });
+    entries.insert(position, Entry{timelineValue, std::move(deleter)});
+}
+
+void DeletionQueue::stamp(uint64_t timelineValue) {
+    for (auto &deleter: unstamped) {
+        retire(timelineValue, std::move(deleter));
+    }
+    unstamped.clear();
+}
+
+size_t DeletionQueue::collect(uint64_t completedValue) {
+    size_t count = 0;
+    while (!entries.empty() && entries.front().timelineValue <= completedValue) {
+        // Pop before running so a deleter may retire further resources
+        Deleter deleter = std::move(entries.front().deleter);
+        entries.pop_front();
+        deleter();
+        count++;
+    }
+    return count;
+}
+
+size_t DeletionQueue::flush() {
+    size_t count = 0;
+    while (!entries.empty() || !unstamped.empty()) {
+        stamp(0);
+        count += collect(UINT64_MAX);
+    }
+    return count;
+}
@@ -0,0 +1,50 @@
+/*
+ * Deletion Queue
+ * Defers resource destruction until the GPU is done with the resource
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Runs deleters once the device timeline reaches the value they were retired at
+ *
+ * A resource that is still referenced by submitted (or currently recorded) work is
+ * retired instead of destroyed. Retiring without a value parks the deleter until the
+ * next stamp(), which the frame submit calls with its timeline value, so resources
+ * used by the frame being recorded outlive that frame. collect() destroys everything
+ * whose value the GPU has completed, without waiting.
+ */
+class DeletionQueue {
+public:
+    using Deleter = std::function<void()>;
+
+    // Retire until the next stamped submission has completed
+    void retire(Deleter deleter);
+    // Retire until a known timeline value has completed
+    void retire(uint64_t timelineValue, Deleter deleter);
+
+    // Assign a submission's timeline value to everything retired without one
+    void stamp(uint64_t timelineValue);
+
+    // Run the deleters of all completed values, returns how many ran
+    size_t collect(uint64_t completedValue);
+    // Run all deleters, only when the device is idle
+    size_t flush();
+
+    size_t size() const { return entries.size() + unstamped.size(); }
+
+private:
+    struct Entry {
+        uint64_t timelineValue;
+        Deleter deleter;
+    };
+
+    // Ordered by timeline value
+    std::deque<Entry> entries;
+    std::vector<Deleter> unstamped;
+};
@@ -0,0 +1,176 @@
+/*
+ * Device Selector Implementation
+ */
+
+#include "DeviceSelector.hpp"
+#include <algorithm>
+#include <cstring>
+
+std::vector<DeviceSelector::Candidate> DeviceSelector::queryCandidates(VkInstance instance,
+                                                                       VkSurfaceKHR surface) {
+    std::vector<Candidate> candidates;
+    uint32_t gpuCount = 0;
+    if (vkEnumeratePhysicalDevices(instance, &gpuCount, nullptr) != VK_SUCCESS || gpuCount == 0) {
+        return candidates;
+    }
+    std::vector<VkPhysicalDevice> physicalDevices(gpuCount);
+    if (vkEnumeratePhysicalDevices(instance, &gpuCount, physicalDevices.data()) != VK_SUCCESS) {
+        return candidates;
+    }
+
+    candidates.resize(gpuCount);
+    for (uint32_t i = 0; i < gpuCount; i++) {
+        Candidate &candidate = candidates[i];
+        candidate.physicalDevice = physicalDevices[i];
+        vkGetPhysicalDeviceProperties(physicalDevices[i], &candidate.properties);
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevices[i], &familyCount, nullptr);
+        candidate.queueFamilies.resize(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevices[i], &familyCount,
+                                                 candidate.queueFamilies.data());
+        candidate.presentSupport.resize(familyCount, false);
+        for (uint32_t family = 0; family < familyCount; family++) {
+            VkBool32 supported = VK_FALSE;
+            if (surface != VK_NULL_HANDLE &&
+                vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevices[i], family, surface,
+                                                     &supported) == VK_SUCCESS) {
+                candidate.presentSupport[family] = supported == VK_TRUE;
+            }
+        }
+
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevices[i], nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(physicalDevices[i], nullptr, &extensionCount,
+                                             extensions.data());
+        for (const auto &extension: extensions) {
+            if (strcmp(extension.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) {
+                candidate.swapchainSupport = true;
+                break;
+            }
+        }
+    }
+    return candidates;
+}
+
+bool DeviceSelector::select(const std::vector<Candidate> &candidates, Selection &selection) {
+    int64_t bestScore = -1;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        QueueFamilies queueFamilies = selectQueueFamilies(candidates[i].queueFamilies,
+                                                          candidates[i].presentSupport);
+        int64_t score = scoreDevice(candidates[i], queueFamilies);
+        if (score > bestScore) {
+            bestScore = score;
+            selection.physicalDevice = candidates[i].physicalDevice;
+            selection.deviceIndex = static_cast<uint32_t>(i);
+            selection.score = score;
+            selection.queueFamilies = queueFamilies;
+            selection.queueFamilyProperties = candidates[i].queueFamilies;
+        }
+    }
+    return bestScore >= 0;
+}
+
+DeviceSelector::QueueFamilies DeviceSelector::selectQueueFamilies(
+        const std::vector<VkQueueFamilyProperties> &families,
+        const std::vector<bool> &presentSupport) {
+    QueueFamilies result;
+    const VkQueueFlags graphicsCompute = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+
+    // Frames are recorded, submitted and presented on one queue
+    for (uint32_t i = 0; i < families.size(); i++) {
+        bool present = i < presentSupport.size() && presentSupport[i];
+        if (families[i].queueCount > 0 && present &&
+            (families[i].queueFlags & graphicsCompute) == graphicsCompute) {
+            result.graphics = i;
+            break;
+        }
+    }
+    if (result.graphics == NO_FAMILY) {
+        return result;
+    }
+
+    // Async compute: a compute family without graphics runs alongside the graphics queue
+    result.compute = result.graphics;
+    for (uint32_t i = 0; i < families.size(); i++) {
+        if (families[i].queueCount > 0 && (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+            !(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+            result.compute = i;
+            break;
+        }
+    }
+
+    // Transfer-only families are usually backed by copy engines. Graphics and compute
+    // families support transfers implicitly, so fall back to the graphics family.
+    result.transfer = result.graphics;
+    for (uint32_t i = 0; i < families.size(); i++) {
+        if (families[i].queueCount > 0 && (families[i].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+            !(families[i].queueFlags & graphicsCompute)) {
+            result.transfer = i;
+            break;
+        }
+    }
+    return result;
+}
+
+int64_t DeviceSelector::scoreDevice(const Candidate &candidate, const QueueFamilies &queueFamilies) {
+    const VkPhysicalDeviceProperties &properties = candidate.properties;
+    if (queueFamilies.graphics == NO_FAMILY || !candidate.swapchainSupport ||
+        properties.apiVersion < VK_API_VERSION_1_1) {
+        return -1;
+    }
+
+    // Device type dominates, software rasterizers are only picked if nothing else works
+    int64_t score = 0;
+    switch (properties.deviceType) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            score += 100000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            score += 80000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            score += 40000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            score += 10000;
+            break;
+        default:
+            score += 5000;
+            break;
+    }
+
+    // Limits separate devices of the same type
+    const VkPhysicalDeviceLimits &limits = properties.limits;
+    score += std::min<int64_t>(limits.maxImageDimension2D / 1024, 32) * 100;
+    score += std::min<int64_t>(limits.maxComputeSharedMemorySize / 1024, 64) * 20;
+    score += std::min<int64_t>(limits.maxBoundDescriptorSets, 32) * 10;
+    if (limits.timestampComputeAndGraphics) {
+        score += 200;
+    }
+
+    // Separate queues allow overlapping compute and uploads with rendering
+    if (queueFamilies.asyncCompute()) {
+        score += 1000;
+    }
+    if (queueFamilies.dedicatedTransfer()) {
+        score += 500;
+    }
+    return score;
+}
+
+const char *DeviceSelector::deviceTypeName(VkPhysicalDeviceType type) {
+    switch (type) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            return "discrete";
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            return "integrated";
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            return "virtual";
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            return "cpu";
+        default:
+            return "other";
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Device Selector
+ * Scores physical devices and picks graphics, async compute and transfer queue families
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Picks the physical device and queue families the engine runs on
+ *
+ * Every physical device is described as a Candidate and scored. Devices without a
+ * graphics family that can present to the surface, without VK_KHR_swapchain or below
+ * Vulkan 1.1 are rejected. Usable devices are ranked by type (discrete, integrated,
+ * virtual, then CPU implementations such as lavapipe or SwiftShader), then by limits
+ * and by the availability of separate compute and transfer families.
+ *
+ * Compute and transfer fall back to the graphics family when the device has no
+ * dedicated family for them, so the selection always names a family for each.
+ */
+class DeviceSelector {
+public:
+    static constexpr uint32_t NO_FAMILY = UINT32_MAX;
+
+    struct QueueFamilies {
+        uint32_t graphics = NO_FAMILY;  // Graphics, compute and present
+        uint32_t compute = NO_FAMILY;   // Compute family without graphics if available
+        uint32_t transfer = NO_FAMILY;  // Transfer-only family (DMA engine) if available
+
+        bool asyncCompute() const { return compute != graphics; }
+        bool dedicatedTransfer() const { return transfer != graphics && transfer != compute; }
+    };
+
+    // Everything the score is based on, gathered from one physical device
+    struct Candidate {
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkPhysicalDeviceProperties properties{};
+        std::vector<VkQueueFamilyProperties> queueFamilies;
+        std::vector<bool> presentSupport;  // Per queue family, for the target surface
+        bool swapchainSupport = false;
+    };
+
+    struct Selection {
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        uint32_t deviceIndex = 0;
+        int64_t score = -1;
+        QueueFamilies queueFamilies;
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties;
+    };
+
+    // Describe all physical devices of the instance, with present support for the surface
+    static std::vector<Candidate> queryCandidates(VkInstance instance, VkSurfaceKHR surface);
+    // Select the best candidate; returns false if no device can render and present.
+    // Ties keep the enumeration order.
+    static bool select(const std::vector<Candidate> &candidates, Selection &selection);
+
+    // Pick queue families; graphics stays NO_FAMILY if no family can render and present
+    static QueueFamilies selectQueueFamilies(const std::vector<VkQueueFamilyProperties> &families,
+                                             const std::vector<bool> &presentSupport);
+    // Score of a candidate, negative if the device is unusable
+    static int64_t scoreDevice(const Candidate &candidate, const QueueFamilies &queueFamilies);
+
+    static const char *deviceTypeName(VkPhysicalDeviceType type);
+};
@@ -0,0 +1,63 @@
+/*
+ * Dynamic Resolution Controller Implementation
+ */
+
+#include "DynamicResolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+float DynamicResolutionController::update(float gpuFrameTimeMs) {
+    if (!hasSample) {
+        smoothedFrameTimeMs = gpuFrameTimeMs;
+        hasSample = true;
+    } else {
+        smoothedFrameTimeMs += (gpuFrameTimeMs - smoothedFrameTimeMs) * settings.smoothing;
+    }
+
+    if (cooldown > 0) {
+        cooldown--;
+        return scale;
+    }
+
+    if (smoothedFrameTimeMs > settings.targetFrameTimeMs * settings.upperThreshold) {
+        overBudgetFrames++;
+        underBudgetFrames = 0;
+    } else if (smoothedFrameTimeMs < settings.targetFrameTimeMs * settings.lowerThreshold) {
+        underBudgetFrames++;
+        overBudgetFrames = 0;
+    } else {
+        overBudgetFrames = 0;
+        underBudgetFrames = 0;
+    }
+
+    float newScale = scale;
+    if (overBudgetFrames >= settings.framesToDecrease) {
+        // Fragment cost follows the pixel count, i.e. the square of the scale
+        float estimate = scale * std::sqrt(settings.targetFrameTimeMs / smoothedFrameTimeMs);
+        newScale = quantize(std::min(estimate, scale - settings.scaleStep));
+    } else if (underBudgetFrames >= settings.framesToIncrease) {
+        newScale = quantize(scale + settings.scaleStep);
+    }
+
+    if (newScale != scale) {
+        scale = newScale;
+        overBudgetFrames = 0;
+        underBudgetFrames = 0;
+        cooldown = settings.cooldownFrames;
+    }
+    return scale;
+}
+
+void DynamicResolutionController::reset() {
+    scale = settings.maxScale;
+    smoothedFrameTimeMs = 0.0f;
+    hasSample = false;
+    overBudgetFrames = 0;
+    underBudgetFrames = 0;
+    cooldown = 0;
+}
+
+float DynamicResolutionController::quantize(float value) const {
+    value = std::round(value / settings.scaleStep) * settings.scaleStep;
+    return std::clamp(value, settings.minScale, settings.maxScale);
+}
@@ -0,0 +1,49 @@
+/*
+ * Dynamic Resolution Controller
+ * Picks the scene render scale from measured GPU frame time against a budget
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Render scale controller with hysteresis
+ *
+ * Scales down quickly when the GPU frame time stays over budget and scales up
+ * slowly once it has been comfortably under budget for a while. Scale changes
+ * are quantized and followed by a cooldown, so the resolution does not
+ * oscillate on noisy timings.
+ */
+class DynamicResolutionController {
+public:
+    struct Settings {
+        float targetFrameTimeMs = 16.0f;  // GPU time budget per frame
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float scaleStep = 0.05f;          // Scale changes are quantized to this step
+        float upperThreshold = 1.0f;      // Over budget above target * upperThreshold
+        float lowerThreshold = 0.8f;      // Under budget below target * lowerThreshold
+        uint32_t framesToDecrease = 4;    // Consecutive over budget frames before scaling down
+        uint32_t framesToIncrease = 60;   // Consecutive under budget frames before scaling up
+        uint32_t cooldownFrames = 8;      // Frames ignored after a change while timings settle
+        float smoothing = 0.2f;           // Weight of the newest sample in the moving average
+    } settings;
+
+    // Feed the GPU time of a completed frame, returns the scale for the next frame
+    float update(float gpuFrameTimeMs);
+    void reset();
+
+    float getScale() const { return scale; }
+    float getSmoothedFrameTimeMs() const { return smoothedFrameTimeMs; }
+
+private:
+    float scale = 1.0f;
+    float smoothedFrameTimeMs = 0.0f;
+    bool hasSample = false;
+    uint32_t overBudgetFrames = 0;
+    uint32_t underBudgetFrames = 0;
+    uint32_t cooldown = 0;
+
+    float quantize(float value) const;
+};
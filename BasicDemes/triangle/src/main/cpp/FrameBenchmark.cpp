@@ -0,0 +1,100 @@
+/*
+ * Frame Benchmark Implementation
+ */
+
+#include "FrameBenchmark.hpp"
+#include <cstdio>
+
+void FrameBenchmark::start(const Config &config) {
+    this->config = config;
+    running = true;
+    framesSeen = 0;
+    cpuFrameMs.clear();
+    gpuFrameMs.clear();
+    cpuFrameMs.reserve(config.measuredFrames);
+    gpuFrameMs.reserve(config.measuredFrames);
+}
+
+void FrameBenchmark::addCpuSample(double ms) {
+    if (!running || complete()) {
+        return;
+    }
+    if (framesSeen++ < config.warmupFrames) {
+        return;
+    }
+    cpuFrameMs.push_back(ms);
+}
+
+void FrameBenchmark::addGpuSample(double ms) {
+    // GPU samples belong to frames the CPU has already counted
+    if (!running || framesSeen <= config.warmupFrames || gpuFrameMs.size() >= config.measuredFrames) {
+        return;
+    }
+    gpuFrameMs.push_back(ms);
+}
+
+static void appendSamples(std::string &json, const char *name, const std::vector<double> &samples) {
+    json += "  \"";
+    json += name;
+    json += "\": [";
+    char number[32];
+    for (size_t i = 0; i < samples.size(); i++) {
+        snprintf(number, sizeof(number), "%s%.4f", i == 0 ? "" : ", ", samples[i]);
+        json += number;
+    }
+    json += "]";
+}
+
+// Names are plain ASCII, only quotes and backslashes need escaping
+static std::string escapeJson(const std::string &text) {
+    std::string escaped;
+    for (char c: text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string FrameBenchmark::toJson(const DeviceInfo &device) const {
+    char header[512];
+    snprintf(header, sizeof(header),
+             "{\n"
+             "  \"scenario\": \"%s\",\n"
+             "  \"device\": \"%s\",\n"
+             "  \"driverVersion\": %u,\n"
+             "  \"width\": %u,\n"
+             "  \"height\": %u,\n"
+             "  \"warmupFrames\": %u,\n"
+             "  \"frames\": %zu,\n",
+             escapeJson(config.scenario).c_str(), escapeJson(device.deviceName).c_str(),
+             device.driverVersion, device.width, device.height, config.warmupFrames,
+             cpuFrameMs.size());
+
+    std::string json = header;
+    appendSamples(json, "cpuFrameMs", cpuFrameMs);
+    json += ",\n";
+    appendSamples(json, "gpuFrameMs", gpuFrameMs);
+    json += "\n}\n";
+    return json;
+}
+
+bool FrameBenchmark::writeJson(const std::string &path, const DeviceInfo &device) const {
+    const std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::string json = toJson(device);
+    bool ok = fwrite(json.data(), 1, json.size(), file) == json.size();
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    // Readers polling for path never see a partial file
+    if (!ok || rename(tempPath.c_str(), path.c_str()) != 0) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * Frame Benchmark
+ * Fixed length frame time recording for one scenario, written as JSON
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Records CPU and GPU frame times of a benchmark run
+ *
+ * After warmupFrames frames, measuredFrames CPU frame times are recorded, together
+ * with the GPU frame times that arrive in the meantime (GPU times are read back
+ * when a frame slot is reused, so they trail the CPU by a frame or two). The run
+ * is complete once all CPU samples are in. The result is written as JSON in the
+ * format the perfgate tool (BasicDemes/tools/perfgate) compares against baselines.
+ *
+ * CPU frame time is the render thread's CPU time for the frame, so waits for the
+ * swapchain or the GPU are not counted.
+ */
+class FrameBenchmark {
+public:
+    struct Config {
+        std::string scenario;
+        uint32_t warmupFrames = 120;
+        uint32_t measuredFrames = 600;
+    };
+
+    // Written alongside the samples to tell runs on different hardware apart
+    struct DeviceInfo {
+        std::string deviceName;
+        uint32_t driverVersion = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    void start(const Config &config);
+    void stop() { running = false; }
+    bool active() const { return running; }
+    bool complete() const { return running && cpuFrameMs.size() >= config.measuredFrames; }
+    const Config &getConfig() const { return config; }
+
+    void addCpuSample(double ms);
+    void addGpuSample(double ms);
+
+    std::string toJson(const DeviceInfo &device) const;
+    // Writes path.tmp and renames it, so path only ever appears complete
+    bool writeJson(const std::string &path, const DeviceInfo &device) const;
+
+private:
+    Config config;
+    bool running = false;
+    uint32_t framesSeen = 0;
+    std::vector<double> cpuFrameMs;
+    std::vector<double> gpuFrameMs;
+};
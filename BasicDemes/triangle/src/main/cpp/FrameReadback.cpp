@@ -0,0 +1,225 @@
+/*
+ * Frame Readback Implementation
+ */
+
+#include "FrameReadback.hpp"
+#include <cinttypes>
+#include <cstdio>
+
+FrameReadback::~FrameReadback() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    // Frames already handed over are still written
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void FrameReadback::setOutputDirectory(const std::string &directory, FileFormat format) {
+    std::lock_guard<std::mutex> lock(mutex);
+    outputDirectory = directory;
+    fileFormat = format;
+}
+
+void FrameReadback::setCallback(Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->callback = std::move(callback);
+}
+
+void FrameReadback::request(uint32_t frameCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingFrames = frameCount;
+    // The writer thread only exists once something is captured
+    if (frameCount > 0 && !writer.joinable()) {
+        writer = std::thread(&FrameReadback::writerLoop, this);
+    }
+}
+
+void FrameReadback::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingFrames = 0;
+}
+
+bool FrameReadback::requested() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingFrames > 0;
+}
+
+int32_t FrameReadback::beginCapture() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pendingFrames == 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < SLOT_COUNT; i++) {
+        if (slots[i].state == SlotState::Free) {
+            slots[i].state = SlotState::Recording;
+            if (pendingFrames != UINT32_MAX) {
+                pendingFrames--;
+            }
+            return static_cast<int32_t>(i);
+        }
+    }
+    // Writing is slower than rendering, skip this frame rather than wait
+    stats.dropped++;
+    return -1;
+}
+
+void FrameReadback::endCapture(uint32_t slot, uint64_t timelineValue, const Frame &frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    slots[slot].state = SlotState::InFlight;
+    slots[slot].timelineValue = timelineValue;
+    slots[slot].frame = frame;
+    stats.captured++;
+}
+
+void FrameReadback::cancelCapture(uint32_t slot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[slot].state = SlotState::Free;
+        // Nothing was captured, the request still counts this frame
+        if (pendingFrames != UINT32_MAX) {
+            pendingFrames++;
+        }
+    }
+    slotFreed.notify_all();
+}
+
+void FrameReadback::deliverCompleted(uint64_t completedValue,
+                                     const std::function<void(uint32_t slot)> &prepare) {
+    // Slots only leave InFlight on this thread, so prepare runs without the lock
+    std::array<uint32_t, SLOT_COUNT> completed{};
+    uint32_t completedCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < SLOT_COUNT; i++) {
+            if (slots[i].state == SlotState::InFlight && slots[i].timelineValue <= completedValue) {
+                completed[completedCount++] = i;
+            }
+        }
+    }
+    if (completedCount == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < completedCount; i++) {
+        if (prepare) {
+            prepare(completed[i]);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < completedCount; i++) {
+            slots[completed[i]].state = SlotState::Writing;
+            writeQueue.push_back(completed[i]);
+        }
+    }
+    workAvailable.notify_one();
+}
+
+void FrameReadback::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    slotFreed.wait(lock, [this]() {
+        for (const auto &slot: slots) {
+            if (slot.state == SlotState::Writing) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+bool FrameReadback::idle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &slot: slots) {
+        if (slot.state != SlotState::Free) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FrameReadback::Stats FrameReadback::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::string FrameReadback::fileName(const Frame &frame, FileFormat format) {
+    const char *extension = "ppm";
+    if (format == FileFormat::Raw) {
+        extension = frame.format == PixelFormat::BGRA8 ? "bgra" : "rgba";
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "frame_%06" PRIu64 "_%ux%u.%s", frame.frameNumber, frame.width,
+             frame.height, extension);
+    return name;
+}
+
+bool FrameReadback::writeFile(const std::string &path, const Frame &frame, FileFormat format) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    bool ok = true;
+    if (format == FileFormat::Raw) {
+        const size_t rowSize = static_cast<size_t>(frame.width) * 4;
+        for (uint32_t y = 0; y < frame.height && ok; y++) {
+            ok = fwrite(frame.pixels + static_cast<size_t>(y) * frame.rowPitch, 1, rowSize, file) == rowSize;
+        }
+    } else {
+        ok = fprintf(file, "P6\n%u %u\n255\n", frame.width, frame.height) > 0;
+        // PPM is RGB: drop alpha and swizzle BGRA row by row
+        const bool bgra = frame.format == PixelFormat::BGRA8;
+        std::vector<uint8_t> row(static_cast<size_t>(frame.width) * 3);
+        for (uint32_t y = 0; y < frame.height && ok; y++) {
+            const uint8_t *src = frame.pixels + static_cast<size_t>(y) * frame.rowPitch;
+            for (uint32_t x = 0; x < frame.width; x++) {
+                row[x * 3 + 0] = src[x * 4 + (bgra ? 2 : 0)];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + (bgra ? 0 : 2)];
+            }
+            ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+        }
+    }
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+void FrameReadback::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workAvailable.wait(lock, [this]() { return stopping || !writeQueue.empty(); });
+        if (writeQueue.empty()) {
+            return;
+        }
+        uint32_t slot = writeQueue.front();
+        writeQueue.pop_front();
+        Frame frame = slots[slot].frame;
+        Callback frameCallback = callback;
+        std::string directory = outputDirectory;
+        FileFormat format = fileFormat;
+
+        // The slot belongs to this thread until it is marked free again
+        lock.unlock();
+        bool ok = true;
+        if (frameCallback) {
+            frameCallback(frame);
+        } else if (!directory.empty()) {
+            ok = writeFile(directory + "/" + fileName(frame, format), frame, format);
+        }
+        lock.lock();
+
+        slots[slot].state = SlotState::Free;
+        stats.delivered++;
+        if (!ok) {
+            stats.writeErrors++;
+        }
+        slotFreed.notify_all();
+    }
+}
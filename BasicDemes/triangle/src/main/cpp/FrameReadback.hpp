@@ -0,0 +1,133 @@
+/*
+ * Frame Readback
+ * Ring of captured frames handed to a writer thread once the GPU has finished them
+ */
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Hands rendered frames copied into host memory to disk or to a callback
+ *
+ * The render thread copies a frame into one of SLOT_COUNT host visible buffers and
+ * tags the slot with the timeline value of the submission containing the copy. A
+ * slot is only read once that value has completed, so nothing ever waits for the
+ * GPU; if every slot is still in flight or being written the frame is dropped and
+ * counted instead. Completed frames are written on a writer thread, as binary PPM
+ * or raw pixels, or passed to a callback, after which the slot is free again.
+ *
+ * The Vulkan side (buffers, mapping, copy commands) belongs to the caller; this
+ * class only tracks slot ownership between the render and writer threads.
+ *
+ * The writer is a dedicated thread rather than job system work: it blocks on file
+ * writes for as long as a capture runs, which would hold a pool worker that
+ * parallelFor() expects to be free.
+ */
+class FrameReadback {
+public:
+    static constexpr uint32_t SLOT_COUNT = 3;
+
+    enum class PixelFormat : uint8_t {
+        RGBA8,
+        BGRA8
+    };
+
+    enum class FileFormat : uint8_t {
+        Ppm,  // Binary P6, alpha dropped
+        Raw   // Tightly packed rows as captured, .rgba or .bgra
+    };
+
+    struct Frame {
+        uint64_t frameNumber = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t rowPitch = 0;  // Bytes
+        PixelFormat format = PixelFormat::RGBA8;
+        const uint8_t *pixels = nullptr;
+    };
+
+    // Runs on the writer thread; pixels are only valid during the call
+    using Callback = std::function<void(const Frame &frame)>;
+
+    struct Stats {
+        uint64_t captured = 0;     // Copies submitted
+        uint64_t dropped = 0;      // Requested frames without a free slot
+        uint64_t delivered = 0;    // Written or passed to the callback
+        uint64_t writeErrors = 0;
+    };
+
+    FrameReadback() = default;
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback &) = delete;
+    FrameReadback &operator=(const FrameReadback &) = delete;
+
+    // Output: files in a directory, or a callback which replaces file output
+    void setOutputDirectory(const std::string &directory, FileFormat format);
+    void setCallback(Callback callback);
+
+    // Capture the next frameCount frames (UINT32_MAX: until stopped), any thread
+    void request(uint32_t frameCount);
+    void stop();
+    bool requested() const;
+
+    // Render thread: slot to copy the current frame into, or -1 when no frame is
+    // requested or no slot is free. Every returned slot must be ended or cancelled.
+    int32_t beginCapture();
+    // The copy was submitted in the work completing at timelineValue
+    void endCapture(uint32_t slot, uint64_t timelineValue, const Frame &frame);
+    void cancelCapture(uint32_t slot);
+
+    // Render thread: pass every slot whose timeline value has completed to the writer
+    // thread, calling prepare (e.g. to invalidate the mapped memory) for each first
+    void deliverCompleted(uint64_t completedValue, const std::function<void(uint32_t slot)> &prepare);
+    // Block until the writer thread has finished with every delivered frame
+    void flush();
+    // True if no slot is in flight or being written
+    bool idle() const;
+
+    Stats getStats() const;
+
+    // Write one frame as a file in the given format, returns false on I/O errors
+    static bool writeFile(const std::string &path, const Frame &frame, FileFormat format);
+    static std::string fileName(const Frame &frame, FileFormat format);
+
+private:
+    enum class SlotState : uint8_t {
+        Free,
+        Recording,  // Copy being recorded into the current frame
+        InFlight,   // Submitted, waiting for its timeline value
+        Writing     // Owned by the writer thread
+    };
+
+    struct Slot {
+        SlotState state = SlotState::Free;
+        uint64_t timelineValue = 0;
+        Frame frame;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable slotFreed;
+    std::array<Slot, SLOT_COUNT> slots{};
+    std::deque<uint32_t> writeQueue;
+    std::thread writer;
+    bool stopping = false;
+
+    uint32_t pendingFrames = 0;
+    std::string outputDirectory;
+    FileFormat fileFormat = FileFormat::Ppm;
+    Callback callback;
+    Stats stats{};
+
+    void writerLoop();
+};
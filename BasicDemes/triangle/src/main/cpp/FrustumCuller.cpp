@@ -0,0 +1,325 @@
+/*
+ * Frustum Culler Implementation
+ */
+
+#include "FrustumCuller.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_SIMD 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_SIMD 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRUSTUM_CULLER_SIMD 1
+#endif
+
+namespace {
+
+// Vector operations the kernels are written in, one set per instruction set
+#if defined(__AVX2__) && defined(__FMA__)
+struct Lanes {
+    static constexpr uint32_t WIDTH = 8;
+    static constexpr const char *NAME = "AVX2";
+    using Vector = __m256;
+    using Mask = __m256;
+
+    static Vector load(const float *values) { return _mm256_loadu_ps(values); }
+    static Vector splat(float value) { return _mm256_set1_ps(value); }
+    static Vector negate(Vector a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static Vector multiply(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+    // a * b + c
+    static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm256_fmadd_ps(a, b, c); }
+    static Mask greaterEqual(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    // Bit n set for lane n
+    static uint32_t bits(Mask mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask)); }
+};
+#elif defined(__SSE2__)
+struct Lanes {
+    static constexpr uint32_t WIDTH = 4;
+    static constexpr const char *NAME = "SSE2";
+    using Vector = __m128;
+    using Mask = __m128;
+
+    static Vector load(const float *values) { return _mm_loadu_ps(values); }
+    static Vector splat(float value) { return _mm_set1_ps(value); }
+    static Vector negate(Vector a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static Vector multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+    static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static Mask greaterEqual(Vector a, Vector b) { return _mm_cmpge_ps(a, b); }
+    static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static uint32_t bits(Mask mask) { return static_cast<uint32_t>(_mm_movemask_ps(mask)); }
+};
+#elif defined(__ARM_NEON)
+struct Lanes {
+    static constexpr uint32_t WIDTH = 4;
+    static constexpr const char *NAME = "NEON";
+    using Vector = float32x4_t;
+    using Mask = uint32x4_t;
+
+    static Vector load(const float *values) { return vld1q_f32(values); }
+    static Vector splat(float value) { return vdupq_n_f32(value); }
+    static Vector negate(Vector a) { return vnegq_f32(a); }
+    static Vector multiply(Vector a, Vector b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__)
+    static Vector multiplyAdd(Vector a, Vector b, Vector c) { return vfmaq_f32(c, a, b); }
+#else
+    static Vector multiplyAdd(Vector a, Vector b, Vector c) { return vmlaq_f32(c, a, b); }
+#endif
+    static Mask greaterEqual(Vector a, Vector b) { return vcgeq_f32(a, b); }
+    static Mask both(Mask a, Mask b) { return vandq_u32(a, b); }
+    static uint32_t bits(Mask mask) {
+        // No movemask on NEON: keep one distinct bit per lane and add the lanes up
+        static const uint32_t laneBits[4] = {1, 2, 4, 8};
+        uint32x4_t masked = vandq_u32(mask, vld1q_u32(laneBits));
+#if defined(__aarch64__)
+        return vaddvq_u32(masked);
+#else
+        uint32x2_t sum = vpadd_u32(vget_low_u32(masked), vget_high_u32(masked));
+        return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+    }
+};
+#endif
+
+// Appends first + lane for every set bit without branching: the index is always stored
+// and the count only advances for visible lanes. Stores stay below first + WIDTH.
+template <uint32_t WIDTH>
+inline uint32_t appendIndices(uint32_t bits, uint32_t first, uint32_t *visible, uint32_t count) {
+    for (uint32_t lane = 0; lane < WIDTH; lane++) {
+        visible[count] = first + lane;
+        count += (bits >> lane) & 1;
+    }
+    return count;
+}
+
+// Signed distance to a plane, in the same operation order as the vector kernels
+inline float planeDistance(const float plane[4], float x, float y, float z) {
+    return plane[0] * x + (plane[1] * y + (plane[2] * z + plane[3]));
+}
+
+#if defined(FRUSTUM_CULLER_SIMD)
+inline Lanes::Vector planeDistance(const Lanes::Vector plane[4], Lanes::Vector x, Lanes::Vector y,
+                                   Lanes::Vector z) {
+    return Lanes::multiplyAdd(plane[0], x, Lanes::multiplyAdd(plane[1], y, Lanes::multiplyAdd(plane[2], z, plane[3])));
+}
+
+void splatPlanes(const Frustum &frustum, Lanes::Vector planes[6][4]) {
+    for (uint32_t p = 0; p < 6; p++) {
+        for (uint32_t c = 0; c < 4; c++) {
+            planes[p][c] = Lanes::splat(frustum.planes[p][c]);
+        }
+    }
+}
+#endif
+
+}  // namespace
+
+Frustum Frustum::fromMatrix(const float *m) {
+    // Gribb and Hartmann: each plane is the last row plus or minus one of the others
+    Frustum frustum;
+    for (uint32_t p = 0; p < 6; p++) {
+        uint32_t row = p / 2;
+        float sign = (p % 2 == 0) ? 1.0f : -1.0f;
+        float *plane = frustum.planes[p];
+        for (uint32_t c = 0; c < 4; c++) {
+            plane[c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+        }
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (uint32_t c = 0; c < 4; c++) {
+                plane[c] /= length;
+            }
+        }
+    }
+    return frustum;
+}
+
+void BoundingSpheres::resize(uint32_t count) {
+    for (auto *values: {&centerX, &centerY, &centerZ, &radius}) {
+        values->resize(count);
+    }
+}
+
+void BoundingSpheres::set(uint32_t index, float x, float y, float z, float r) {
+    centerX[index] = x;
+    centerY[index] = y;
+    centerZ[index] = z;
+    radius[index] = r;
+}
+
+void BoundingBoxes::resize(uint32_t count) {
+    for (auto *values: {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ}) {
+        values->resize(count);
+    }
+}
+
+void BoundingBoxes::set(uint32_t index, const float min[3], const float max[3]) {
+    centerX[index] = 0.5f * (min[0] + max[0]);
+    centerY[index] = 0.5f * (min[1] + max[1]);
+    centerZ[index] = 0.5f * (min[2] + max[2]);
+    extentX[index] = 0.5f * (max[0] - min[0]);
+    extentY[index] = 0.5f * (max[1] - min[1]);
+    extentZ[index] = 0.5f * (max[2] - min[2]);
+}
+
+uint32_t FrustumCuller::cullRangeScalar(const Frustum &frustum, const BoundingSpheres &spheres,
+                                        uint32_t begin, uint32_t end, uint32_t *visible) {
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        float x = spheres.centerX[i];
+        float y = spheres.centerY[i];
+        float z = spheres.centerZ[i];
+        float negRadius = -spheres.radius[i];
+        bool inside = true;
+        for (const float *plane: frustum.planes) {
+            inside &= planeDistance(plane, x, y, z) >= negRadius;
+        }
+        visible[count] = i;
+        count += inside;
+    }
+    return count;
+}
+
+uint32_t FrustumCuller::cullRangeScalar(const Frustum &frustum, const BoundingBoxes &boxes,
+                                        uint32_t begin, uint32_t end, uint32_t *visible) {
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        float x = boxes.centerX[i];
+        float y = boxes.centerY[i];
+        float z = boxes.centerZ[i];
+        bool inside = true;
+        for (const float *plane: frustum.planes) {
+            // Projected half extent of the box onto the plane normal
+            float reach = std::fabs(plane[0]) * boxes.extentX[i] +
+                          (std::fabs(plane[1]) * boxes.extentY[i] + std::fabs(plane[2]) * boxes.extentZ[i]);
+            inside &= planeDistance(plane, x, y, z) >= -reach;
+        }
+        visible[count] = i;
+        count += inside;
+    }
+    return count;
+}
+
+uint32_t FrustumCuller::cullRange(const Frustum &frustum, const BoundingSpheres &spheres,
+                                  uint32_t begin, uint32_t end, uint32_t *visible) {
+#if defined(FRUSTUM_CULLER_SIMD)
+    Lanes::Vector planes[6][4];
+    splatPlanes(frustum, planes);
+
+    const float *centerX = spheres.centerX.data();
+    const float *centerY = spheres.centerY.data();
+    const float *centerZ = spheres.centerZ.data();
+    const float *radius = spheres.radius.data();
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; end - i >= Lanes::WIDTH; i += Lanes::WIDTH) {
+        Lanes::Vector x = Lanes::load(centerX + i);
+        Lanes::Vector y = Lanes::load(centerY + i);
+        Lanes::Vector z = Lanes::load(centerZ + i);
+        Lanes::Vector negRadius = Lanes::negate(Lanes::load(radius + i));
+        Lanes::Mask inside = Lanes::greaterEqual(planeDistance(planes[0], x, y, z), negRadius);
+        for (uint32_t p = 1; p < 6; p++) {
+            inside = Lanes::both(inside, Lanes::greaterEqual(planeDistance(planes[p], x, y, z), negRadius));
+        }
+        count = appendIndices<Lanes::WIDTH>(Lanes::bits(inside), i, visible, count);
+    }
+    // Remainder below the vector width
+    return count + cullRangeScalar(frustum, spheres, i, end, visible + count);
+#else
+    return cullRangeScalar(frustum, spheres, begin, end, visible);
+#endif
+}
+
+uint32_t FrustumCuller::cullRange(const Frustum &frustum, const BoundingBoxes &boxes,
+                                  uint32_t begin, uint32_t end, uint32_t *visible) {
+#if defined(FRUSTUM_CULLER_SIMD)
+    Lanes::Vector planes[6][4];
+    Lanes::Vector absNormals[6][3];
+    splatPlanes(frustum, planes);
+    for (uint32_t p = 0; p < 6; p++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            absNormals[p][c] = Lanes::splat(std::fabs(frustum.planes[p][c]));
+        }
+    }
+
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; end - i >= Lanes::WIDTH; i += Lanes::WIDTH) {
+        Lanes::Vector x = Lanes::load(boxes.centerX.data() + i);
+        Lanes::Vector y = Lanes::load(boxes.centerY.data() + i);
+        Lanes::Vector z = Lanes::load(boxes.centerZ.data() + i);
+        Lanes::Vector extentX = Lanes::load(boxes.extentX.data() + i);
+        Lanes::Vector extentY = Lanes::load(boxes.extentY.data() + i);
+        Lanes::Vector extentZ = Lanes::load(boxes.extentZ.data() + i);
+        auto planeInside = [&](uint32_t p) {
+            Lanes::Vector reach = Lanes::multiplyAdd(absNormals[p][0], extentX,
+                Lanes::multiplyAdd(absNormals[p][1], extentY, Lanes::multiply(absNormals[p][2], extentZ)));
+            return Lanes::greaterEqual(planeDistance(planes[p], x, y, z), Lanes::negate(reach));
+        };
+        Lanes::Mask inside = planeInside(0);
+        for (uint32_t p = 1; p < 6; p++) {
+            inside = Lanes::both(inside, planeInside(p));
+        }
+        count = appendIndices<Lanes::WIDTH>(Lanes::bits(inside), i, visible, count);
+    }
+    return count + cullRangeScalar(frustum, boxes, i, end, visible + count);
+#else
+    return cullRangeScalar(frustum, boxes, begin, end, visible);
+#endif
+}
+
+const char *FrustumCuller::getSimdName() {
+#if defined(FRUSTUM_CULLER_SIMD)
+    return Lanes::NAME;
+#else
+    return "scalar";
+#endif
+}
+
+uint32_t FrustumCuller::cull(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<uint32_t> &visible) {
+    return cullChunks(frustum, spheres, visible);
+}
+
+uint32_t FrustumCuller::cull(const Frustum &frustum, const BoundingBoxes &boxes, std::vector<uint32_t> &visible) {
+    return cullChunks(frustum, boxes, visible);
+}
+
+template <typename Bounds>
+uint32_t FrustumCuller::cullChunks(const Frustum &frustum, const Bounds &bounds, std::vector<uint32_t> &visible) {
+    // Every chunk may be fully visible, so each gets room for all of its indices
+    const uint32_t boundsCount = bounds.size();
+    visible.resize(boundsCount);
+    const uint32_t chunkCount = (boundsCount + chunkSize - 1) / chunkSize;
+    chunkCounts.assign(chunkCount, 0);
+
+    auto cullChunkRange = [&](uint32_t firstChunk, uint32_t endChunk) {
+        for (uint32_t chunk = firstChunk; chunk < endChunk; chunk++) {
+            uint32_t begin = chunk * chunkSize;
+            uint32_t end = begin + std::min(chunkSize, boundsCount - begin);
+            chunkCounts[chunk] = cullRange(frustum, bounds, begin, end, visible.data() + begin);
+        }
+    };
+    if (jobSystem != nullptr && chunkCount > 1) {
+        jobSystem->parallelFor(chunkCount, 1, cullChunkRange);
+    } else {
+        cullChunkRange(0, chunkCount);
+    }
+
+    // Move every chunk's indices down behind the previous chunk's
+    uint32_t visibleCount = 0;
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+        if (chunk > 0 && chunkCounts[chunk] > 0) {
+            memmove(visible.data() + visibleCount, visible.data() + chunk * chunkSize,
+                    chunkCounts[chunk] * sizeof(uint32_t));
+        }
+        visibleCount += chunkCounts[chunk];
+    }
+    visible.resize(visibleCount);
+    return visibleCount;
+}
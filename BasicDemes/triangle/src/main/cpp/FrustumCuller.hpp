@@ -0,0 +1,87 @@
+/*
+ * Frustum Culler
+ * SIMD visibility tests of bounding sphere and box arrays against the view frustum
+ */
+
+#pragma once
+
+#include "JobSystem.hpp"
+#include <cstdint>
+#include <vector>
+
+// Six normalized planes (nx, ny, nz, d), points inside satisfy dot(n, p) + d >= 0
+struct Frustum {
+    float planes[6][4];
+
+    // Planes of a column-major view projection matrix with OpenGL depth (-1..1), as built
+    // by createPerspectiveMatrix(); for a 0..1 depth range the near plane is conservative
+    static Frustum fromMatrix(const float *viewProjection);
+};
+
+// Bounding spheres, one array per component
+struct BoundingSpheres {
+    std::vector<float> centerX, centerY, centerZ, radius;
+
+    void resize(uint32_t count);
+    uint32_t size() const { return static_cast<uint32_t>(radius.size()); }
+    void set(uint32_t index, float x, float y, float z, float r);
+};
+
+// Axis aligned boxes as center and half extent, one array per component
+struct BoundingBoxes {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    void resize(uint32_t count);
+    uint32_t size() const { return static_cast<uint32_t>(extentX.size()); }
+    void set(uint32_t index, const float min[3], const float max[3]);
+};
+
+/**
+ * @brief Writes the indices of the bounds intersecting a frustum
+ *
+ * The kernels test 8 bounds per iteration with AVX2, 4 with SSE2 or NEON, whichever
+ * the file is compiled for (AVX2 needs -mavx2 -mfma, see CULLING_AVX2 in
+ * CMakeLists.txt), and fall back to scalar code otherwise. Indices are appended
+ * without branches on the test results, so the cost does not depend on how many
+ * bounds are visible. Tests are per plane and therefore conservative: bounds just
+ * outside a frustum corner, but not fully behind any one plane, count as visible.
+ *
+ * cull() splits the arrays into chunks of chunkSize bounds that run as jobs of the
+ * job system, the calling thread included. Each chunk writes into its own range of
+ * the output, which is then compacted, so the result is in ascending index order
+ * regardless of the split.
+ */
+class FrustumCuller {
+public:
+    // Visible indices of [begin, end) written to visible, returns their count; visible
+    // needs room for end - begin indices
+    static uint32_t cullRange(const Frustum &frustum, const BoundingSpheres &spheres,
+                              uint32_t begin, uint32_t end, uint32_t *visible);
+    static uint32_t cullRange(const Frustum &frustum, const BoundingBoxes &boxes,
+                              uint32_t begin, uint32_t end, uint32_t *visible);
+    // Scalar reference versions of the kernels
+    static uint32_t cullRangeScalar(const Frustum &frustum, const BoundingSpheres &spheres,
+                                    uint32_t begin, uint32_t end, uint32_t *visible);
+    static uint32_t cullRangeScalar(const Frustum &frustum, const BoundingBoxes &boxes,
+                                    uint32_t begin, uint32_t end, uint32_t *visible);
+    // Instruction set the kernels were compiled for
+    static const char *getSimdName();
+
+    // Replaces visible with the visible indices, returns their count
+    uint32_t cull(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<uint32_t> &visible);
+    uint32_t cull(const Frustum &frustum, const BoundingBoxes &boxes, std::vector<uint32_t> &visible);
+
+    void setChunkSize(uint32_t size) { chunkSize = size > 0 ? size : 1; }
+    // Without a job system all chunks run on the calling thread
+    void setJobSystem(JobSystem *jobs) { jobSystem = jobs; }
+
+private:
+    uint32_t chunkSize = 16384;
+    JobSystem *jobSystem = nullptr;
+    // Visible count of each chunk
+    std::vector<uint32_t> chunkCounts;
+
+    template <typename Bounds>
+    uint32_t cullChunks(const Frustum &frustum, const Bounds &bounds, std::vector<uint32_t> &visible);
+};
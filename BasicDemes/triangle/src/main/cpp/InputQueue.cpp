@@ -0,0 +1,122 @@
+/*
+ * Input Queue Implementation
+ */
+
+#include "InputQueue.hpp"
+#include <time.h>
+
+bool InputQueue::collect(android_app *app) {
+    android_input_buffer *inputBuffer = android_app_swap_input_buffers(app);
+    if (inputBuffer == nullptr) {
+        return false;
+    }
+
+    bool hasEvents = inputBuffer->motionEventsCount > 0 || inputBuffer->keyEventsCount > 0;
+
+    for (uint64_t i = 0; i < inputBuffer->motionEventsCount; i++) {
+        collectMotionEvent(inputBuffer->motionEvents[i]);
+    }
+    if (inputBuffer->motionEventsCount > 0) {
+        android_app_clear_motion_events(inputBuffer);
+    }
+
+    for (uint64_t i = 0; i < inputBuffer->keyEventsCount; i++) {
+        const GameActivityKeyEvent &keyEvent = inputBuffer->keyEvents[i];
+        InputEvent event{};
+        event.type = InputEvent::Type::Key;
+        event.action = keyEvent.action;
+        event.keyCode = keyEvent.keyCode;
+        event.eventTimeNs = keyEvent.eventTime;
+        event.firstEventTimeNs = keyEvent.eventTime;
+        push(event);
+    }
+    if (inputBuffer->keyEventsCount > 0) {
+        android_app_clear_key_events(inputBuffer);
+    }
+
+    return hasEvents;
+}
+
+void InputQueue::collectMotionEvent(const GameActivityMotionEvent &motionEvent) {
+    int32_t action = motionEvent.action & AMOTION_EVENT_ACTION_MASK;
+    size_t actionIndex = (motionEvent.action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK)
+            >> AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
+
+    for (uint32_t p = 0; p < motionEvent.pointerCount; p++) {
+        const GameActivityPointerAxes &pointer = motionEvent.pointers[p];
+        InputEvent event{};
+        event.type = InputEvent::Type::Touch;
+        event.pointerId = pointer.id;
+        event.x = GameActivityPointerAxes_getX(&pointer);
+        event.y = GameActivityPointerAxes_getY(&pointer);
+        event.eventTimeNs = motionEvent.eventTime;
+        event.firstEventTimeNs = motionEvent.eventTime;
+
+        // Pointer down/up only concern the pointer at the action index, the
+        // others report their current position as a move
+        bool pointerAction = action == AMOTION_EVENT_ACTION_POINTER_DOWN ||
+                             action == AMOTION_EVENT_ACTION_POINTER_UP;
+        if (action == AMOTION_EVENT_ACTION_MOVE || (pointerAction && p != actionIndex)) {
+            event.action = AMOTION_EVENT_ACTION_MOVE;
+            mergeMove(event);
+            continue;
+        }
+
+        if (action == AMOTION_EVENT_ACTION_POINTER_DOWN) {
+            event.action = AMOTION_EVENT_ACTION_DOWN;
+        } else if (action == AMOTION_EVENT_ACTION_POINTER_UP) {
+            event.action = AMOTION_EVENT_ACTION_UP;
+        } else {
+            event.action = action;
+        }
+        flushPointer(pointer.id);
+        push(event);
+    }
+}
+
+void InputQueue::mergeMove(const InputEvent &event) {
+    if (event.pointerId < 0 || event.pointerId >= static_cast<int32_t>(MAX_POINTERS)) {
+        push(event);
+        return;
+    }
+    InputEvent &pending = pendingMoves[event.pointerId];
+    if (!hasPendingMove[event.pointerId]) {
+        pending = event;
+        hasPendingMove[event.pointerId] = true;
+        return;
+    }
+    // Keep the newest position and the oldest timestamp
+    int64_t firstEventTimeNs = pending.firstEventTimeNs;
+    uint32_t sampleCount = pending.sampleCount + event.sampleCount;
+    pending = event;
+    pending.firstEventTimeNs = firstEventTimeNs;
+    pending.sampleCount = sampleCount;
+}
+
+void InputQueue::flushPointer(int32_t pointerId) {
+    if (pointerId < 0 || pointerId >= static_cast<int32_t>(MAX_POINTERS)) {
+        return;
+    }
+    if (hasPendingMove[pointerId]) {
+        push(pendingMoves[pointerId]);
+        hasPendingMove[pointerId] = false;
+    }
+}
+
+void InputQueue::flush() {
+    for (uint32_t i = 0; i < MAX_POINTERS; i++) {
+        flushPointer(static_cast<int32_t>(i));
+    }
+}
+
+void InputQueue::push(const InputEvent &event) {
+    if (!ring.tryPush(event)) {
+        droppedEvents++;
+    }
+}
+
+int64_t InputQueue::nowNs() {
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
@@ -0,0 +1,71 @@
+/*
+ * Input Queue
+ * Timestamped GameActivity input handed from the main thread to the simulation
+ */
+
+#pragma once
+
+#include <game-activity/native_app_glue/android_native_app_glue.h>
+
+#include "SpscRing.hpp"
+
+#include <array>
+#include <cstdint>
+
+// Input event copied out of the GameActivity buffer
+struct InputEvent {
+    enum class Type : uint8_t {
+        Touch,
+        Key
+    };
+
+    Type type = Type::Touch;
+    int32_t action = 0;            // Masked AMOTION_EVENT_ACTION_* or AKEY_EVENT_ACTION_*
+    int32_t pointerId = 0;         // Touch only
+    int32_t keyCode = 0;           // Key only
+    float x = 0.0f;                // Touch only, window pixels
+    float y = 0.0f;
+    int64_t eventTimeNs = 0;       // Newest merged sample, CLOCK_MONOTONIC
+    int64_t firstEventTimeNs = 0;  // Oldest merged sample, start of the input latency
+    uint32_t sampleCount = 1;      // Motion samples merged into this event
+};
+
+/**
+ * @brief Preallocated input queue between the main thread and one consumer
+ *
+ * The main thread copies events out of the GameActivity input buffer with their
+ * event timestamps. Moves are merged per pointer until flush() is called once per
+ * frame, so a fast touch stream costs one event per pointer and frame; downs, ups
+ * and keys are queued immediately, after any pending move of the same pointer.
+ * Nothing allocates after construction; events that do not fit are dropped and
+ * counted.
+ */
+class InputQueue {
+public:
+    static constexpr size_t CAPACITY = 256;
+    static constexpr uint32_t MAX_POINTERS = 8;
+
+    // Main thread: take all events from the app input buffer, returns true if there were any
+    bool collect(android_app *app);
+    // Main thread: queue the merged moves, call once per frame
+    void flush();
+
+    // Consumer thread: next event in arrival order
+    bool pop(InputEvent &event) { return ring.tryPop(event); }
+
+    uint64_t getDroppedCount() const { return droppedEvents; }
+
+    // Same clock as GameActivity event times (CLOCK_MONOTONIC)
+    static int64_t nowNs();
+
+private:
+    SpscRing<InputEvent, CAPACITY> ring;
+    std::array<InputEvent, MAX_POINTERS> pendingMoves{};
+    std::array<bool, MAX_POINTERS> hasPendingMove{};
+    uint64_t droppedEvents = 0;
+
+    void collectMotionEvent(const GameActivityMotionEvent &motionEvent);
+    void mergeMove(const InputEvent &event);
+    void flushPointer(int32_t pointerId);
+    void push(const InputEvent &event);
+};
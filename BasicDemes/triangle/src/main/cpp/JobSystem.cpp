@@ -0,0 +1,339 @@
+/*
+ * Job System Implementation
+ */
+
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Pool and worker index of the current thread, set by the worker threads
+thread_local const JobSystem *currentSystem = nullptr;
+thread_local uint32_t currentThreadIndex = 0;
+
+uint64_t readNumber(const char *path) {
+    unsigned long long value = 0;
+    if (FILE *file = fopen(path, "r")) {
+        if (fscanf(file, "%llu", &value) != 1) {
+            value = 0;
+        }
+        fclose(file);
+    }
+    return value;
+}
+
+}  // namespace
+
+CpuTopology CpuTopology::query() {
+    CpuTopology topology;
+    topology.coreCount = std::max(1u, std::thread::hardware_concurrency());
+
+    // "possible" also covers cores that are offline right now, which on phones are
+    // often the big ones
+    if (FILE *file = fopen("/sys/devices/system/cpu/possible", "r")) {
+        unsigned first = 0;
+        unsigned last = 0;
+        int fields = fscanf(file, "%u-%u", &first, &last);
+        if (fields == 1) {
+            last = first;
+        }
+        if (fields >= 1 && last < 1024) {
+            topology.coreCount = std::max(topology.coreCount, last + 1);
+        }
+        fclose(file);
+    }
+
+    // 0 when a core's frequency cannot be read
+    std::vector<uint64_t> maxFrequencies(topology.coreCount);
+    uint64_t slowest = 0;
+    uint64_t fastest = 0;
+    for (uint32_t core = 0; core < topology.coreCount; core++) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", core);
+        uint64_t frequency = readNumber(path);
+        maxFrequencies[core] = frequency;
+        if (frequency > 0) {
+            slowest = slowest == 0 ? frequency : std::min(slowest, frequency);
+            fastest = std::max(fastest, frequency);
+        }
+    }
+
+    topology.uniform = slowest == fastest;
+    for (uint32_t core = 0; core < topology.coreCount; core++) {
+        if (topology.uniform || maxFrequencies[core] > slowest) {
+            topology.fastCores.push_back(core);
+        }
+    }
+    return topology;
+}
+
+bool JobCounter::done() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending == 0;
+}
+
+JobSystem::JobSystem() : mainThreadId(std::this_thread::get_id()) {}
+
+JobSystem::~JobSystem() {
+    stop();
+}
+
+void JobSystem::start(uint32_t workerCount, uint32_t minWorkerCount) {
+    stop();
+    topology = CpuTopology::query();
+    mainThreadId = std::this_thread::get_id();
+    if (workerCount == AUTO) {
+        workerCount = std::max<uint32_t>(1, static_cast<uint32_t>(topology.fastCores.size())) - 1;
+        workerCount = std::max(workerCount, std::min(minWorkerCount, topology.coreCount - 1));
+    }
+
+    // Every deque exists before the first worker can try to steal from it
+    stopping = false;
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i + 1);
+    }
+}
+
+void JobSystem::stop() {
+    assert(getThreadIndex() == 0 && "Main thread jobs can only be drained on the main thread");
+    if (!workers.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker: workers) {
+            worker->thread.join();
+        }
+    }
+
+    // Workers leave main thread jobs behind, and only return once the other queues
+    // are empty; jobs run here may still queue continuations
+    Job job;
+    while (takeJob(0, job)) {
+        runJob(job);
+    }
+    workers.clear();
+}
+
+uint32_t JobSystem::getThreadIndex() const {
+    if (currentSystem == this) {
+        return currentThreadIndex;
+    }
+    return std::this_thread::get_id() == mainThreadId ? 0 : NOT_IN_POOL;
+}
+
+void JobSystem::submit(std::function<void()> work, JobCounter *counter, bool mainThread) {
+    if (counter != nullptr) {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        counter->pending++;
+    }
+    push({std::move(work), counter}, mainThread);
+}
+
+void JobSystem::continueWith(JobCounter &counter, std::function<void()> work, JobCounter *workCounter,
+                             bool mainThread) {
+    // Counted right away, so waiting on workCounter also waits for counter
+    if (workCounter != nullptr) {
+        std::lock_guard<std::mutex> lock(workCounter->mutex);
+        workCounter->pending++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(counter.mutex);
+        if (counter.pending > 0) {
+            counter.continuations.push_back({std::move(work), workCounter, mainThread});
+            return;
+        }
+    }
+    push({std::move(work), workCounter}, mainThread);
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    const uint32_t thread = getThreadIndex();
+    while (!counter.done()) {
+        Job job;
+        if (takeJob(thread, job)) {
+            runJob(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait(lock, [&]() {
+            return counter.done() || queuedJobs.load() > 0 || (thread == 0 && queuedMainJobs.load() > 0);
+        });
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grain,
+                            const std::function<void(uint32_t, uint32_t)> &function) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max(grain, 1u);
+    const uint32_t rangeCount = 1 + (count - 1) / grain;
+
+    // The calling thread takes the first range and then helps with the others
+    JobCounter counter;
+    for (uint32_t range = 1; range < rangeCount; range++) {
+        uint32_t begin = range * grain;
+        uint32_t end = begin + std::min(grain, count - begin);
+        submit([&function, begin, end]() { function(begin, end); }, &counter);
+    }
+    function(0, std::min(grain, count));
+    wait(counter);
+}
+
+void JobSystem::push(Job job, bool mainThread) {
+    // Queue counters change under the queue's lock, so they never drop below the
+    // number of jobs actually queued
+    const uint32_t thread = getThreadIndex();
+    if (mainThread) {
+        std::lock_guard<std::mutex> lock(mainMutex);
+        mainJobs.push_back(std::move(job));
+        queuedMainJobs++;
+    } else if (thread != 0 && thread != NOT_IN_POOL) {
+        Worker &worker = *workers[thread - 1];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+        queuedJobs++;
+    } else {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        sharedJobs.push_back(std::move(job));
+        queuedJobs++;
+    }
+
+    // Taking the lock orders the push before any sleeper's predicate check
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    if (mainThread) {
+        wake.notify_all();
+    } else {
+        wake.notify_one();
+    }
+}
+
+bool JobSystem::takeJob(uint32_t thread, Job &job) {
+    // Main thread jobs can run nowhere else, so the main thread takes them first
+    if (thread == 0 && queuedMainJobs.load() > 0) {
+        std::lock_guard<std::mutex> lock(mainMutex);
+        if (!mainJobs.empty()) {
+            job = std::move(mainJobs.front());
+            mainJobs.pop_front();
+            queuedMainJobs--;
+            return true;
+        }
+    }
+    if (queuedJobs.load() == 0) {
+        return false;
+    }
+
+    // A worker's own newest job first, its data is most likely still in cache
+    const bool worker = thread != 0 && thread != NOT_IN_POOL;
+    if (worker) {
+        Worker &own = *workers[thread - 1];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queuedJobs--;
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (!sharedJobs.empty()) {
+            job = std::move(sharedJobs.front());
+            sharedJobs.pop_front();
+            queuedJobs--;
+            return true;
+        }
+    }
+
+    // Steal the oldest job of another worker, starting with the next one
+    const uint32_t workerCount = static_cast<uint32_t>(workers.size());
+    const uint32_t first = worker ? thread : 0;
+    for (uint32_t i = 0; i < workerCount; i++) {
+        uint32_t victimIndex = (first + i) % workerCount;
+        if (worker && victimIndex == thread - 1) {
+            continue;
+        }
+        Worker &victim = *workers[victimIndex];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queuedJobs--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::runJob(Job &job) {
+    job.work();
+    JobCounter *counter = job.counter;
+    if (counter == nullptr) {
+        return;
+    }
+
+    std::vector<JobCounter::Continuation> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (--counter->pending > 0) {
+            return;
+        }
+        continuations.swap(counter->continuations);
+    }
+    // A waiter may return and destroy the counter from here on
+    for (auto &continuation: continuations) {
+        push({std::move(continuation.work), continuation.counter}, continuation.mainThread);
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_all();
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    currentSystem = this;
+    currentThreadIndex = index;
+
+#if defined(__linux__)
+    char name[16];
+    snprintf(name, sizeof(name), "job worker %u", index);
+    pthread_setname_np(pthread_self(), name);
+
+    // Keep workers off the little cores; best effort, some devices restrict affinity
+    if (!topology.uniform) {
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        for (uint32_t core: topology.fastCores) {
+            CPU_SET(core, &cores);
+        }
+        sched_setaffinity(0, sizeof(cores), &cores);
+    }
+#endif
+
+    for (;;) {
+        Job job;
+        if (takeJob(index, job)) {
+            runJob(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (stopping && queuedJobs.load() == 0) {
+            return;
+        }
+        wake.wait(lock, [this]() { return stopping || queuedJobs.load() > 0; });
+    }
+}
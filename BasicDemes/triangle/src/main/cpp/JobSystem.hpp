@@ -0,0 +1,139 @@
+/*
+ * Job System
+ * Work-stealing thread pool with wait counters, continuations and parallel for
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// CPU cores grouped by their maximum frequency, read from /sys/devices/system/cpu
+struct CpuTopology {
+    uint32_t coreCount = 0;
+    // Cores faster than the slowest cluster (big and prime cores on big.LITTLE), every
+    // core when all run at the same frequency or it cannot be read
+    std::vector<uint32_t> fastCores;
+    bool uniform = true;
+
+    static CpuTopology query();
+};
+
+/**
+ * @brief Number of unfinished jobs, to wait on or continue from
+ *
+ * Jobs submitted with a counter increment it and decrement it when they finish.
+ * Continuations are submitted once it drops to zero. A counter must outlive its
+ * jobs and can be reused after reaching zero.
+ */
+class JobCounter {
+public:
+    bool done() const;
+
+private:
+    friend class JobSystem;
+    struct Continuation {
+        std::function<void()> work;
+        JobCounter *counter;
+        bool mainThread;
+    };
+
+    mutable std::mutex mutex;
+    uint32_t pending = 0;
+    std::vector<Continuation> continuations;
+};
+
+/**
+ * @brief Thread pool shared by all CPU side parallel work
+ *
+ * Every worker has its own deque: it pushes and pops its own jobs at the back,
+ * while idle workers steal from the front of the others'. Jobs submitted from
+ * other threads go to a shared queue. Jobs flagged as main thread jobs only run on
+ * the thread that called start(), while it waits on a counter.
+ *
+ * There are no fibers: wait() runs other jobs on the waiting thread's stack until
+ * the counter reaches zero, so a waiting thread keeps helping instead of blocking.
+ * Continuations (continueWith()) express dependencies without waiting at all.
+ *
+ * By default there is one worker per fast core besides the main thread's, and on
+ * big.LITTLE CPUs the workers are kept off the little cores, which would otherwise
+ * hold up every parallelFor() with their slowest share.
+ *
+ * Long running loops that block or sleep, such as the frame readback writer and the
+ * fixed step simulation, keep their own threads instead of occupying a worker.
+ */
+class JobSystem {
+public:
+    static constexpr uint32_t AUTO = UINT32_MAX;
+    // getThreadIndex() of threads outside the pool
+    static constexpr uint32_t NOT_IN_POOL = UINT32_MAX;
+
+    JobSystem();
+    ~JobSystem();
+
+    // Starts workerCount worker threads, or for AUTO the topology's default but at
+    // least minWorkerCount (at most one per other core). The calling thread becomes
+    // the main thread. Without workers, jobs run on the threads waiting for them.
+    void start(uint32_t workerCount = AUTO, uint32_t minWorkerCount = 0);
+    // Main thread only: lets the workers finish every queued job and joins them, then
+    // runs the main thread jobs left, and everything queued when there were no workers
+    void stop();
+
+    uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+    const CpuTopology &getTopology() const { return topology; }
+    // 0 for the main thread, 1 + worker index for workers
+    uint32_t getThreadIndex() const;
+
+    void submit(std::function<void()> work, JobCounter *counter = nullptr, bool mainThread = false);
+    // Submits work once counter reaches zero, right away if it already has; workCounter
+    // must be another counter
+    void continueWith(JobCounter &counter, std::function<void()> work, JobCounter *workCounter = nullptr,
+                      bool mainThread = false);
+    // Runs jobs until counter reaches zero
+    void wait(JobCounter &counter);
+
+    // Calls function(begin, end) for ranges of at most grain indices covering [0, count)
+    // on the pool and the calling thread, returns once all of them have run
+    void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)> &function);
+
+private:
+    struct Job {
+        std::function<void()> work;
+        JobCounter *counter = nullptr;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    CpuTopology topology;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::thread::id mainThreadId;
+
+    // Jobs from threads outside the pool, and jobs for the main thread only
+    std::mutex sharedMutex;
+    std::deque<Job> sharedJobs;
+    std::mutex mainMutex;
+    std::deque<Job> mainJobs;
+
+    // Idle threads sleep until jobs are queued, a counter reaches zero or stop()
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<uint32_t> queuedJobs{0};
+    std::atomic<uint32_t> queuedMainJobs{0};
+    bool stopping = false;
+
+    void push(Job job, bool mainThread);
+    bool takeJob(uint32_t thread, Job &job);
+    void runJob(Job &job);
+    void workerLoop(uint32_t index);
+};
@@ -0,0 +1,96 @@
+/*
+ * KTX2 Implementation
+ */
+
+#include "Ktx2.hpp"
+#include "TextureFormats.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+// Identifier, nine header words and the index (four 32-bit and two 64-bit fields)
+constexpr size_t HEADER_SIZE = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+constexpr size_t LEVEL_INDEX_ENTRY_SIZE = 3 * 8;
+
+// KTX2 is little endian, as is every platform this runs on
+template<typename T>
+T read(const uint8_t *data, size_t offset) {
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+}  // namespace
+
+bool Ktx2::parse(const uint8_t *data, size_t size, Ktx2 &file, std::string &error) {
+    if (size < HEADER_SIZE || memcmp(data, IDENTIFIER, sizeof(IDENTIFIER)) != 0) {
+        error = "not a KTX2 file";
+        return false;
+    }
+
+    const uint32_t vkFormat = read<uint32_t>(data, 12);
+    const uint32_t pixelWidth = read<uint32_t>(data, 20);
+    const uint32_t pixelHeight = read<uint32_t>(data, 24);
+    const uint32_t pixelDepth = read<uint32_t>(data, 28);
+    const uint32_t layerCount = read<uint32_t>(data, 32);
+    const uint32_t faceCount = read<uint32_t>(data, 36);
+    const uint32_t levelCount = read<uint32_t>(data, 40);
+    const uint32_t supercompressionScheme = read<uint32_t>(data, 44);
+
+    if (vkFormat == VK_FORMAT_UNDEFINED) {
+        error = "Basis Universal textures need a transcoder";
+        return false;
+    }
+    if (supercompressionScheme != 0) {
+        error = "supercompressed textures are not supported";
+        return false;
+    }
+    if (pixelWidth == 0 || pixelHeight == 0 || pixelDepth != 0 || layerCount > 1 || faceCount != 1) {
+        error = "only single 2D images are supported";
+        return false;
+    }
+
+    file = Ktx2();
+    file.format = static_cast<VkFormat>(vkFormat);
+    file.width = pixelWidth;
+    file.height = pixelHeight;
+    // A level count of 0 asks the loader to generate mips, the file holds the base level
+    file.levelCount = levelCount > 0 ? levelCount : 1;
+    file.generateMips = levelCount == 0;
+
+    uint32_t maxLevels = 1;
+    while ((std::max(pixelWidth, pixelHeight) >> maxLevels) > 0) {
+        maxLevels++;
+    }
+    if (file.levelCount > maxLevels) {
+        error = "more mip levels than the image size allows";
+        return false;
+    }
+    if (size < HEADER_SIZE + file.levelCount * LEVEL_INDEX_ENTRY_SIZE) {
+        error = "truncated level index";
+        return false;
+    }
+
+    file.levels.resize(file.levelCount);
+    for (uint32_t i = 0; i < file.levelCount; i++) {
+        const size_t entry = HEADER_SIZE + i * LEVEL_INDEX_ENTRY_SIZE;
+        Level &level = file.levels[i];
+        level.offset = read<uint64_t>(data, entry);
+        level.length = read<uint64_t>(data, entry + 8);
+        if (level.offset > size || level.length > size - level.offset) {
+            error = "level " + std::to_string(i) + " lies outside the file";
+            return false;
+        }
+        // Formats the loader knows must have exactly one image per level
+        const VkDeviceSize expected = TextureFormats::getLevelSize(file.format,
+                                                                   std::max(pixelWidth >> i, 1u),
+                                                                   std::max(pixelHeight >> i, 1u));
+        if (expected != 0 && level.length != expected) {
+            error = "level " + std::to_string(i) + " has an unexpected size";
+            return false;
+        }
+    }
+    return true;
+}
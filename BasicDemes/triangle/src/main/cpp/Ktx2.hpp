@@ -0,0 +1,40 @@
+/*
+ * KTX2
+ * Parser for the KTX 2.0 texture container
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Header and mip level index of a KTX2 file held in memory
+ *
+ * Supports what the texture loader uploads: single 2D images (no arrays, cube maps
+ * or 3D textures) in a plain Vulkan format without supercompression. Basis
+ * Universal and Zstandard payloads are rejected, they need a transcoder that is not
+ * part of this project. Level 0 is the full resolution image; level offsets point
+ * into the file data passed to parse(), which the caller keeps.
+ */
+class Ktx2 {
+public:
+    struct Level {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+    };
+
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t levelCount = 0;
+    // The file stores levelCount 0: only the base level, mips are to be generated
+    bool generateMips = false;
+    std::vector<Level> levels;
+
+    // Returns false with a message in error for malformed or unsupported files
+    static bool parse(const uint8_t *data, size_t size, Ktx2 &file, std::string &error);
+};
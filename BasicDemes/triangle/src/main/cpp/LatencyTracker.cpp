@@ -0,0 +1,142 @@
+/*
+ * Latency Tracker Implementation
+ */
+
+#include "LatencyTracker.hpp"
+#include <algorithm>
+
+LatencyTracker::LatencyTracker() {
+    cpuToPresentMs.reserve(MAX_SAMPLES);
+    inputToPresentMs.reserve(MAX_SAMPLES);
+    cpuToSubmitMs.reserve(MAX_SAMPLES);
+}
+
+uint32_t LatencyTracker::beginFrame(int64_t cpuStartNs) {
+    uint32_t frameId = nextFrameId++;
+    if (nextFrameId == 0) {
+        nextFrameId = 1;
+    }
+
+    // Reusing a slot that is still open means its present time never arrived
+    FrameRecord &record = records[frameId % MAX_OPEN_FRAMES];
+    if (record.open) {
+        lostFrames++;
+    }
+    record = {};
+    record.frameId = frameId;
+    record.open = true;
+    record.cpuStartNs = cpuStartNs;
+    return frameId;
+}
+
+void LatencyTracker::setInputTime(uint32_t frameId, int64_t inputNs) {
+    FrameRecord *record = findRecord(frameId);
+    if (record != nullptr) {
+        record->inputNs = inputNs;
+    }
+}
+
+void LatencyTracker::markSubmitted(uint32_t frameId, int64_t submitNs, uint64_t timelineValue) {
+    FrameRecord *record = findRecord(frameId);
+    if (record == nullptr) {
+        return;
+    }
+
+    // Earlier frames that are submitted but not presented yet
+    uint32_t queuedFrames = 0;
+    for (const auto &other: records) {
+        if (other.open && other.submitted) {
+            queuedFrames++;
+        }
+    }
+    queuedFramesSum += queuedFrames;
+    queuedFramesMax = std::max(queuedFramesMax, queuedFrames);
+    submittedFrames++;
+
+    record->submitted = true;
+    record->submitNs = submitNs;
+    record->timelineValue = timelineValue;
+    addSample(cpuToSubmitMs, submitNs - record->cpuStartNs);
+}
+
+void LatencyTracker::markPresented(uint32_t frameId, int64_t presentNs) {
+    FrameRecord *record = findRecord(frameId);
+    if (record != nullptr && record->submitted) {
+        closeRecord(*record, presentNs);
+    }
+}
+
+void LatencyTracker::markCompleted(uint64_t completedValue, int64_t nowNs) {
+    for (auto &record: records) {
+        if (record.open && record.submitted && record.timelineValue <= completedValue) {
+            closeRecord(record, nowNs);
+        }
+    }
+}
+
+LatencyTracker::Report LatencyTracker::takeReport() {
+    Report report{};
+    report.cpuToPresent = computeDistribution(cpuToPresentMs);
+    report.inputToPresent = computeDistribution(inputToPresentMs);
+    report.cpuToSubmit = computeDistribution(cpuToSubmitMs);
+    if (submittedFrames > 0) {
+        report.averageQueuedFrames = static_cast<double>(queuedFramesSum) /
+                                     static_cast<double>(submittedFrames);
+    }
+    report.maxQueuedFrames = queuedFramesMax;
+    report.frames = presentedFrames;
+    report.lostFrames = lostFrames;
+    report.presentSource = presentSource;
+
+    cpuToPresentMs.clear();
+    inputToPresentMs.clear();
+    cpuToSubmitMs.clear();
+    queuedFramesSum = 0;
+    queuedFramesMax = 0;
+    submittedFrames = 0;
+    presentedFrames = 0;
+    lostFrames = 0;
+    return report;
+}
+
+LatencyTracker::FrameRecord *LatencyTracker::findRecord(uint32_t frameId) {
+    FrameRecord &record = records[frameId % MAX_OPEN_FRAMES];
+    if (!record.open || record.frameId != frameId) {
+        return nullptr;
+    }
+    return &record;
+}
+
+void LatencyTracker::closeRecord(FrameRecord &record, int64_t presentNs) {
+    addSample(cpuToPresentMs, presentNs - record.cpuStartNs);
+    if (record.inputNs != 0) {
+        addSample(inputToPresentMs, presentNs - record.inputNs);
+    }
+    presentedFrames++;
+    record.open = false;
+}
+
+void LatencyTracker::addSample(std::vector<float> &samples, int64_t durationNs) {
+    // Keep the first samples of a reporting window, the vector never grows
+    if (samples.size() < MAX_SAMPLES) {
+        samples.push_back(static_cast<float>(static_cast<double>(durationNs) / 1.0e6));
+    }
+}
+
+LatencyTracker::Distribution LatencyTracker::computeDistribution(std::vector<float> &samples) {
+    Distribution distribution{};
+    if (samples.empty()) {
+        return distribution;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+        return static_cast<double>(samples[index]);
+    };
+    distribution.count = static_cast<uint32_t>(samples.size());
+    distribution.p50Ms = percentile(0.50);
+    distribution.p90Ms = percentile(0.90);
+    distribution.p99Ms = percentile(0.99);
+    distribution.maxMs = static_cast<double>(samples.back());
+    return distribution;
+}
@@ -0,0 +1,104 @@
+/*
+ * Latency Tracker
+ * Per frame CPU start, input, submit and present times with latency distributions
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Tracks frames from CPU start to present and reports latency percentiles
+ *
+ * Every frame gets a record when the CPU starts working on it. The record is
+ * tagged with the input sample time it reflects, its submit time and the timeline
+ * value that signals its GPU completion, and is closed once a present time is
+ * known: either the actual time reported by the display (VK_GOOGLE_display_timing)
+ * or, without it, the time GPU completion was observed. The latter is only an
+ * estimate: completion is polled once per frame and the display may show the
+ * frame a refresh or more later. All times are CLOCK_MONOTONIC nanoseconds.
+ *
+ * At submit the number of earlier frames that are not presented yet is recorded,
+ * which shows how deep the swapchain/GPU queue is running.
+ */
+class LatencyTracker {
+public:
+    enum class PresentSource : uint8_t {
+        DisplayTiming,  // Actual present time from the presentation engine
+        GpuComplete     // Time the frame's GPU work was seen complete
+    };
+
+    struct Distribution {
+        uint32_t count = 0;
+        double p50Ms = 0.0;
+        double p90Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    struct Report {
+        Distribution cpuToPresent;    // CPU frame start until present
+        Distribution inputToPresent;  // Oldest input sample until present, frames with input only
+        Distribution cpuToSubmit;     // CPU frame start until queue submit
+        double averageQueuedFrames = 0.0;
+        uint32_t maxQueuedFrames = 0;
+        uint64_t frames = 0;          // Frames with a present time
+        uint64_t lostFrames = 0;      // Frames evicted before a present time arrived
+        PresentSource presentSource = PresentSource::GpuComplete;
+    };
+
+    // Records kept open while waiting for a present time
+    static constexpr uint32_t MAX_OPEN_FRAMES = 16;
+    // Samples kept per distribution between reports
+    static constexpr size_t MAX_SAMPLES = 1024;
+
+    LatencyTracker();
+
+    void setPresentSource(PresentSource source) { presentSource = source; }
+    PresentSource getPresentSource() const { return presentSource; }
+
+    // Start a frame record, returns its id (also used as present id)
+    uint32_t beginFrame(int64_t cpuStartNs);
+    void setInputTime(uint32_t frameId, int64_t inputNs);
+    void markSubmitted(uint32_t frameId, int64_t submitNs, uint64_t timelineValue);
+
+    // Present time from the display for a frame id
+    void markPresented(uint32_t frameId, int64_t presentNs);
+    // Fallback: every submitted frame with a timeline value up to completedValue is done
+    void markCompleted(uint64_t completedValue, int64_t nowNs);
+
+    // Distributions since the last call, clears the collected samples
+    Report takeReport();
+
+private:
+    struct FrameRecord {
+        uint32_t frameId = 0;
+        bool open = false;
+        bool submitted = false;
+        int64_t cpuStartNs = 0;
+        int64_t inputNs = 0;
+        int64_t submitNs = 0;
+        uint64_t timelineValue = 0;
+    };
+
+    PresentSource presentSource = PresentSource::GpuComplete;
+    uint32_t nextFrameId = 1;
+    std::array<FrameRecord, MAX_OPEN_FRAMES> records{};
+
+    std::vector<float> cpuToPresentMs;
+    std::vector<float> inputToPresentMs;
+    std::vector<float> cpuToSubmitMs;
+    uint64_t queuedFramesSum = 0;
+    uint32_t queuedFramesMax = 0;
+    uint64_t submittedFrames = 0;
+    uint64_t presentedFrames = 0;
+    uint64_t lostFrames = 0;
+
+    FrameRecord *findRecord(uint32_t frameId);
+    void closeRecord(FrameRecord &record, int64_t presentNs);
+    static void addSample(std::vector<float> &samples, int64_t durationNs);
+    static Distribution computeDistribution(std::vector<float> &samples);
+};
@@ -0,0 +1,90 @@
+/*
+ * Matrix Utilities Implementation
+ */
+
+#include "MatrixUtils.hpp"
+#include <cmath>
+#include <cstring>
+
+void createIdentityMatrix(float* matrix) {
+    memset(matrix, 0, 16 * sizeof(float));
+    matrix[0] = matrix[5] = matrix[10] = matrix[15] = 1.0f;
+}
+
+void createPerspectiveMatrix(float* matrix, float fov, float aspect, float near, float far) {
+    memset(matrix, 0, 16 * sizeof(float));
+    float tanHalfFov = tanf(fov / 2.0f);
+    
+    matrix[0] = 1.0f / (aspect * tanHalfFov);
+    matrix[5] = 1.0f / tanHalfFov;
+    matrix[10] = -(far + near) / (far - near);
+    matrix[11] = -1.0f;
+    matrix[14] = -(2.0f * far * near) / (far - near);
+}
+
+void createLookAtMatrix(float* matrix, float eyeX, float eyeY, float eyeZ,
+                                  float centerX, float centerY, float centerZ,
+                                  float upX, float upY, float upZ) {
+    float fx = centerX - eyeX;
+    float fy = centerY - eyeY;
+    float fz = centerZ - eyeZ;
+
+    float fLen = sqrtf(fx * fx + fy * fy + fz * fz);
+    fx /= fLen; fy /= fLen; fz /= fLen;
+
+    float sx = fy * upZ - fz * upY;
+    float sy = fz * upX - fx * upZ;
+    float sz = fx * upY - fy * upX;
+
+    float sLen = sqrtf(sx * sx + sy * sy + sz * sz);
+    sx /= sLen; sy /= sLen; sz /= sLen;
+
+    float ux = sy * fz - sz * fy;
+    float uy = sz * fx - sx * fz;
+    float uz = sx * fy - sy * fx;
+
+    matrix[0] = sx;  matrix[4] = sy;  matrix[8]  = sz;  matrix[12] = -(sx * eyeX + sy * eyeY + sz * eyeZ);
+    matrix[1] = ux;  matrix[5] = uy;  matrix[9]  = uz;  matrix[13] = -(ux * eyeX + uy * eyeY + uz * eyeZ);
+    matrix[2] = -fx; matrix[6] = -fy; matrix[10] = -fz; matrix[14] = (fx * eyeX + fy * eyeY + fz * eyeZ);
+    matrix[3] = 0.0f; matrix[7] = 0.0f; matrix[11] = 0.0f; matrix[15] = 1.0f;
+}
+
+void createRotationMatrix(float* matrix, float angle, float x, float y, float z) {
+    float rad = angle * 3.14159265f / 180.0f;
+    float c = cosf(rad);
+    float s = sinf(rad);
+    float len = sqrtf(x * x + y * y + z * z);
+    x /= len; y /= len; z /= len;
+
+    matrix[0] = x * x * (1 - c) + c;
+    matrix[1] = y * x * (1 - c) + z * s;
+    matrix[2] = x * z * (1 - c) - y * s;
+    matrix[3] = 0.0f;
+
+    matrix[4] = x * y * (1 - c) - z * s;
+    matrix[5] = y * y * (1 - c) + c;
+    matrix[6] = y * z * (1 - c) + x * s;
+    matrix[7] = 0.0f;
+
+    matrix[8] = x * z * (1 - c) + y * s;
+    matrix[9] = y * z * (1 - c) - x * s;
+    matrix[10] = z * z * (1 - c) + c;
+    matrix[11] = 0.0f;
+
+    matrix[12] = 0.0f;
+    matrix[13] = 0.0f;
+    matrix[14] = 0.0f;
+    matrix[15] = 1.0f;
+}
+
+void multiplyMatrix(float* result, const float* a, const float* b) {
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += a[k * 4 + row] * b[column * 4 + k];
+            }
+            result[column * 4 + row] = sum;
+        }
+    }
+}
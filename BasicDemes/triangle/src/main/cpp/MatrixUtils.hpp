@@ -0,0 +1,16 @@
+/*
+ * Matrix Utilities
+ * Column-major 4x4 matrix helpers shared by the samples
+ */
+
+#pragma once
+
+// All matrices are float[16] in column-major order, as consumed by GLSL mat4
+void createIdentityMatrix(float* matrix);
+void createPerspectiveMatrix(float* matrix, float fov, float aspect, float near, float far);
+void createLookAtMatrix(float* matrix, float eyeX, float eyeY, float eyeZ,
+                        float centerX, float centerY, float centerZ,
+                        float upX, float upY, float upZ);
+void createRotationMatrix(float* matrix, float angle, float x, float y, float z);
+// result = a * b; result must not alias a or b
+void multiplyMatrix(float* result, const float* a, const float* b);
@@ -0,0 +1,111 @@
+/*
+ * Memory Tracker Implementation
+ */
+
+#include "MemoryTracker.hpp"
+#include <algorithm>
+
+uint64_t MemoryTracker::HeapStats::estimatedUsage() const {
+    int64_t usage = static_cast<int64_t>(driverUsage) + usageSinceQuery;
+    return static_cast<uint64_t>(std::max<int64_t>(usage, 0));
+}
+
+void MemoryTracker::setHeapCount(uint32_t count) {
+    snapshot.heapCount = std::min(count, MAX_HEAPS);
+}
+
+void MemoryTracker::setHeapInfo(uint32_t heapIndex, uint64_t size, bool deviceLocal) {
+    if (heapIndex >= MAX_HEAPS) {
+        return;
+    }
+    HeapStats &heap = snapshot.heaps[heapIndex];
+    heap.size = size;
+    heap.deviceLocal = deviceLocal;
+    if (heap.budget == 0) {
+        heap.budget = size;
+    }
+}
+
+void MemoryTracker::setHeapBudget(uint32_t heapIndex, uint64_t budget, uint64_t usage) {
+    if (heapIndex >= MAX_HEAPS) {
+        return;
+    }
+    HeapStats &heap = snapshot.heaps[heapIndex];
+    if (budget > 0) {
+        heap.budget = budget;
+        heap.driverUsage = usage;
+        heap.usageSinceQuery = 0;
+        snapshot.driverBudget = true;
+    }
+}
+
+void MemoryTracker::recordAllocation(MemoryCategory category, uint32_t heapIndex, uint64_t size) {
+    CategoryStats &stats = snapshot.categories[static_cast<size_t>(category)];
+    stats.bytes += size;
+    stats.highWater = std::max(stats.highWater, stats.bytes);
+    stats.allocations++;
+
+    snapshot.totalBytes += size;
+    snapshot.totalHighWater = std::max(snapshot.totalHighWater, snapshot.totalBytes);
+
+    if (heapIndex < MAX_HEAPS) {
+        HeapStats &heap = snapshot.heaps[heapIndex];
+        heap.engineBytes += size;
+        heap.engineHighWater = std::max(heap.engineHighWater, heap.engineBytes);
+        heap.usageSinceQuery += static_cast<int64_t>(size);
+    }
+}
+
+void MemoryTracker::recordFree(MemoryCategory category, uint32_t heapIndex, uint64_t size) {
+    CategoryStats &stats = snapshot.categories[static_cast<size_t>(category)];
+    stats.bytes -= std::min(stats.bytes, size);
+    if (stats.allocations > 0) {
+        stats.allocations--;
+    }
+    snapshot.totalBytes -= std::min(snapshot.totalBytes, size);
+
+    if (heapIndex < MAX_HEAPS) {
+        HeapStats &heap = snapshot.heaps[heapIndex];
+        heap.engineBytes -= std::min(heap.engineBytes, size);
+        heap.usageSinceQuery -= static_cast<int64_t>(size);
+    }
+}
+
+uint32_t MemoryTracker::checkBudgets() {
+    uint32_t newWarnings = 0;
+    for (uint32_t i = 0; i < snapshot.heapCount; i++) {
+        const HeapStats &heap = snapshot.heaps[i];
+        if (heap.budget == 0) {
+            continue;
+        }
+        // Without driver numbers only the engine's own allocations are known
+        uint64_t usage = snapshot.driverBudget ? heap.estimatedUsage() : heap.engineBytes;
+        bool overThreshold = static_cast<double>(usage) >
+                             static_cast<double>(heap.budget) * warningThreshold;
+        uint32_t bit = 1u << i;
+        if (overThreshold && (warnedHeaps & bit) == 0) {
+            warnedHeaps |= bit;
+            newWarnings |= bit;
+        } else if (!overThreshold) {
+            warnedHeaps &= ~bit;
+        }
+    }
+    return newWarnings;
+}
+
+const char *MemoryTracker::categoryName(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Buffer:
+            return "buffers";
+        case MemoryCategory::Image:
+            return "images";
+        case MemoryCategory::Staging:
+            return "staging";
+        case MemoryCategory::Uniform:
+            return "uniforms";
+        case MemoryCategory::Readback:
+            return "readback";
+        default:
+            return "unknown";
+    }
+}
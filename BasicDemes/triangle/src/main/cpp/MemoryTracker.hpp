@@ -0,0 +1,88 @@
+/*
+ * Memory Tracker
+ * Per category device memory accounting and per heap budget checks
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// What a device memory allocation is used for
+enum class MemoryCategory : uint32_t {
+    Buffer,   // Vertex, index and other static buffers
+    Image,    // Attachments and textures
+    Staging,  // Host visible upload buffers
+    Uniform,  // Per frame uniform buffers
+    Readback, // Host visible buffers frames are copied into
+    Count
+};
+
+/**
+ * @brief Accounts the engine's device memory allocations against the heap budgets
+ *
+ * Allocations are counted per category and per heap, with high-water marks. Heap
+ * budget and usage come from the driver (VK_EXT_memory_budget) when it can report
+ * them; between two driver queries the engine's own allocations and frees are added
+ * to the last reported usage. Without driver numbers the heap size is the budget
+ * and the engine's allocations are the usage.
+ *
+ * A heap warns once when its usage crosses the warning threshold and is re-armed
+ * after it falls below the threshold again, so a heap that hovers around the
+ * limit does not warn every frame.
+ */
+class MemoryTracker {
+public:
+    static constexpr uint32_t MAX_HEAPS = 16;  // VK_MAX_MEMORY_HEAPS
+    static constexpr size_t CATEGORY_COUNT = static_cast<size_t>(MemoryCategory::Count);
+
+    struct CategoryStats {
+        uint64_t bytes = 0;
+        uint64_t highWater = 0;
+        uint32_t allocations = 0;
+    };
+
+    struct HeapStats {
+        uint64_t size = 0;
+        uint64_t budget = 0;          // Driver budget, or the heap size without one
+        uint64_t driverUsage = 0;     // Process usage at the last driver query
+        int64_t usageSinceQuery = 0;  // Engine allocations minus frees since that query
+        uint64_t engineBytes = 0;     // Engine allocations in this heap
+        uint64_t engineHighWater = 0;
+        bool deviceLocal = false;
+
+        uint64_t estimatedUsage() const;
+    };
+
+    struct Snapshot {
+        std::array<CategoryStats, CATEGORY_COUNT> categories{};
+        std::array<HeapStats, MAX_HEAPS> heaps{};
+        uint32_t heapCount = 0;
+        uint64_t totalBytes = 0;
+        uint64_t totalHighWater = 0;
+        bool driverBudget = false;    // Budgets come from VK_EXT_memory_budget
+    };
+
+    // Fraction of a heap's budget at which the heap warns
+    float warningThreshold = 0.85f;
+
+    void setHeapCount(uint32_t count);
+    void setHeapInfo(uint32_t heapIndex, uint64_t size, bool deviceLocal);
+    // Driver numbers for a heap; budget 0 means no driver budget is available
+    void setHeapBudget(uint32_t heapIndex, uint64_t budget, uint64_t usage);
+
+    void recordAllocation(MemoryCategory category, uint32_t heapIndex, uint64_t size);
+    void recordFree(MemoryCategory category, uint32_t heapIndex, uint64_t size);
+
+    // Heaps over the warning threshold that have not warned yet (bit per heap index)
+    uint32_t checkBudgets();
+
+    const Snapshot &getSnapshot() const { return snapshot; }
+
+    static const char *categoryName(MemoryCategory category);
+
+private:
+    Snapshot snapshot;
+    uint32_t warnedHeaps = 0;
+};
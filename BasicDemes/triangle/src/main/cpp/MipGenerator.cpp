@@ -0,0 +1,356 @@
+/*
+ * Mip Generator Implementation
+ */
+
+#include "MipGenerator.hpp"
+#include <algorithm>
+
+namespace {
+
+VkImageMemoryBarrier levelBarrier(VkImage image, uint32_t firstLevel, uint32_t levelCount,
+                                  VkImageLayout oldLayout, VkImageLayout newLayout,
+                                  VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstAccessMask = dstAccessMask;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, firstLevel, levelCount, 0, 1};
+    return barrier;
+}
+
+void pipelineBarrier(VkCommandBuffer cmd, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask,
+                     const VkImageMemoryBarrier *barriers, uint32_t barrierCount) {
+    vkCmdPipelineBarrier(cmd, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, barrierCount, barriers);
+}
+
+int32_t levelSize(uint32_t size, uint32_t level) {
+    return static_cast<int32_t>(std::max(size >> level, 1u));
+}
+
+// Formats the shader can average: fetched and stored as normalized or float values
+bool isFilterableInShader(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_R16_SFLOAT:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+void MipGenerator::setup(VkDevice device, VkPhysicalDevice physicalDevice, bool storageWriteWithoutFormat) {
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->storageWriteWithoutFormat = storageWriteWithoutFormat;
+}
+
+VkResult MipGenerator::createComputePipeline(VkShaderModule shaderModule, VkPipelineCache pipelineCache) {
+    // Point sampling, the shader fetches texels directly
+    VkSamplerCreateInfo samplerCI{};
+    samplerCI.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCI.magFilter = VK_FILTER_NEAREST;
+    samplerCI.minFilter = VK_FILTER_NEAREST;
+    samplerCI.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerCI.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCI.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCI.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCI.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    VkResult result = vkCreateSampler(device, &samplerCI, nullptr, &sampler);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[0].pImmutableSamplers = &sampler;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCI{};
+    setLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCI.bindingCount = 2;
+    setLayoutCI.pBindings = bindings;
+    result = vkCreateDescriptorSetLayout(device, &setLayoutCI, nullptr, &descriptorSetLayout);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCI{};
+    pipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCI.setLayoutCount = 1;
+    pipelineLayoutCI.pSetLayouts = &descriptorSetLayout;
+    result = vkCreatePipelineLayout(device, &pipelineLayoutCI, nullptr, &pipelineLayout);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkComputePipelineCreateInfo pipelineCI{};
+    pipelineCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCI.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineCI.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineCI.stage.module = shaderModule;
+    pipelineCI.stage.pName = "main";
+    pipelineCI.layout = pipelineLayout;
+    return vkCreateComputePipelines(device, pipelineCache, 1, &pipelineCI, nullptr, &pipeline);
+}
+
+void MipGenerator::destroy() {
+    if (pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    }
+    if (descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+    }
+    if (sampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, sampler, nullptr);
+    }
+    pipeline = VK_NULL_HANDLE;
+    pipelineLayout = VK_NULL_HANDLE;
+    descriptorSetLayout = VK_NULL_HANDLE;
+    sampler = VK_NULL_HANDLE;
+}
+
+MipGenerator::Method MipGenerator::selectMethod(VkFormat format) const {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+    const VkFormatFeatureFlags features = properties.optimalTilingFeatures;
+
+    const VkFormatFeatureFlags blit = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    const VkFormatFeatureFlags compute = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+    const bool blitSupported = (features & blit) == blit;
+    // sRGB formats are rarely storage formats, and averaging them would need a conversion
+    const bool computeSupported = isFilterableInShader(format) && storageWriteWithoutFormat &&
+                                  (features & compute) == compute;
+
+    if (computeSupported && (preferCompute || !blitSupported)) {
+        return Method::Compute;
+    }
+    return blitSupported ? Method::Blit : Method::None;
+}
+
+const char *MipGenerator::getMethodName(Method method) {
+    switch (method) {
+        case Method::Blit:
+            return "blit";
+        case Method::Compute:
+            return "compute";
+        default:
+            return "none";
+    }
+}
+
+VkImageUsageFlags MipGenerator::getRequiredUsage(Method method) {
+    switch (method) {
+        case Method::Blit:
+            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        case Method::Compute:
+            return VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+        default:
+            return 0;
+    }
+}
+
+uint32_t MipGenerator::getFullLevelCount(uint32_t width, uint32_t height) {
+    uint32_t levelCount = 1;
+    while ((std::max(width, height) >> levelCount) > 0) {
+        levelCount++;
+    }
+    return levelCount;
+}
+
+void MipGenerator::recordBlit(VkCommandBuffer cmd, const Image &image, VkImageLayout finalLayout,
+                              VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) const {
+    const uint32_t lastLevel = image.levelCount - 1;
+
+    // Level 0 becomes the first blit source, the rest blit destinations
+    VkImageMemoryBarrier barriers[2];
+    barriers[0] = levelBarrier(image.image, 0, 1, image.baseLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               image.baseAccessMask, VK_ACCESS_TRANSFER_READ_BIT);
+    uint32_t barrierCount = 1;
+    if (lastLevel > 0) {
+        barriers[barrierCount++] = levelBarrier(image.image, 1, lastLevel, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                                                VK_ACCESS_TRANSFER_WRITE_BIT);
+    }
+    pipelineBarrier(cmd, image.baseStageMask | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    barriers, barrierCount);
+
+    for (uint32_t level = 1; level <= lastLevel; level++) {
+        VkImageBlit blit{};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+        blit.srcOffsets[1] = {levelSize(image.width, level - 1), levelSize(image.height, level - 1), 1};
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        blit.dstOffsets[1] = {levelSize(image.width, level), levelSize(image.height, level), 1};
+        vkCmdBlitImage(cmd, image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        // The level just written is the next source
+        if (level < lastLevel) {
+            barriers[0] = levelBarrier(image.image, level, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                       VK_ACCESS_TRANSFER_READ_BIT);
+            pipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barriers, 1);
+        }
+    }
+
+    // Sources are read, the last level written
+    barrierCount = 0;
+    if (lastLevel > 0) {
+        barriers[barrierCount++] = levelBarrier(image.image, 0, lastLevel, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                finalLayout, 0, dstAccessMask);
+    }
+    barriers[barrierCount++] = levelBarrier(image.image, lastLevel, 1,
+                                            lastLevel > 0 ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                                          : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                            finalLayout, lastLevel > 0 ? VK_ACCESS_TRANSFER_WRITE_BIT : 0,
+                                            dstAccessMask);
+    pipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, barriers, barrierCount);
+}
+
+VkResult MipGenerator::recordCompute(VkCommandBuffer cmd, const Image &image, VkImageLayout finalLayout,
+                                     VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+                                     Transient &transient) const {
+    const uint32_t lastLevel = image.levelCount - 1;
+
+    // A view per level, and a set per generated level reading the one above it
+    transient.views.assign(image.levelCount, VK_NULL_HANDLE);
+    for (uint32_t level = 0; level <= lastLevel; level++) {
+        VkImageViewCreateInfo viewCI{};
+        viewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewCI.image = image.image;
+        viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewCI.format = image.format;
+        viewCI.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+        VkResult result = vkCreateImageView(device, &viewCI, nullptr, &transient.views[level]);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+    }
+
+    std::vector<VkDescriptorSet> sets(lastLevel);
+    if (lastLevel > 0) {
+        VkDescriptorPoolSize poolSizes[2] = {
+                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, lastLevel},
+                {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          lastLevel}
+        };
+        VkDescriptorPoolCreateInfo poolCI{};
+        poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolCI.maxSets = lastLevel;
+        poolCI.poolSizeCount = 2;
+        poolCI.pPoolSizes = poolSizes;
+        VkResult result = vkCreateDescriptorPool(device, &poolCI, nullptr, &transient.descriptorPool);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        std::vector<VkDescriptorSetLayout> setLayouts(lastLevel, descriptorSetLayout);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = transient.descriptorPool;
+        allocInfo.descriptorSetCount = lastLevel;
+        allocInfo.pSetLayouts = setLayouts.data();
+        result = vkAllocateDescriptorSets(device, &allocInfo, sets.data());
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        std::vector<VkDescriptorImageInfo> imageInfos(lastLevel * 2);
+        std::vector<VkWriteDescriptorSet> writes(lastLevel * 2);
+        for (uint32_t level = 1; level <= lastLevel; level++) {
+            VkDescriptorImageInfo *info = &imageInfos[(level - 1) * 2];
+            info[0] = {VK_NULL_HANDLE, transient.views[level - 1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+            info[1] = {VK_NULL_HANDLE, transient.views[level], VK_IMAGE_LAYOUT_GENERAL};
+            for (uint32_t binding = 0; binding < 2; binding++) {
+                VkWriteDescriptorSet &write = writes[(level - 1) * 2 + binding];
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = sets[level - 1];
+                write.dstBinding = binding;
+                write.descriptorCount = 1;
+                write.descriptorType = binding == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+                                                    : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                write.pImageInfo = &info[binding];
+            }
+        }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    // Level 0 is read by the first dispatch, the rest are written in GENERAL
+    VkImageMemoryBarrier barriers[2];
+    barriers[0] = levelBarrier(image.image, 0, 1, image.baseLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               image.baseAccessMask, VK_ACCESS_SHADER_READ_BIT);
+    uint32_t barrierCount = 1;
+    if (lastLevel > 0) {
+        barriers[barrierCount++] = levelBarrier(image.image, 1, lastLevel, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
+    }
+    pipelineBarrier(cmd, image.baseStageMask | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, barriers, barrierCount);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    for (uint32_t level = 1; level <= lastLevel; level++) {
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &sets[level - 1],
+                                0, nullptr);
+        vkCmdDispatch(cmd, (static_cast<uint32_t>(levelSize(image.width, level)) + 7) / 8,
+                      (static_cast<uint32_t>(levelSize(image.height, level)) + 7) / 8, 1);
+
+        // The level just written is the next source
+        if (level < lastLevel) {
+            barriers[0] = levelBarrier(image.image, level, 1, VK_IMAGE_LAYOUT_GENERAL,
+                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT,
+                                       VK_ACCESS_SHADER_READ_BIT);
+            pipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            barriers, 1);
+        }
+    }
+
+    // Sources are read, the last level written
+    barrierCount = 0;
+    if (lastLevel > 0) {
+        barriers[barrierCount++] = levelBarrier(image.image, 0, lastLevel, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                finalLayout, 0, dstAccessMask);
+    }
+    barriers[barrierCount++] = levelBarrier(image.image, lastLevel, 1,
+                                            lastLevel > 0 ? VK_IMAGE_LAYOUT_GENERAL
+                                                          : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                            finalLayout, lastLevel > 0 ? VK_ACCESS_SHADER_WRITE_BIT : 0,
+                                            dstAccessMask);
+    pipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStageMask, barriers, barrierCount);
+    return VK_SUCCESS;
+}
+
+void MipGenerator::destroyTransient(const Transient &transient) const {
+    if (transient.descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, transient.descriptorPool, nullptr);
+    }
+    for (VkImageView view: transient.views) {
+        if (view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, view, nullptr);
+        }
+    }
+}
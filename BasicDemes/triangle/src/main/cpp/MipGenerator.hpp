@@ -0,0 +1,85 @@
+/*
+ * Mip Generator
+ * Records the commands that fill an image's mip chain from its base level
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief GPU mip chain generation by blits, or a compute shader where blits can't filter
+ *
+ * The blit path downsamples level by level with linear vkCmdBlitImage, which needs
+ * the format to support blitting and linear filtering. Formats without linear
+ * filtering (32-bit float formats on most mobile GPUs) take the compute path
+ * instead: a box filter per level that only needs point sampling and storage image
+ * writes, with the shaderStorageImageWriteWithoutFormat feature so one shader
+ * serves every UNORM and float format, RGBA8 included. setPreferCompute() selects
+ * it for every format it supports. Both paths issue one pipeline barrier per level,
+ * covering all image transitions of that step.
+ *
+ * Level 0 must hold the source image; the other levels are overwritten. When the
+ * recorded commands have run, every level is in the requested final layout.
+ */
+class MipGenerator {
+public:
+    enum class Method : uint8_t {
+        None,
+        Blit,
+        Compute
+    };
+
+    // Image to generate mips for, and the state its level 0 was left in
+    struct Image {
+        VkImage image = VK_NULL_HANDLE;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t levelCount = 1;
+        VkImageLayout baseLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        VkPipelineStageFlags baseStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        VkAccessFlags baseAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    };
+
+    // Resources of a compute generation, destroyed once its commands have completed
+    struct Transient {
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        std::vector<VkImageView> views;
+    };
+
+    void setup(VkDevice device, VkPhysicalDevice physicalDevice, bool storageWriteWithoutFormat);
+    // Use the compute path wherever it works, not only where blits can't filter
+    void setPreferCompute(bool prefer) { preferCompute = prefer; }
+    // Compute path pipeline from mipmap.comp; the module can be destroyed afterwards
+    VkResult createComputePipeline(VkShaderModule shaderModule, VkPipelineCache pipelineCache);
+    bool hasComputePipeline() const { return pipeline != VK_NULL_HANDLE; }
+    void destroy();
+
+    // How mips of the format can be generated; Compute may still need createComputePipeline()
+    Method selectMethod(VkFormat format) const;
+    static const char *getMethodName(Method method);
+    // Usage flags the image needs for the method, on top of its own
+    static VkImageUsageFlags getRequiredUsage(Method method);
+    static uint32_t getFullLevelCount(uint32_t width, uint32_t height);
+
+    void recordBlit(VkCommandBuffer cmd, const Image &image, VkImageLayout finalLayout,
+                    VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) const;
+    VkResult recordCompute(VkCommandBuffer cmd, const Image &image, VkImageLayout finalLayout,
+                           VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+                           Transient &transient) const;
+    void destroyTransient(const Transient &transient) const;
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    bool storageWriteWithoutFormat = false;
+    bool preferCompute = false;
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+};
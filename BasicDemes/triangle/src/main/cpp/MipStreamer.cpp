@@ -0,0 +1,32 @@
+/*
+ * Mip Streamer Implementation
+ */
+
+#include "MipStreamer.hpp"
+
+void MipStreamer::start(const std::vector<uint64_t> &levelSizes) {
+    this->levelSizes = levelSizes;
+    residentLevel = static_cast<uint32_t>(levelSizes.size());
+    pendingValue = 0;
+}
+
+bool MipStreamer::nextBatch(uint64_t budget, uint64_t completedValue, uint32_t &firstLevel,
+                            uint32_t &levelCount) const {
+    if (residentLevel == 0 || pendingValue > completedValue) {
+        return false;
+    }
+    uint32_t level = residentLevel - 1;
+    uint64_t bytes = levelSizes[level];
+    while (level > 0 && bytes + levelSizes[level - 1] <= budget) {
+        level--;
+        bytes += levelSizes[level];
+    }
+    firstLevel = level;
+    levelCount = residentLevel - level;
+    return true;
+}
+
+void MipStreamer::submitted(uint32_t firstLevel, uint64_t timelineValue) {
+    residentLevel = firstLevel;
+    pendingValue = timelineValue;
+}
@@ -0,0 +1,45 @@
+/*
+ * Mip Streamer
+ * Orders the mip level uploads of a texture from the smallest level up
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Schedules mip level uploads of one texture in batches
+ *
+ * The smallest levels go first, so a texture is usable right after its first small
+ * batch and sharpens as larger levels arrive. A batch takes levels from the coarse
+ * end until the byte budget is used up, but always at least one level, so a level
+ * larger than the budget still gets uploaded. The next batch is only handed out once
+ * the previous one has completed on the GPU, so streaming runs at the rate the
+ * transfers actually finish instead of queueing up behind them.
+ *
+ * The resident level (the finest level uploaded) drops as soon as a batch is
+ * submitted: frame submissions wait for pending uploads on the GPU, so every frame
+ * recorded after the upload sees its data. Shaders clamp their LOD to it.
+ */
+class MipStreamer {
+public:
+    // Bytes of each level, level 0 being the largest
+    void start(const std::vector<uint64_t> &levelSizes);
+
+    // Next levels to upload, [firstLevel, firstLevel + levelCount). False when every
+    // level is uploaded or the previous batch has not completed yet.
+    bool nextBatch(uint64_t budget, uint64_t completedValue, uint32_t &firstLevel, uint32_t &levelCount) const;
+    // The batch from nextBatch() was submitted, completing at timelineValue
+    void submitted(uint32_t firstLevel, uint64_t timelineValue);
+
+    uint32_t getResidentLevel() const { return residentLevel; }
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(levelSizes.size()); }
+    bool complete() const { return residentLevel == 0; }
+
+private:
+    std::vector<uint64_t> levelSizes;
+    // Levels >= residentLevel are uploaded; levelCount while nothing is
+    uint32_t residentLevel = 0;
+    uint64_t pendingValue = 0;
+};
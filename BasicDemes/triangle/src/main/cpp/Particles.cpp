@@ -0,0 +1,604 @@
+/*
+ * GPU Particle Example Implementation
+ */
+
+#include "Particles.hpp"
+#include <sys/system_properties.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+Particles::Particles() : VulkanExampleBase() {
+    title = "Vulkan Particles";
+    defaultClearColor = {{ 0.01f, 0.01f, 0.02f, 1.0f }};
+    // Sorted blending needs no MSAA, and fill rate is what this sample stresses
+    requestedSampleCount = VK_SAMPLE_COUNT_1_BIT;
+    preloadShaderFiles = {"shaders/particles_simulate.comp.spv", "shaders/particles_sort.comp.spv",
+                          "shaders/particles.vert.spv", "shaders/particles.frag.spv"};
+
+    particleCount = readParticleCount();
+    sortCount = SORT_LOCAL_SIZE;
+    while (sortCount < particleCount) {
+        sortCount <<= 1;
+    }
+}
+
+Particles::~Particles() {
+    if (device != VK_NULL_HANDLE) {
+        // Retired resources are destroyed by the base class once the device is idle
+        retirePipeline(simulatePipeline);
+        retirePipeline(sortPipeline);
+        retirePipeline(drawPipeline);
+        for (VkPipelineLayout layout: {simulatePipelineLayout, sortPipelineLayout, drawPipelineLayout}) {
+            if (layout != VK_NULL_HANDLE) {
+                retireResource([device = device, layout]() {
+                    vkDestroyPipelineLayout(device, layout, nullptr);
+                });
+            }
+        }
+        for (VkDescriptorSetLayout layout: {simulateSetLayout, sortSetLayout, drawSetLayout}) {
+            if (layout != VK_NULL_HANDLE) {
+                retireResource([device = device, layout]() {
+                    vkDestroyDescriptorSetLayout(device, layout, nullptr);
+                });
+            }
+        }
+        if (descriptorPool != VK_NULL_HANDLE) {
+            retireResource([device = device, pool = descriptorPool]() {
+                vkDestroyDescriptorPool(device, pool, nullptr);
+            });
+        }
+        for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+            retireBuffer(particleBuffers[i].handle, particleBuffers[i].memory);
+            retireBuffer(sortBuffers[i].handle, sortBuffers[i].memory);
+        }
+    }
+}
+
+uint32_t Particles::readParticleCount() {
+    char value[PROP_VALUE_MAX] = {};
+    if (__system_property_get("debug.vulkan.particles", value) <= 0) {
+        return DEFAULT_PARTICLE_COUNT;
+    }
+    long count = strtol(value, nullptr, 10);
+    return static_cast<uint32_t>(std::clamp<long>(count, MIN_PARTICLE_COUNT, MAX_PARTICLE_COUNT));
+}
+
+void Particles::prepare() {
+    VulkanExampleBase::prepare();
+
+    // The simulation dispatches sortCount / WORKGROUP_SIZE groups, which must stay within
+    // the device's group count limit (65535 is all that is guaranteed)
+    const uint64_t maxSortCount = static_cast<uint64_t>(
+            deviceProperties.limits.maxComputeWorkGroupCount[0]) * WORKGROUP_SIZE;
+    if (sortCount > maxSortCount) {
+        while (sortCount > maxSortCount) {
+            sortCount >>= 1;
+        }
+        LOGW("Particles: %u exceed the compute group count limit, using %u", particleCount, sortCount);
+        particleCount = sortCount;
+    }
+
+    createStorageBuffers();
+    createDescriptors();
+    createComputePipelines();
+    createDrawPipeline();
+
+    startTime = std::chrono::steady_clock::now();
+    lastFrameTime = startTime;
+    LOGI("Particles preparation complete");
+}
+
+void Particles::colorFormatChanged() {
+    // Only the draw pipeline writes the color attachment
+    retirePipeline(drawPipeline);
+    retireResource([device = device, layout = drawPipelineLayout]() {
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    });
+    createDrawPipeline();
+}
+
+void Particles::createStorageBuffers() {
+    // Particle state is read by compute and graphics at the same time (the other slot's
+    // buffer), so with two queue families it is shared concurrently
+    const uint32_t families[2] = {queueFamilyIndex, computeQueueFamilyIndex};
+    const bool concurrent = queueFamilyIndex != computeQueueFamilyIndex;
+
+    auto createBuffer = [this](StorageBuffer& buffer, VkDeviceSize size, VkBufferUsageFlags usage,
+                               const uint32_t* sharedFamilies, bool shared) {
+        VkBufferCreateInfo bufferCI{};
+        bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCI.size = size;
+        bufferCI.usage = usage;
+        if (shared) {
+            bufferCI.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferCI.queueFamilyIndexCount = 2;
+            bufferCI.pQueueFamilyIndices = sharedFamilies;
+        } else {
+            bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
+        VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCI, nullptr, &buffer.handle));
+
+        VkMemoryRequirements memReqs;
+        vkGetBufferMemoryRequirements(device, buffer.handle, &memReqs);
+        VkMemoryAllocateInfo memAlloc{};
+        memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memAlloc.allocationSize = memReqs.size;
+        memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits,
+                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Buffer, &buffer.memory));
+        VK_CHECK_RESULT(vkBindBufferMemory(device, buffer.handle, buffer.memory, 0));
+        buffer.size = size;
+    };
+
+    for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+        createBuffer(particleBuffers[i], sizeof(Particle) * particleCount,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     families, concurrent);
+        debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, particleBuffers[i].handle,
+                                 "particles %u", i);
+        // Sort keys are written by compute and read by graphics, handed over explicitly
+        createBuffer(sortBuffers[i], sizeof(SortKey) * sortCount,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, families, false);
+        debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, sortBuffers[i].handle,
+                                 "particle sort keys %u", i);
+    }
+
+    // Zero life makes the first simulation step spawn every particle
+    VkCommandBuffer fillCmd;
+    VkCommandBufferAllocateInfo cmdBufAllocInfo{};
+    cmdBufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufAllocInfo.commandPool = commandPool;
+    cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufAllocInfo.commandBufferCount = 1;
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &cmdBufAllocInfo, &fillCmd));
+
+    VkCommandBufferBeginInfo cmdBufBeginInfo{};
+    cmdBufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(fillCmd, &cmdBufBeginInfo));
+    for (const auto& buffer: particleBuffers) {
+        vkCmdFillBuffer(fillCmd, buffer.handle, 0, VK_WHOLE_SIZE, 0);
+    }
+    // Without async compute the simulation follows on this queue
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(fillCmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    VK_CHECK_RESULT(vkEndCommandBuffer(fillCmd));
+
+    // The first compute submission waits for this on the timeline
+    uint64_t uploadValue = submitUpload(fillCmd);
+    retireResource(uploadValue, [device = device, pool = commandPool, fillCmd]() {
+        vkFreeCommandBuffers(device, pool, 1, &fillCmd);
+    });
+
+    LOGI("Particles: %u (sorted as %u), %.1f MB of storage buffers", particleCount, sortCount,
+         static_cast<double>(MAX_CONCURRENT_FRAMES * (sizeof(Particle) * particleCount +
+                                                      sizeof(SortKey) * sortCount)) / (1024.0 * 1024.0));
+}
+
+void Particles::createDescriptors() {
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = MAX_CONCURRENT_FRAMES * (3 + 1 + 2);
+
+    VkDescriptorPoolCreateInfo poolCI{};
+    poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCI.poolSizeCount = 1;
+    poolCI.pPoolSizes = &poolSize;
+    poolCI.maxSets = MAX_CONCURRENT_FRAMES * 3;
+    VK_CHECK_RESULT(vkCreateDescriptorPool(device, &poolCI, nullptr, &descriptorPool));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_POOL, descriptorPool, "particle descriptor pool");
+
+    auto createSetLayout = [this](uint32_t bindingCount, VkShaderStageFlags stages,
+                                  VkDescriptorSetLayout* layout) {
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+        for (uint32_t i = 0; i < bindingCount; i++) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = stages;
+        }
+        VkDescriptorSetLayoutCreateInfo layoutCI{};
+        layoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutCI.bindingCount = bindingCount;
+        layoutCI.pBindings = bindings.data();
+        VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &layoutCI, nullptr, layout));
+    };
+    // Simulation: previous state, new state, sort keys. Sort: keys. Draw: state, keys.
+    createSetLayout(3, VK_SHADER_STAGE_COMPUTE_BIT, &simulateSetLayout);
+    createSetLayout(1, VK_SHADER_STAGE_COMPUTE_BIT, &sortSetLayout);
+    createSetLayout(2, VK_SHADER_STAGE_VERTEX_BIT, &drawSetLayout);
+
+    auto allocateSet = [this](VkDescriptorSetLayout layout, VkDescriptorSet* set,
+                              std::initializer_list<VkBuffer> buffers) {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+        VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocInfo, set));
+
+        std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+        std::array<VkWriteDescriptorSet, 3> writes{};
+        uint32_t binding = 0;
+        for (VkBuffer buffer: buffers) {
+            bufferInfos[binding] = {buffer, 0, VK_WHOLE_SIZE};
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = *set;
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorCount = 1;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[binding].pBufferInfo = &bufferInfos[binding];
+            binding++;
+        }
+        vkUpdateDescriptorSets(device, binding, writes.data(), 0, nullptr);
+    };
+
+    for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+        uint32_t previous = (i + MAX_CONCURRENT_FRAMES - 1) % MAX_CONCURRENT_FRAMES;
+        allocateSet(simulateSetLayout, &simulateSets[i],
+                    {particleBuffers[previous].handle, particleBuffers[i].handle, sortBuffers[i].handle});
+        allocateSet(sortSetLayout, &sortSets[i], {sortBuffers[i].handle});
+        allocateSet(drawSetLayout, &drawSets[i], {particleBuffers[i].handle, sortBuffers[i].handle});
+    }
+
+    LOGI("Descriptors created");
+}
+
+void Particles::createComputePipelines() {
+    auto createPipeline = [this](VkDescriptorSetLayout setLayout, uint32_t pushConstantSize,
+                                 const char* shader, const char* name,
+                                 VkPipelineLayout* layout, VkPipeline* pipeline) {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.size = pushConstantSize;
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCI{};
+        pipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCI.setLayoutCount = 1;
+        pipelineLayoutCI.pSetLayouts = &setLayout;
+        pipelineLayoutCI.pushConstantRangeCount = 1;
+        pipelineLayoutCI.pPushConstantRanges = &pushConstantRange;
+        VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCI, nullptr, layout));
+
+        VkComputePipelineCreateInfo pipelineCI{};
+        pipelineCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCI.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCI.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCI.stage.module = loadShader(shader);
+        pipelineCI.stage.pName = "main";
+        pipelineCI.layout = *layout;
+        VK_CHECK_RESULT(vkCreateComputePipelines(device, pipelineCache, 1, &pipelineCI, nullptr,
+                                                 pipeline));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE, *pipeline, "%s", name);
+        vkDestroyShaderModule(device, pipelineCI.stage.module, nullptr);
+    };
+
+    createPipeline(simulateSetLayout, sizeof(SimulatePushConstants),
+                   "shaders/particles_simulate.comp.spv", "particle simulation",
+                   &simulatePipelineLayout, &simulatePipeline);
+    createPipeline(sortSetLayout, sizeof(SortPushConstants),
+                   "shaders/particles_sort.comp.spv", "particle sort",
+                   &sortPipelineLayout, &sortPipeline);
+
+    LOGI("Compute pipelines created");
+}
+
+void Particles::createDrawPipeline() {
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.size = sizeof(DrawPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCI{};
+    pipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCI.setLayoutCount = 1;
+    pipelineLayoutCI.pSetLayouts = &drawSetLayout;
+    pipelineLayoutCI.pushConstantRangeCount = 1;
+    pipelineLayoutCI.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCI, nullptr, &drawPipelineLayout));
+
+    VkShaderModule vertShaderModule = loadShader("shaders/particles.vert.spv");
+    VkShaderModule fragShaderModule = loadShader("shaders/particles.frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertShaderModule;
+    shaderStages[0].pName = "main";
+
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = fragShaderModule;
+    shaderStages[1].pName = "main";
+
+    // No vertex buffers, quads are generated from the vertex and instance index
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCI{};
+    vertexInputStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCI{};
+    inputAssemblyStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssemblyStateCI.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+
+    VkPipelineViewportStateCreateInfo viewportStateCI{};
+    viewportStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportStateCI.viewportCount = 1;
+    viewportStateCI.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizationStateCI{};
+    rasterizationStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizationStateCI.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizationStateCI.cullMode = VK_CULL_MODE_NONE;
+    rasterizationStateCI.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizationStateCI.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampleStateCI{};
+    multisampleStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampleStateCI.rasterizationSamples = sampleCount;
+
+    // Instances arrive back to front, so no depth test is needed
+    VkPipelineDepthStencilStateCreateInfo depthStencilStateCI{};
+    depthStencilStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencilStateCI.depthTestEnable = VK_FALSE;
+    depthStencilStateCI.depthWriteEnable = VK_FALSE;
+    depthStencilStateCI.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+
+    // Straight alpha blending
+    VkPipelineColorBlendAttachmentState blendAttachmentState{};
+    blendAttachmentState.colorWriteMask = 0xF;
+    blendAttachmentState.blendEnable = VK_TRUE;
+    blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+    blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlendStateCI{};
+    colorBlendStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendStateCI.attachmentCount = 1;
+    colorBlendStateCI.pAttachments = &blendAttachmentState;
+
+    std::array<VkDynamicState, 2> dynamicStates = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicStateCI{};
+    dynamicStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicStateCI.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicStateCI.pDynamicStates = dynamicStates.data();
+
+    VkGraphicsPipelineCreateInfo pipelineCI{};
+    pipelineCI.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineCI.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineCI.pStages = shaderStages.data();
+    pipelineCI.pVertexInputState = &vertexInputStateCI;
+    pipelineCI.pInputAssemblyState = &inputAssemblyStateCI;
+    pipelineCI.pViewportState = &viewportStateCI;
+    pipelineCI.pRasterizationState = &rasterizationStateCI;
+    pipelineCI.pMultisampleState = &multisampleStateCI;
+    pipelineCI.pDepthStencilState = &depthStencilStateCI;
+    pipelineCI.pColorBlendState = &colorBlendStateCI;
+    pipelineCI.pDynamicState = &dynamicStateCI;
+    pipelineCI.layout = drawPipelineLayout;
+
+    VkPipelineRenderingCreateInfoKHR pipelineRenderingCI{};
+    setupPipelineRenderingInfo(pipelineCI, pipelineRenderingCI);
+
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCI, nullptr,
+                                              &drawPipeline));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE, drawPipeline, "particle draw");
+
+    vkDestroyShaderModule(device, vertShaderModule, nullptr);
+    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+
+    LOGI("Draw pipeline created");
+}
+
+void Particles::handleInput(int64_t& inputTimeNs) {
+    // Dragging the primary pointer horizontally orbits the camera, 0.25 degrees per pixel
+    InputEvent event;
+    while (inputQueue.pop(event)) {
+        if (event.type != InputEvent::Type::Touch || event.pointerId != 0) {
+            continue;
+        }
+        if (event.action == AMOTION_EVENT_ACTION_DOWN) {
+            touching = true;
+            touchX = event.x;
+        } else if (event.action == AMOTION_EVENT_ACTION_MOVE && touching) {
+            cameraAngle += (event.x - touchX) * 0.25f;
+            touchX = event.x;
+        } else if (event.action == AMOTION_EVENT_ACTION_UP || event.action == AMOTION_EVENT_ACTION_CANCEL) {
+            touching = false;
+        }
+        if (inputTimeNs == 0) {
+            inputTimeNs = event.firstEventTimeNs;
+        }
+    }
+}
+
+void Particles::recordSimulation(VkCommandBuffer cmdBuffer,
+                                 const SimulatePushConstants& pushConstants) {
+    // The previous frame's simulation wrote the state read here
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, simulatePipeline);
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, simulatePipelineLayout,
+                            0, 1, &simulateSets[currentFrame], 0, nullptr);
+    vkCmdPushConstants(cmdBuffer, simulatePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(pushConstants), &pushConstants);
+    // Padding keys up to sortCount are written too
+    vkCmdDispatch(cmdBuffer, sortCount / WORKGROUP_SIZE, 1, 1);
+
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void Particles::recordSort(VkCommandBuffer cmdBuffer) {
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, sortPipeline);
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, sortPipelineLayout,
+                            0, 1, &sortSets[currentFrame], 0, nullptr);
+
+    // Blocks of SORT_LOCAL_SIZE keys are sorted in shared memory first. Each larger merge
+    // runs its far apart compare steps globally, then finishes the block local steps in
+    // shared memory: log2(n / 512) * (log2(n / 512) + 3) / 2 + 1 dispatches in total.
+    const uint32_t localGroups = sortCount / SORT_LOCAL_SIZE;
+    const uint32_t globalGroups = sortCount / 2 / WORKGROUP_SIZE;
+    recordSortDispatch(cmdBuffer, 0, 0, 0, localGroups);
+    for (uint32_t k = 2 * SORT_LOCAL_SIZE; k <= sortCount; k <<= 1) {
+        for (uint32_t j = k / 2; j >= SORT_LOCAL_SIZE; j >>= 1) {
+            recordSortDispatch(cmdBuffer, k, j, 2, globalGroups);
+        }
+        recordSortDispatch(cmdBuffer, k, 0, 1, localGroups);
+    }
+}
+
+void Particles::recordSortDispatch(VkCommandBuffer cmdBuffer, uint32_t k, uint32_t j,
+                                   uint32_t mode, uint32_t groupCount) {
+    SortPushConstants pushConstants{k, j, mode};
+    vkCmdPushConstants(cmdBuffer, sortPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(cmdBuffer, groupCount, 1, 1);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+VulkanExampleBase::BufferHandoff Particles::sortKeyHandoff() const {
+    // Previous contents are never read by compute, so keys only travel compute -> graphics
+    BufferHandoff handoff;
+    handoff.buffer = sortBuffers[currentFrame].handle;
+    handoff.srcQueueFamily = computeQueueFamilyIndex;
+    handoff.dstQueueFamily = queueFamilyIndex;
+    handoff.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    handoff.srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    handoff.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    handoff.dstStageMask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    return handoff;
+}
+
+void Particles::render() {
+    prepareFrame();
+
+    auto now = std::chrono::steady_clock::now();
+    float deltaTime = std::min(std::chrono::duration<float>(now - lastFrameTime).count(), 0.1f);
+    float time = std::chrono::duration<float>(now - startTime).count();
+    lastFrameTime = now;
+
+    int64_t inputTimeNs = 0;
+    handleInput(inputTimeNs);
+    if (inputTimeNs != 0) {
+        setFrameInputTime(inputTimeNs);
+    }
+
+    // Camera slowly orbiting the emitter
+    cameraAngle = std::fmod(cameraAngle + deltaTime * 10.0f, 360.0f);
+    float angle = cameraAngle * 3.14159265f / 180.0f;
+    float eye[3] = {std::sin(angle) * 6.0f, 2.5f, std::cos(angle) * 6.0f};
+
+    float view[16];
+    float projection[16];
+    createLookAtMatrix(view, eye[0], eye[1], eye[2], 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f);
+    float aspect = static_cast<float>(width) / static_cast<float>(height);
+    createPerspectiveMatrix(projection, 60.0f * 3.14159265f / 180.0f, aspect, 0.1f, 256.0f);
+    projection[5] *= -1.0f;
+
+    // Camera axes are the rows of the view matrix
+    SimulatePushConstants simulatePushConstants{};
+    simulatePushConstants.cameraPosition[0] = eye[0];
+    simulatePushConstants.cameraPosition[1] = eye[1];
+    simulatePushConstants.cameraPosition[2] = eye[2];
+    simulatePushConstants.cameraForward[0] = -view[2];
+    simulatePushConstants.cameraForward[1] = -view[6];
+    simulatePushConstants.cameraForward[2] = -view[10];
+    simulatePushConstants.deltaTime = deltaTime;
+    simulatePushConstants.time = time;
+    simulatePushConstants.particleCount = particleCount;
+    simulatePushConstants.sortCount = sortCount;
+
+    DrawPushConstants drawPushConstants{};
+    multiplyMatrix(drawPushConstants.viewProjection, projection, view);
+    drawPushConstants.cameraRight[0] = view[0];
+    drawPushConstants.cameraRight[1] = view[4];
+    drawPushConstants.cameraRight[2] = view[8];
+    drawPushConstants.cameraRight[3] = 0.015f;
+    drawPushConstants.cameraUp[0] = view[1];
+    drawPushConstants.cameraUp[1] = view[5];
+    drawPushConstants.cameraUp[2] = view[9];
+
+    // Compute: simulate into this slot's buffers and sort, overlapping the previous
+    // frame's graphics work when running on the async compute queue
+    VkCommandBuffer computeCmd = beginComputeCommands();
+    debugUtils.beginLabel(computeCmd, "particle simulation", 1.0f, 0.4f, 0.2f);
+    recordSimulation(computeCmd, simulatePushConstants);
+    debugUtils.endLabel(computeCmd);
+    debugUtils.beginLabel(computeCmd, "particle sort", 1.0f, 0.8f, 0.2f);
+    recordSort(computeCmd);
+    debugUtils.endLabel(computeCmd);
+    releaseBuffer(computeCmd, sortKeyHandoff());
+    // The first frames also wait for the particle buffers to be cleared
+    submitCompute(computeCmd, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, uploadTimelineValue);
+
+    // Graphics
+    VkCommandBuffer cmdBuffer = commandBuffers[currentFrame];
+    VK_CHECK_RESULT(vkResetCommandBuffer(cmdBuffer, 0));
+
+    VkCommandBufferBeginInfo cmdBufBeginInfo{};
+    cmdBufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &cmdBufBeginInfo));
+    beginGpuFrameTimer(cmdBuffer);
+
+    acquireBuffer(cmdBuffer, sortKeyHandoff());
+    // Particle state is shared concurrently, no ownership transfer; this barrier only
+    // matters when compute runs on the graphics queue
+    BufferHandoff particleHandoff = sortKeyHandoff();
+    particleHandoff.buffer = particleBuffers[currentFrame].handle;
+    particleHandoff.srcQueueFamily = queueFamilyIndex;
+    acquireBuffer(cmdBuffer, particleHandoff);
+
+    std::array<VkClearValue, 2> clearValues{};
+    clearValues[0].color = defaultClearColor;
+    clearValues[1].depthStencil = {1.0f, 0};
+    beginRendering(cmdBuffer, clearValues);
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(renderExtent.width);
+    viewport.height = static_cast<float>(renderExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = renderExtent;
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+    debugUtils.beginLabel(cmdBuffer, "draw particles", 0.4f, 1.0f, 0.4f);
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipeline);
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipelineLayout,
+                            0, 1, &drawSets[currentFrame], 0, nullptr);
+    vkCmdPushConstants(cmdBuffer, drawPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       sizeof(drawPushConstants), &drawPushConstants);
+    // Only the first particleCount sorted keys are real particles
+    vkCmdDraw(cmdBuffer, 4, particleCount, 0, 0);
+    debugUtils.endLabel(cmdBuffer);
+
+    endRendering(cmdBuffer);
+
+    endGpuFrameTimer(cmdBuffer);
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmdBuffer));
+
+    submitFrame();
+}
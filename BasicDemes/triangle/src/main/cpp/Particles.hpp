@@ -0,0 +1,134 @@
+/*
+ * GPU Particle Example
+ * Compute simulated, depth sorted and alpha blended particles
+ */
+
+#pragma once
+
+#include "VulkanBase.hpp"
+#include "MatrixUtils.hpp"
+#include <array>
+#include <chrono>
+
+/**
+ * @brief Throughput stress test for compute to graphics handoff
+ *
+ * Every frame a compute pass advances all particles from the previous frame's state,
+ * writes a view depth key per particle and bitonic sorts the keys back to front. The
+ * graphics pass draws one camera facing quad instance per particle in sorted order,
+ * reading positions straight from the simulation's storage buffer.
+ *
+ * Particle state is double buffered per frame slot, so the compute pass of frame N
+ * (on the async compute queue if available) runs while graphics still draws frame
+ * N-1 from the other buffer. The particle buffers are shared concurrently between
+ * the queue families; the sort keys are exclusive and handed over with a queue family
+ * ownership transfer.
+ *
+ * The particle count is read from the system property debug.vulkan.particles at
+ * startup (default 1M), e.g. adb shell setprop debug.vulkan.particles 4194304
+ */
+class Particles : public VulkanExampleBase {
+public:
+    // Matches the shaders' std430 layouts
+    struct Particle {
+        float position[4];  // xyz position, w remaining life in seconds
+        float velocity[4];
+    };
+
+    struct SortKey {
+        float key;
+        uint32_t index;
+    };
+
+    struct SimulatePushConstants {
+        float cameraPosition[4];
+        float cameraForward[4];
+        float deltaTime;
+        float time;
+        uint32_t particleCount;
+        uint32_t sortCount;
+    };
+
+    struct SortPushConstants {
+        uint32_t k;
+        uint32_t j;
+        uint32_t mode;
+    };
+
+    struct DrawPushConstants {
+        float viewProjection[16];
+        float cameraRight[4];  // w: sprite half size
+        float cameraUp[4];
+    };
+
+    static constexpr uint32_t DEFAULT_PARTICLE_COUNT = 1u << 20;
+    static constexpr uint32_t MIN_PARTICLE_COUNT = 1024;
+    static constexpr uint32_t MAX_PARTICLE_COUNT = 1u << 24;
+    // Keys sorted per workgroup in shared memory, see particles_sort.comp
+    static constexpr uint32_t SORT_LOCAL_SIZE = 512;
+    static constexpr uint32_t WORKGROUP_SIZE = 256;
+
+private:
+    struct StorageBuffer {
+        VkBuffer handle = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+    };
+
+    uint32_t particleCount = DEFAULT_PARTICLE_COUNT;
+    // Particle count rounded up to a power of two for the bitonic sort
+    uint32_t sortCount = 0;
+
+    // Per frame slot: particle state written by that slot's simulation, and its sort keys
+    std::array<StorageBuffer, MAX_CONCURRENT_FRAMES> particleBuffers;
+    std::array<StorageBuffer, MAX_CONCURRENT_FRAMES> sortBuffers;
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSetLayout simulateSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout sortSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout drawSetLayout = VK_NULL_HANDLE;
+    std::array<VkDescriptorSet, MAX_CONCURRENT_FRAMES> simulateSets{};
+    std::array<VkDescriptorSet, MAX_CONCURRENT_FRAMES> sortSets{};
+    std::array<VkDescriptorSet, MAX_CONCURRENT_FRAMES> drawSets{};
+
+    VkPipelineLayout simulatePipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout sortPipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout drawPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline simulatePipeline = VK_NULL_HANDLE;
+    VkPipeline sortPipeline = VK_NULL_HANDLE;
+    VkPipeline drawPipeline = VK_NULL_HANDLE;
+
+    // Camera orbiting the emitter, dragging turns it
+    float cameraAngle = 0.0f;
+    bool touching = false;
+    float touchX = 0.0f;
+    std::chrono::steady_clock::time_point startTime{};
+    std::chrono::steady_clock::time_point lastFrameTime{};
+
+public:
+    Particles();
+    ~Particles() override;
+
+protected:
+    void prepare() override;
+    void render() override;
+    void colorFormatChanged() override;
+
+private:
+    static uint32_t readParticleCount();
+
+    // Setup methods
+    void createStorageBuffers();
+    void createDescriptors();
+    void createComputePipelines();
+    void createDrawPipeline();
+
+    // Command recording
+    void recordSimulation(VkCommandBuffer cmdBuffer, const SimulatePushConstants& pushConstants);
+    void recordSort(VkCommandBuffer cmdBuffer);
+    void recordSortDispatch(VkCommandBuffer cmdBuffer, uint32_t k, uint32_t j, uint32_t mode,
+                            uint32_t groupCount);
+    BufferHandoff sortKeyHandoff() const;
+
+    void handleInput(int64_t& inputTimeNs);
+};
@@ -0,0 +1,118 @@
+/*
+ * Pipeline Variants Implementation
+ */
+
+#include "PipelineVariants.hpp"
+#include <algorithm>
+#include <cstdio>
+
+void SpecializationConstants::setBits(uint32_t constantId, Type type, uint32_t bits) {
+    auto it = std::lower_bound(constants.begin(), constants.end(), constantId,
+                               [](const Constant &constant, uint32_t id) { return constant.id < id; });
+    if (it != constants.end() && it->id == constantId) {
+        it->type = type;
+        it->bits = bits;
+    } else {
+        constants.insert(it, {constantId, type, bits});
+    }
+}
+
+uint64_t SpecializationConstants::key() const {
+    // FNV-1a over the sorted (id, type, value) triples
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint32_t value) {
+        for (uint32_t i = 0; i < 4; i++) {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const Constant &constant: constants) {
+        mix(constant.id);
+        mix(static_cast<uint32_t>(constant.type));
+        mix(constant.bits);
+    }
+    return hash;
+}
+
+bool SpecializationConstants::operator==(const SpecializationConstants &other) const {
+    return constants.size() == other.constants.size() &&
+           std::equal(constants.begin(), constants.end(), other.constants.begin(),
+                      [](const Constant &a, const Constant &b) {
+                          return a.id == b.id && a.type == b.type && a.bits == b.bits;
+                      });
+}
+
+const VkSpecializationInfo *SpecializationConstants::info() const {
+    if (constants.empty()) {
+        return nullptr;
+    }
+    // Every supported type is 4 bytes, so constant i lives at offset 4 * i
+    mapEntries.resize(constants.size());
+    data.resize(constants.size());
+    for (size_t i = 0; i < constants.size(); i++) {
+        mapEntries[i].constantID = constants[i].id;
+        mapEntries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+        mapEntries[i].size = sizeof(uint32_t);
+        data[i] = constants[i].bits;
+    }
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+    specializationInfo.pMapEntries = mapEntries.data();
+    specializationInfo.dataSize = data.size() * sizeof(uint32_t);
+    specializationInfo.pData = data.data();
+    return &specializationInfo;
+}
+
+std::string SpecializationConstants::describe() const {
+    std::string text;
+    char entry[48];
+    for (const Constant &constant: constants) {
+        switch (constant.type) {
+            case Type::Bool:
+                snprintf(entry, sizeof(entry), "%u=%s", constant.id, constant.bits ? "true" : "false");
+                break;
+            case Type::Int:
+                snprintf(entry, sizeof(entry), "%u=%d", constant.id, static_cast<int32_t>(constant.bits));
+                break;
+            case Type::Uint:
+                snprintf(entry, sizeof(entry), "%u=%u", constant.id, constant.bits);
+                break;
+            case Type::Float: {
+                float value;
+                memcpy(&value, &constant.bits, sizeof(value));
+                snprintf(entry, sizeof(entry), "%u=%g", constant.id, value);
+                break;
+            }
+        }
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += entry;
+    }
+    return text;
+}
+
+VkPipeline PipelineVariantCache::get(const SpecializationConstants &constants, const CreateFn &create) {
+    auto it = pipelines.find(constants);
+    if (it != pipelines.end()) {
+        stats.hits++;
+        return it->second;
+    }
+    stats.misses++;
+    VkPipeline pipeline = create(constants);
+    if (pipeline != VK_NULL_HANDLE) {
+        pipelines.emplace(constants, pipeline);
+    }
+    return pipeline;
+}
+
+VkPipeline PipelineVariantCache::find(const SpecializationConstants &constants) const {
+    auto it = pipelines.find(constants);
+    return it != pipelines.end() ? it->second : VK_NULL_HANDLE;
+}
+
+void PipelineVariantCache::clear(const std::function<void(VkPipeline pipeline)> &release) {
+    for (const auto &entry: pipelines) {
+        release(entry.second);
+    }
+    pipelines.clear();
+}
@@ -0,0 +1,122 @@
+/*
+ * Pipeline Variants
+ * Specialization constants and a cache of the pipelines created for each set of them
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Typed specialization constant values for one pipeline variant
+ *
+ * Matches shader declarations like layout (constant_id = 0) const bool INSTANCED.
+ * The driver compiles the pipeline with the values folded in, so branches on them
+ * cost nothing and one SPIR-V file serves every variant. Constants are kept sorted
+ * by ID, which makes key() and equality independent of the order they were set in.
+ * The same info() can be passed to every stage; each stage only picks up the IDs
+ * it declares.
+ */
+class SpecializationConstants {
+public:
+    // bool (stored as VkBool32), int32_t, uint32_t or float
+    template<typename T>
+    SpecializationConstants &set(uint32_t constantId, T value) {
+        static_assert(std::is_same<T, bool>::value || std::is_same<T, int32_t>::value ||
+                      std::is_same<T, uint32_t>::value || std::is_same<T, float>::value,
+                      "specialization constants are bool, int32_t, uint32_t or float");
+        uint32_t bits;
+        Type type;
+        if constexpr (std::is_same<T, bool>::value) {
+            bits = value ? VK_TRUE : VK_FALSE;
+            type = Type::Bool;
+        } else {
+            memcpy(&bits, &value, sizeof(bits));
+            type = std::is_same<T, float>::value ? Type::Float
+                 : std::is_same<T, int32_t>::value ? Type::Int : Type::Uint;
+        }
+        setBits(constantId, type, bits);
+        return *this;
+    }
+
+    bool empty() const { return constants.empty(); }
+
+    // Variant key: equal for equal constant sets
+    uint64_t key() const;
+    bool operator==(const SpecializationConstants &other) const;
+    bool operator!=(const SpecializationConstants &other) const { return !(*this == other); }
+
+    // nullptr without constants; valid until the constants change or are destroyed
+    const VkSpecializationInfo *info() const;
+
+    // "id=value" list for logs and object names
+    std::string describe() const;
+
+    struct Hash {
+        size_t operator()(const SpecializationConstants &constants) const {
+            return static_cast<size_t>(constants.key());
+        }
+    };
+
+private:
+    enum class Type : uint8_t {
+        Bool,
+        Int,
+        Uint,
+        Float
+    };
+
+    struct Constant {
+        uint32_t id;
+        Type type;
+        uint32_t bits;
+    };
+
+    std::vector<Constant> constants;
+
+    // Built by info()
+    mutable std::vector<VkSpecializationMapEntry> mapEntries;
+    mutable std::vector<uint32_t> data;
+    mutable VkSpecializationInfo specializationInfo{};
+
+    void setBits(uint32_t constantId, Type type, uint32_t bits);
+};
+
+/**
+ * @brief Pipelines of one pipeline description, created on first use per variant
+ *
+ * get() returns the pipeline for a set of constants, calling create the first time
+ * the set is seen. Creation still goes through
+ * the pipeline cache, so a variant seen in an earlier run compiles quickly. Not
+ * thread safe; used by the thread that records commands.
+ */
+class PipelineVariantCache {
+public:
+    using CreateFn = std::function<VkPipeline(const SpecializationConstants &constants)>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;  // Variants created
+    };
+
+    VkPipeline get(const SpecializationConstants &constants, const CreateFn &create);
+    // VK_NULL_HANDLE if the variant has not been created
+    VkPipeline find(const SpecializationConstants &constants) const;
+
+    size_t size() const { return pipelines.size(); }
+    const Stats &getStats() const { return stats; }
+
+    // Hand every pipeline to release (to destroy or retire it) and empty the cache
+    void clear(const std::function<void(VkPipeline pipeline)> &release);
+
+private:
+    std::unordered_map<SpecializationConstants, VkPipeline, SpecializationConstants::Hash> pipelines;
+    Stats stats{};
+};
@@ -0,0 +1,98 @@
+/*
+ * Sampler Cache Implementation
+ */
+
+#include "SamplerCache.hpp"
+#include <cstring>
+
+namespace {
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+}  // namespace
+
+void SamplerCache::setup(VkDevice device) {
+    this->device = device;
+}
+
+uint64_t SamplerCache::hash(const VkSamplerCreateInfo &createInfo) {
+    // FNV-1a over every field but sType and pNext
+    const uint32_t fields[] = {
+        createInfo.flags,
+        static_cast<uint32_t>(createInfo.magFilter),
+        static_cast<uint32_t>(createInfo.minFilter),
+        static_cast<uint32_t>(createInfo.mipmapMode),
+        static_cast<uint32_t>(createInfo.addressModeU),
+        static_cast<uint32_t>(createInfo.addressModeV),
+        static_cast<uint32_t>(createInfo.addressModeW),
+        floatBits(createInfo.mipLodBias),
+        createInfo.anisotropyEnable,
+        floatBits(createInfo.maxAnisotropy),
+        createInfo.compareEnable,
+        static_cast<uint32_t>(createInfo.compareOp),
+        floatBits(createInfo.minLod),
+        floatBits(createInfo.maxLod),
+        static_cast<uint32_t>(createInfo.borderColor),
+        createInfo.unnormalizedCoordinates
+    };
+    uint64_t value = 14695981039346656037ull;
+    for (uint32_t field: fields) {
+        for (uint32_t i = 0; i < 4; i++) {
+            value ^= (field >> (i * 8)) & 0xFF;
+            value *= 1099511628211ull;
+        }
+    }
+    return value;
+}
+
+bool SamplerCache::equal(const VkSamplerCreateInfo &a, const VkSamplerCreateInfo &b) {
+    return a.flags == b.flags && a.magFilter == b.magFilter && a.minFilter == b.minFilter &&
+           a.mipmapMode == b.mipmapMode && a.addressModeU == b.addressModeU &&
+           a.addressModeV == b.addressModeV && a.addressModeW == b.addressModeW &&
+           floatBits(a.mipLodBias) == floatBits(b.mipLodBias) && a.anisotropyEnable == b.anisotropyEnable &&
+           floatBits(a.maxAnisotropy) == floatBits(b.maxAnisotropy) && a.compareEnable == b.compareEnable &&
+           a.compareOp == b.compareOp && floatBits(a.minLod) == floatBits(b.minLod) &&
+           floatBits(a.maxLod) == floatBits(b.maxLod) && a.borderColor == b.borderColor &&
+           a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+VkResult SamplerCache::get(const VkSamplerCreateInfo &createInfo, VkSampler *sampler) {
+    if (createInfo.pNext != nullptr) {
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+    const uint64_t key = hash(createInfo);
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Entry> &entries = samplers[key];
+    for (const Entry &entry: entries) {
+        if (equal(entry.createInfo, createInfo)) {
+            *sampler = entry.sampler;
+            return VK_SUCCESS;
+        }
+    }
+    VkResult result = vkCreateSampler(device, &createInfo, nullptr, sampler);
+    if (result == VK_SUCCESS) {
+        entries.push_back({createInfo, *sampler});
+        count++;
+    }
+    return result;
+}
+
+size_t SamplerCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+void SamplerCache::destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &bucket: samplers) {
+        for (const Entry &entry: bucket.second) {
+            vkDestroySampler(device, entry.sampler, nullptr);
+        }
+    }
+    samplers.clear();
+    count = 0;
+}
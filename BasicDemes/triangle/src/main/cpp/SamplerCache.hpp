@@ -0,0 +1,45 @@
+/*
+ * Sampler Cache
+ * One VkSampler per distinct sampler description
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Deduplicates samplers by their create info
+ *
+ * Most textures share a handful of filter and address mode combinations, so a
+ * sampler per texture wastes objects; drivers also cap them at
+ * maxSamplerAllocationCount, and some have a small hardware sampler heap. get()
+ * hashes the create info and returns the existing sampler for an equal description,
+ * creating it the first time. Samplers live until destroy(), so callers never destroy
+ * what they get. Only create infos without a pNext chain are supported.
+ */
+class SamplerCache {
+public:
+    void setup(VkDevice device);
+    VkResult get(const VkSamplerCreateInfo &createInfo, VkSampler *sampler);
+    size_t size() const;
+    // Destroy every sampler; nothing may use them anymore
+    void destroy();
+
+private:
+    struct Entry {
+        VkSamplerCreateInfo createInfo;
+        VkSampler sampler;
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<Entry>> samplers;
+    size_t count = 0;
+
+    static uint64_t hash(const VkSamplerCreateInfo &createInfo);
+    static bool equal(const VkSamplerCreateInfo &a, const VkSamplerCreateInfo &b);
+};
@@ -0,0 +1,417 @@
+/*
+ * Scene Graph Implementation
+ */
+
+#include "SceneGraph.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Four floats, one matrix column or one element of four nodes, with the operations the
+// update is written in
+#if defined(__SSE2__)
+struct Vec4 {
+    __m128 v;
+
+    Vec4() = default;
+    Vec4(__m128 value) : v(value) {}
+    Vec4(float value) : v(_mm_set1_ps(value)) {}
+    static Vec4 load(const float *values) { return _mm_loadu_ps(values); }
+    void store(float *values) const { _mm_storeu_ps(values, v); }
+    friend Vec4 operator+(Vec4 a, Vec4 b) { return _mm_add_ps(a.v, b.v); }
+    friend Vec4 operator-(Vec4 a, Vec4 b) { return _mm_sub_ps(a.v, b.v); }
+    friend Vec4 operator*(Vec4 a, Vec4 b) { return _mm_mul_ps(a.v, b.v); }
+    // a times lane LANE of b
+    template <int LANE>
+    static Vec4 multiplyLane(Vec4 a, Vec4 b) {
+        return _mm_mul_ps(a.v, _mm_shuffle_ps(b.v, b.v, _MM_SHUFFLE(LANE, LANE, LANE, LANE)));
+    }
+};
+#elif defined(__ARM_NEON)
+struct Vec4 {
+    float32x4_t v;
+
+    Vec4() = default;
+    Vec4(float32x4_t value) : v(value) {}
+    Vec4(float value) : v(vdupq_n_f32(value)) {}
+    static Vec4 load(const float *values) { return vld1q_f32(values); }
+    void store(float *values) const { vst1q_f32(values, v); }
+    friend Vec4 operator+(Vec4 a, Vec4 b) { return vaddq_f32(a.v, b.v); }
+    friend Vec4 operator-(Vec4 a, Vec4 b) { return vsubq_f32(a.v, b.v); }
+    friend Vec4 operator*(Vec4 a, Vec4 b) { return vmulq_f32(a.v, b.v); }
+    template <int LANE>
+    static Vec4 multiplyLane(Vec4 a, Vec4 b) { return vmulq_n_f32(a.v, vgetq_lane_f32(b.v, LANE)); }
+};
+#else
+struct Vec4 {
+    float v[4];
+
+    Vec4() = default;
+    Vec4(float value) : v{value, value, value, value} {}
+    static Vec4 load(const float *values) {
+        Vec4 result;
+        std::copy(values, values + 4, result.v);
+        return result;
+    }
+    void store(float *values) const { std::copy(v, v + 4, values); }
+    friend Vec4 operator+(Vec4 a, Vec4 b) {
+        for (uint32_t i = 0; i < 4; i++) {
+            a.v[i] += b.v[i];
+        }
+        return a;
+    }
+    friend Vec4 operator-(Vec4 a, Vec4 b) {
+        for (uint32_t i = 0; i < 4; i++) {
+            a.v[i] -= b.v[i];
+        }
+        return a;
+    }
+    friend Vec4 operator*(Vec4 a, Vec4 b) {
+        for (uint32_t i = 0; i < 4; i++) {
+            a.v[i] *= b.v[i];
+        }
+        return a;
+    }
+    template <int LANE>
+    static Vec4 multiplyLane(Vec4 a, Vec4 b) { return a * Vec4(b.v[LANE]); }
+};
+#endif
+
+// Local transform components of consecutive nodes
+struct LocalComponents {
+    const float *rotationX, *rotationY, *rotationZ, *rotationW;
+    const float *scaleX, *scaleY, *scaleZ;
+    const float *translationX, *translationY, *translationZ;
+};
+
+// Local affine matrices of the four nodes from offset on, one vector per element: the
+// rotation and scale columns (0-2, 3-5, 6-8), then the translation (9-11)
+inline void computeLocal4(const LocalComponents &local, uint32_t offset, Vec4 (&m)[12]) {
+    const Vec4 x = Vec4::load(local.rotationX + offset);
+    const Vec4 y = Vec4::load(local.rotationY + offset);
+    const Vec4 z = Vec4::load(local.rotationZ + offset);
+    const Vec4 w = Vec4::load(local.rotationW + offset);
+    const Vec4 sx = Vec4::load(local.scaleX + offset);
+    const Vec4 sy = Vec4::load(local.scaleY + offset);
+    const Vec4 sz = Vec4::load(local.scaleZ + offset);
+    const Vec4 one(1.0f);
+    const Vec4 two(2.0f);
+    m[0] = (one - two * (y * y + z * z)) * sx;
+    m[1] = two * (x * y + w * z) * sx;
+    m[2] = two * (x * z - w * y) * sx;
+    m[3] = two * (x * y - w * z) * sy;
+    m[4] = (one - two * (x * x + z * z)) * sy;
+    m[5] = two * (y * z + w * x) * sy;
+    m[6] = two * (x * z + w * y) * sz;
+    m[7] = two * (y * z - w * x) * sz;
+    m[8] = (one - two * (x * x + y * y)) * sz;
+    m[9] = Vec4::load(local.translationX + offset);
+    m[10] = Vec4::load(local.translationY + offset);
+    m[11] = Vec4::load(local.translationZ + offset);
+}
+
+// world = parent * local for the node in lane LANE of m, one column at a time with the
+// parent's bottom row (0, 0, 0, 1) carrying over
+template <int LANE>
+inline void multiplyNode(const Vec4 (&m)[12], const float *parent, float *world) {
+    const Vec4 p0 = Vec4::load(parent);
+    const Vec4 p1 = Vec4::load(parent + 4);
+    const Vec4 p2 = Vec4::load(parent + 8);
+    const Vec4 p3 = Vec4::load(parent + 12);
+    (Vec4::multiplyLane<LANE>(p0, m[0]) + Vec4::multiplyLane<LANE>(p1, m[1]) +
+     Vec4::multiplyLane<LANE>(p2, m[2])).store(world);
+    (Vec4::multiplyLane<LANE>(p0, m[3]) + Vec4::multiplyLane<LANE>(p1, m[4]) +
+     Vec4::multiplyLane<LANE>(p2, m[5])).store(world + 4);
+    (Vec4::multiplyLane<LANE>(p0, m[6]) + Vec4::multiplyLane<LANE>(p1, m[7]) +
+     Vec4::multiplyLane<LANE>(p2, m[8])).store(world + 8);
+    (Vec4::multiplyLane<LANE>(p0, m[9]) + Vec4::multiplyLane<LANE>(p1, m[10]) +
+     Vec4::multiplyLane<LANE>(p2, m[11]) + p3).store(world + 12);
+}
+
+}  // namespace
+
+void SceneGraph::reserve(uint32_t nodeCount) {
+    for (std::vector<uint32_t> *array: {&indices, &handles, &parents, &subtreeEnds}) {
+        array->reserve(nodeCount);
+    }
+    for (std::vector<float> *component: {&translationX, &translationY, &translationZ, &rotationX, &rotationY,
+                                         &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ}) {
+        component->reserve(nodeCount);
+    }
+    worldMatrices.reserve(static_cast<size_t>(nodeCount) * 16);
+    dirtyBits.reserve((nodeCount + 63) / 64);
+}
+
+void SceneGraph::clear() {
+    for (std::vector<uint32_t> *array: {&indices, &handles, &parents, &subtreeEnds}) {
+        array->clear();
+    }
+    for (std::vector<float> *component: {&translationX, &translationY, &translationZ, &rotationX, &rotationY,
+                                         &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ}) {
+        component->clear();
+    }
+    worldMatrices.clear();
+    dirtyBits.clear();
+    firstDirty = 0;
+}
+
+uint32_t SceneGraph::addNode(uint32_t parent) {
+    const uint32_t count = size();
+    const uint32_t node = count;
+    assert(parent == NO_PARENT || parent < node);
+    const uint32_t parentIndex = parent == NO_PARENT ? NO_PARENT : indices[parent];
+    const uint32_t index = parent == NO_PARENT ? count : subtreeEnds[parentIndex];
+
+    // Nodes from index on move up by one, and subtrees reaching past index grow
+    if (index < count) {
+        for (uint32_t &position: indices) {
+            position += position >= index ? 1 : 0;
+        }
+        for (uint32_t &position: parents) {
+            position += position != NO_PARENT && position >= index ? 1 : 0;
+        }
+        for (uint32_t &end: subtreeEnds) {
+            end += end > index ? 1 : 0;
+        }
+    }
+    // Ancestors whose subtree ended right where the node goes now include it
+    for (uint32_t ancestor = parentIndex; ancestor != NO_PARENT; ancestor = parents[ancestor]) {
+        if (subtreeEnds[ancestor] == index) {
+            subtreeEnds[ancestor] = index + 1;
+        }
+    }
+
+    auto insert = [index](auto &array, auto value) {
+        array.insert(array.begin() + index, value);
+    };
+    insert(handles, node);
+    insert(parents, parentIndex);
+    insert(subtreeEnds, index + 1);
+    insert(translationX, 0.0f);
+    insert(translationY, 0.0f);
+    insert(translationZ, 0.0f);
+    insert(rotationX, 0.0f);
+    insert(rotationY, 0.0f);
+    insert(rotationZ, 0.0f);
+    insert(rotationW, 1.0f);
+    insert(scaleX, 1.0f);
+    insert(scaleY, 1.0f);
+    insert(scaleZ, 1.0f);
+    worldMatrices.insert(worldMatrices.begin() + static_cast<size_t>(index) * 16, 16, 0.0f);
+    indices.push_back(index);
+    insertDirtyBit(index);
+    return node;
+}
+
+uint32_t SceneGraph::getParent(uint32_t node) const {
+    const uint32_t parentIndex = parents[indices[node]];
+    return parentIndex == NO_PARENT ? NO_PARENT : handles[parentIndex];
+}
+
+void SceneGraph::markDirty(uint32_t index) {
+    dirtyBits[index / 64] |= 1ull << (index % 64);
+    firstDirty = std::min(firstDirty, index);
+}
+
+void SceneGraph::insertDirtyBit(uint32_t index) {
+    dirtyBits.resize((size() + 63) / 64, 0);
+
+    // Bits from index on move up by one, carrying across words
+    const size_t first = index / 64;
+    for (size_t word = dirtyBits.size() - 1; word > first; word--) {
+        dirtyBits[word] = (dirtyBits[word] << 1) | (dirtyBits[word - 1] >> 63);
+    }
+    const uint64_t below = (1ull << (index % 64)) - 1;
+    dirtyBits[first] = (dirtyBits[first] & below) | ((dirtyBits[first] & ~below) << 1);
+    markDirty(index);
+}
+
+uint32_t SceneGraph::findDirty(uint32_t index) const {
+    const uint32_t count = size();
+    if (index >= count) {
+        return count;
+    }
+    size_t word = index / 64;
+    uint64_t bits = dirtyBits[word] & (~0ull << (index % 64));
+    while (bits == 0) {
+        if (++word == dirtyBits.size()) {
+            return count;
+        }
+        bits = dirtyBits[word];
+    }
+    return static_cast<uint32_t>(word * 64) + static_cast<uint32_t>(__builtin_ctzll(bits));
+}
+
+void SceneGraph::setTranslation(uint32_t node, float x, float y, float z) {
+    const uint32_t index = indices[node];
+    translationX[index] = x;
+    translationY[index] = y;
+    translationZ[index] = z;
+    markDirty(index);
+}
+
+void SceneGraph::setRotation(uint32_t node, float x, float y, float z, float w) {
+    const uint32_t index = indices[node];
+    rotationX[index] = x;
+    rotationY[index] = y;
+    rotationZ[index] = z;
+    rotationW[index] = w;
+    markDirty(index);
+}
+
+void SceneGraph::setRotation(uint32_t node, float angle, const float axis[3]) {
+    const float halfAngle = angle * 3.14159265f / 360.0f;
+    const float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    const float s = sinf(halfAngle) / length;
+    setRotation(node, axis[0] * s, axis[1] * s, axis[2] * s, cosf(halfAngle));
+}
+
+void SceneGraph::setScale(uint32_t node, float x, float y, float z) {
+    const uint32_t index = indices[node];
+    scaleX[index] = x;
+    scaleY[index] = y;
+    scaleZ[index] = z;
+    markDirty(index);
+}
+
+uint32_t SceneGraph::update() {
+    const uint32_t count = size();
+    if (firstDirty >= count) {
+        return 0;
+    }
+
+    // Dirty subtrees in order; dirty nodes inside one are covered by it
+    workRanges.clear();
+    uint32_t updated = 0;
+    for (uint32_t index = findDirty(firstDirty); index < count; index = findDirty(subtreeEnds[index])) {
+        workRanges.push_back({index, subtreeEnds[index]});
+        updated += subtreeEnds[index] - index;
+    }
+    std::fill(dirtyBits.begin() + firstDirty / 64, dirtyBits.end(), 0);
+    firstDirty = count;
+
+    if (jobSystem == nullptr || updated < 2 * grainSize) {
+        for (const Range &range: workRanges) {
+            updateRange(range.begin, range.end);
+        }
+        return updated;
+    }
+
+    // Split large subtrees into independent ranges, then hand out runs of them of
+    // about a grain each
+    splitStack.assign(workRanges.begin(), workRanges.end());
+    workRanges.clear();
+    while (!splitStack.empty()) {
+        Range range = splitStack.back();
+        splitStack.pop_back();
+        splitRange(range);
+    }
+    batchStarts.clear();
+    uint32_t batchSize = grainSize;
+    for (uint32_t i = 0; i < workRanges.size(); i++) {
+        if (batchSize >= grainSize) {
+            batchStarts.push_back(i);
+            batchSize = 0;
+        }
+        batchSize += workRanges[i].end - workRanges[i].begin;
+    }
+    batchStarts.push_back(static_cast<uint32_t>(workRanges.size()));
+
+    jobSystem->parallelFor(static_cast<uint32_t>(batchStarts.size() - 1), 1, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t batch = begin; batch < end; batch++) {
+            for (uint32_t i = batchStarts[batch]; i < batchStarts[batch + 1]; i++) {
+                updateRange(workRanges[i].begin, workRanges[i].end);
+            }
+        }
+    });
+    return updated;
+}
+
+void SceneGraph::splitRange(Range range) {
+    if (range.end - range.begin <= grainSize) {
+        workRanges.push_back(range);
+        return;
+    }
+
+    // The top node now, on this thread; its child subtrees then only depend on it and
+    // not on each other. Small siblings are kept together, large ones split further.
+    updateRange(range.begin, range.begin + 1);
+    uint32_t run = range.begin + 1;
+    for (uint32_t child = run; child < range.end; child = subtreeEnds[child]) {
+        const uint32_t childEnd = subtreeEnds[child];
+        if (childEnd - child > grainSize) {
+            if (run < child) {
+                workRanges.push_back({run, child});
+            }
+            splitStack.push_back({child, childEnd});
+            run = childEnd;
+        } else if (childEnd - run > grainSize) {
+            workRanges.push_back({run, child});
+            run = child;
+        }
+    }
+    if (run < range.end) {
+        workRanges.push_back({run, range.end});
+    }
+}
+
+void SceneGraph::updateRange(uint32_t begin, uint32_t end) {
+    static const float IDENTITY[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                                       0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    const uint32_t *parent = parents.data();
+    float *worlds = worldMatrices.data();
+    // Parents are reloaded for every node rather than kept while unchanged, which
+    // measured slower for the branch: in depth-first order a parent was mostly just
+    // written (first children) or used by the previous node (sibling leaves), so the
+    // loads hit L1. A node may be the parent of the next one in its group of four.
+    auto parentWorld = [&](uint32_t index) {
+        const uint32_t parentIndex = parent[index];
+        return parentIndex == NO_PARENT ? IDENTITY : worlds + static_cast<size_t>(parentIndex) * 16;
+    };
+    auto world = [&](uint32_t index) { return worlds + static_cast<size_t>(index) * 16; };
+
+    const LocalComponents components = {
+            rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data(),
+            scaleX.data(), scaleY.data(), scaleZ.data(),
+            translationX.data(), translationY.data(), translationZ.data()};
+    Vec4 m[12];
+    uint32_t index = begin;
+    for (; index + 4 <= end; index += 4) {
+        computeLocal4(components, index, m);
+        multiplyNode<0>(m, parentWorld(index), world(index));
+        multiplyNode<1>(m, parentWorld(index + 1), world(index + 1));
+        multiplyNode<2>(m, parentWorld(index + 2), world(index + 2));
+        multiplyNode<3>(m, parentWorld(index + 3), world(index + 3));
+    }
+    if (index == end) {
+        return;
+    }
+
+    // The last nodes through a padded copy, computed the same way as the others so a
+    // node's matrix does not depend on where its range ends
+    float padded[10][4] = {};
+    const float *sources[10] = {components.rotationX, components.rotationY, components.rotationZ,
+                                components.rotationW, components.scaleX, components.scaleY, components.scaleZ,
+                                components.translationX, components.translationY, components.translationZ};
+    for (uint32_t c = 0; c < 10; c++) {
+        std::copy(sources[c] + index, sources[c] + end, padded[c]);
+    }
+    const LocalComponents tail = {padded[0], padded[1], padded[2], padded[3], padded[4],
+                                  padded[5], padded[6], padded[7], padded[8], padded[9]};
+    computeLocal4(tail, 0, m);
+    multiplyNode<0>(m, parentWorld(index), world(index));
+    if (index + 1 < end) {
+        multiplyNode<1>(m, parentWorld(index + 1), world(index + 1));
+    }
+    if (index + 2 < end) {
+        multiplyNode<2>(m, parentWorld(index + 2), world(index + 2));
+    }
+}
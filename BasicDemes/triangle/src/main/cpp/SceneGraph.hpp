@@ -0,0 +1,105 @@
+/*
+ * Scene Graph
+ * Node hierarchy with structure-of-arrays transforms and incremental world matrices
+ */
+
+#pragma once
+
+#include "JobSystem.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Transform hierarchy updated only where something changed
+ *
+ * Local transforms (translation, rotation quaternion, scale) are kept in one array
+ * per component, world matrices in one contiguous array of column-major float[16]
+ * that can be copied to the GPU as is. Nodes are stored in depth-first order along
+ * with the end of their subtree, so every subtree is one contiguous range of the
+ * arrays with parents before their children. Callers refer to nodes by the handle
+ * addNode() returned, which stays valid when adding nodes moves others.
+ *
+ * Setting a local transform marks the node dirty. update() finds the dirty nodes
+ * 64 at a time in a bit set and recomputes each dirty subtree as one range in a
+ * single forward pass; clean ranges are skipped whole, whatever their position.
+ * The pass builds local matrices four nodes at a time from the component arrays,
+ * then multiplies each by its parent's columns with SSE2 or NEON (scalar code
+ * otherwise). With a job system, dirty subtrees larger than the grain are split at
+ * child subtree boundaries and run on its workers. Affine matrices only: the
+ * bottom row is always (0, 0, 0, 1).
+ *
+ * Adding a node appends it unless its parent's subtree is followed by other nodes,
+ * in which case those move up by one. Building depth-first only ever appends.
+ */
+class SceneGraph {
+public:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    void reserve(uint32_t nodeCount);
+    void clear();
+    // New node with an identity local transform, placed at the end of its parent's
+    // subtree; returns its handle
+    uint32_t addNode(uint32_t parent = NO_PARENT);
+    uint32_t size() const { return static_cast<uint32_t>(parents.size()); }
+    uint32_t getParent(uint32_t node) const;
+
+    void setTranslation(uint32_t node, float x, float y, float z);
+    // Unit quaternion, w being the real part
+    void setRotation(uint32_t node, float x, float y, float z, float w);
+    // Angle in degrees around the axis, as createRotationMatrix()
+    void setRotation(uint32_t node, float angle, const float axis[3]);
+    void setScale(uint32_t node, float x, float y, float z);
+
+    // Recompute the world matrices of dirty subtrees, returns how many were updated
+    uint32_t update();
+    bool isDirty() const { return firstDirty < size(); }
+
+    // Without a job system, or below two grains of dirty nodes, update() runs on the
+    // calling thread. A grain of 16384 nodes is about 0.1 ms of work, well above the
+    // cost of waking a worker; scenebench compares both paths to retune it.
+    void setJobSystem(JobSystem *jobs) { jobSystem = jobs; }
+    void setGrainSize(uint32_t size) { grainSize = size > 0 ? size : 1; }
+
+    const float *getWorldMatrix(uint32_t node) const { return &worldMatrices[indices[node] * 16]; }
+    // All world matrices in depth-first order; getIndex() gives a node's position
+    const std::vector<float> &getWorldMatrices() const { return worldMatrices; }
+    uint32_t getIndex(uint32_t node) const { return indices[node]; }
+
+private:
+    struct Range {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // By handle: position in the arrays below
+    std::vector<uint32_t> indices;
+
+    // By position: handle, parent position and end of the subtree
+    std::vector<uint32_t> handles;
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> subtreeEnds;
+    std::vector<float> translationX, translationY, translationZ;
+    std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<float> worldMatrices;
+
+    // One bit per position for nodes whose local transform changed
+    std::vector<uint64_t> dirtyBits;
+    uint32_t firstDirty = 0;
+
+    JobSystem *jobSystem = nullptr;
+    uint32_t grainSize = 16384;
+    // Scratch of the parallel update: independent ranges, the first range of each job,
+    // and ranges still to be split
+    std::vector<Range> workRanges;
+    std::vector<uint32_t> batchStarts;
+    std::vector<Range> splitStack;
+
+    void markDirty(uint32_t index);
+    void insertDirtyBit(uint32_t index);
+    // Position of the first dirty node at or after index, size() if there is none
+    uint32_t findDirty(uint32_t index) const;
+    void splitRange(Range range);
+    // Forward pass over [begin, end); the parent of begin must be up to date
+    void updateRange(uint32_t begin, uint32_t end);
+};
@@ -0,0 +1,152 @@
+/*
+ * Fixed timestep simulation thread
+ * Produces immutable state snapshots for the render thread
+ */
+
+#pragma once
+
+#include "TripleBuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Runs a simulation at a fixed timestep on its own thread
+ *
+ * Every step publishes a snapshot holding the previous and current state into a
+ * lock-free triple buffer. The render thread picks up the newest snapshot without
+ * blocking and interpolates between both states, so rendering is smooth at any
+ * frame rate while the simulation cost overlaps with the render thread's waits.
+ *
+ * The thread is its own rather than a job system worker: it sleeps until every step
+ * deadline, which would take a worker away from parallelFor() for the whole run.
+ *
+ * State must be trivially copyable; it is copied into the snapshot every step.
+ */
+template<typename State>
+class FixedStepSimulation {
+public:
+    using Clock = std::chrono::steady_clock;
+    using StepFunction = std::function<void(State &state, double stepSeconds)>;
+
+    struct Snapshot {
+        State previous;
+        State current;
+        Clock::time_point time;  // Deadline of the step that produced current
+        uint64_t step;
+    };
+
+    ~FixedStepSimulation() { stop(); }
+
+    void start(const State &initialState, double stepSeconds, StepFunction stepFunction) {
+        stop();
+        state = initialState;
+        stepDuration = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(stepSeconds));
+        this->stepSeconds = stepSeconds;
+        step = std::move(stepFunction);
+        stepCount = 0;
+
+        // Seed all slots so the consumer never sees an uninitialized snapshot
+        Snapshot &snapshot = snapshots.writeBuffer();
+        snapshot = {state, state, Clock::now(), 0};
+        snapshots.publish();
+        snapshots.update();
+
+        running = true;
+        paused = false;
+        thread = std::thread(&FixedStepSimulation::run, this);
+    }
+
+    void stop() {
+        if (!thread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+
+    // A paused simulation sleeps and resumes without catching up on the lost time
+    void setPaused(bool pause) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            paused = pause;
+        }
+        wake.notify_all();
+    }
+
+    bool isRunning() const { return thread.joinable(); }
+
+    // Render thread: newest snapshot, unchanged if no step completed since the last call
+    const Snapshot &latest() {
+        snapshots.update();
+        return snapshots.readBuffer();
+    }
+
+    // Interpolation factor between snapshot.previous and snapshot.current for a render time;
+    // it runs from 0 at the snapshot's step to 1 when the next step is due, so rendering
+    // trails the simulation by up to one step
+    float interpolationFactor(const Snapshot &snapshot, Clock::time_point now) const {
+        double elapsed = std::chrono::duration<double>(now - snapshot.time).count();
+        return static_cast<float>(std::clamp(elapsed / stepSeconds, 0.0, 1.0));
+    }
+
+private:
+    static constexpr int MAX_CATCH_UP_STEPS = 4;
+
+    State state{};
+    StepFunction step;
+    Clock::duration stepDuration{};
+    double stepSeconds = 1.0 / 60.0;
+    uint64_t stepCount = 0;
+
+    TripleBuffer<Snapshot> snapshots;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running = false;
+    bool paused = false;
+
+    void run() {
+        Clock::time_point next = Clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            if (paused) {
+                wake.wait(lock, [this] { return !running || !paused; });
+                next = Clock::now();
+                continue;
+            }
+            lock.unlock();
+
+            // After a long stall resume from now instead of replaying every missed step
+            Clock::time_point now = Clock::now();
+            if (now - next > stepDuration * MAX_CATCH_UP_STEPS) {
+                next = now;
+            }
+
+            State previous = state;
+            step(state, stepSeconds);
+
+            Snapshot &snapshot = snapshots.writeBuffer();
+            snapshot.previous = previous;
+            snapshot.current = state;
+            snapshot.time = next;
+            snapshot.step = ++stepCount;
+            snapshots.publish();
+            next += stepDuration;
+
+            lock.lock();
+            wake.wait_until(lock, next, [this] { return !running || paused; });
+        }
+    }
+};
@@ -0,0 +1,90 @@
+/*
+ * Startup Scheduler Implementation
+ */
+
+#include "StartupScheduler.hpp"
+#include <cassert>
+
+StartupScheduler::TaskId StartupScheduler::add(const std::string &name, std::function<void()> work,
+                                               std::initializer_list<TaskId> dependencies,
+                                               bool mainThread) {
+    return add(name, std::move(work), std::vector<TaskId>(dependencies), mainThread);
+}
+
+StartupScheduler::TaskId StartupScheduler::add(const std::string &name, std::function<void()> work,
+                                               const std::vector<TaskId> &dependencies,
+                                               bool mainThread) {
+    TaskId id = static_cast<TaskId>(tasks.size());
+    Task task;
+    task.name = name;
+    task.work = std::move(work);
+    task.mainThread = mainThread;
+    for (TaskId dependency: dependencies) {
+        assert(dependency < id && "Dependencies must be added first");
+        tasks[dependency].dependents.push_back(id);
+        task.pendingDependencies++;
+    }
+    tasks.push_back(std::move(task));
+    return id;
+}
+
+std::vector<StartupScheduler::TaskId> StartupScheduler::getTaskIds() const {
+    std::vector<TaskId> ids(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        ids[i] = static_cast<TaskId>(i);
+    }
+    return ids;
+}
+
+void StartupScheduler::run(JobSystem &jobs) {
+    assert(jobs.getThreadIndex() == 0 && "Main thread tasks need the job system's main thread");
+    startTime = Clock::now();
+    timeline.clear();
+    timeline.reserve(tasks.size());
+
+    // Roots are collected before any of them runs and starts counting down dependencies
+    std::vector<TaskId> roots;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i].pendingDependencies == 0) {
+            roots.push_back(static_cast<TaskId>(i));
+        }
+    }
+
+    // Dependents are submitted before the task finishing them, so the counter only
+    // reaches zero after the last task
+    JobCounter finished;
+    for (TaskId root: roots) {
+        submitTask(jobs, root, finished);
+    }
+    jobs.wait(finished);
+
+    totalMs = std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+}
+
+void StartupScheduler::submitTask(JobSystem &jobs, TaskId task, JobCounter &finished) {
+    jobs.submit([this, &jobs, &finished, task]() {
+        Clock::time_point start = Clock::now();
+        tasks[task].work();
+        finishTask(jobs, task, start, Clock::now(), finished);
+    }, &finished, tasks[task].mainThread);
+}
+
+void StartupScheduler::finishTask(JobSystem &jobs, TaskId task, Clock::time_point start,
+                                  Clock::time_point end, JobCounter &finished) {
+    std::vector<TaskId> readyTasks;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        timeline.push_back({tasks[task].name,
+                            std::chrono::duration<double, std::milli>(start - startTime).count(),
+                            std::chrono::duration<double, std::milli>(end - start).count(),
+                            jobs.getThreadIndex()});
+        for (TaskId dependent: tasks[task].dependents) {
+            if (--tasks[dependent].pendingDependencies == 0) {
+                readyTasks.push_back(dependent);
+            }
+        }
+    }
+    for (TaskId ready: readyTasks) {
+        submitTask(jobs, ready, finished);
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Startup Scheduler
+ * Runs startup steps as a dependency graph on the job system and records a timeline
+ */
+
+#pragma once
+
+#include "JobSystem.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Dependency graph of startup tasks with a per task timeline
+ *
+ * Tasks are added with the tasks they depend on and are submitted as jobs as soon
+ * as all of them have finished, running on the job system's workers and the
+ * calling thread. Tasks flagged as main thread tasks only run on the job system's
+ * main thread, which has to be the one calling run(). Every task's start time,
+ * duration and thread are recorded, so cold start can be tracked step by step.
+ *
+ * Dependencies must refer to tasks added earlier, which also rules out cycles.
+ */
+class StartupScheduler {
+public:
+    using TaskId = uint32_t;
+    using Clock = std::chrono::steady_clock;
+
+    struct TimelineEntry {
+        std::string name;
+        double startMs;      // Relative to the start of run()
+        double durationMs;
+        uint32_t thread;     // JobSystem::getThreadIndex(), 0 is the calling thread
+    };
+
+    TaskId add(const std::string &name, std::function<void()> work,
+               std::initializer_list<TaskId> dependencies = {}, bool mainThread = false);
+    TaskId add(const std::string &name, std::function<void()> work,
+               const std::vector<TaskId> &dependencies, bool mainThread = false);
+
+    // Ids of all tasks added so far
+    std::vector<TaskId> getTaskIds() const;
+
+    // Runs all tasks and returns once the last one has finished
+    void run(JobSystem &jobs);
+
+    // Entries in completion order, valid after run()
+    const std::vector<TimelineEntry> &getTimeline() const { return timeline; }
+    double getTotalMs() const { return totalMs; }
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> work;
+        std::vector<TaskId> dependents;
+        uint32_t pendingDependencies = 0;
+        bool mainThread = false;
+    };
+
+    std::vector<Task> tasks;
+    std::vector<TimelineEntry> timeline;
+    double totalMs = 0.0;
+
+    // Run state; the mutex guards the timeline and the pending dependency counts
+    std::mutex mutex;
+    Clock::time_point startTime;
+
+    void submitTask(JobSystem &jobs, TaskId task, JobCounter &finished);
+    void finishTask(JobSystem &jobs, TaskId task, Clock::time_point start, Clock::time_point end,
+                    JobCounter &finished);
+};
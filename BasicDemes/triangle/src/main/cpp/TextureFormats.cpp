@@ -0,0 +1,231 @@
+/*
+ * Texture Formats Implementation
+ */
+
+#include "TextureFormats.hpp"
+#include <algorithm>
+
+TextureFormats::Family TextureFormats::getFamily(VkFormat format) {
+    if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) {
+        return Family::Astc;
+    }
+    if (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK) {
+        return Family::Etc2;
+    }
+    if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK) {
+        return Family::Bc;
+    }
+    if (format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB) {
+        return Family::Uncompressed;
+    }
+    return Family::Unknown;
+}
+
+const char *TextureFormats::getFamilyName(Family family) {
+    switch (family) {
+        case Family::Astc: return "ASTC";
+        case Family::Etc2: return "ETC2";
+        case Family::Bc: return "BC";
+        case Family::Uncompressed: return "uncompressed";
+        default: return "unknown";
+    }
+}
+
+const char *TextureFormats::getFileSuffix(Family family) {
+    switch (family) {
+        case Family::Astc: return ".astc.ktx2";
+        case Family::Etc2: return ".etc2.ktx2";
+        case Family::Bc: return ".bc.ktx2";
+        default: return ".ktx2";
+    }
+}
+
+bool TextureFormats::getBlockInfo(VkFormat format, BlockInfo &info) {
+    switch (getFamily(format)) {
+        case Family::Astc: {
+            // Block sizes in format order, each with a UNORM and an SRGB format
+            static const uint8_t ASTC_BLOCKS[][2] = {
+                {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6},
+                {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}
+            };
+            const uint8_t *block = ASTC_BLOCKS[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+            info = {block[0], block[1], 16};
+            return true;
+        }
+        case Family::Etc2:
+            // 64-bit blocks except RGBA8 and two channel EAC
+            info = {4, 4, 8};
+            if (format == VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK || format == VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK ||
+                format == VK_FORMAT_EAC_R11G11_UNORM_BLOCK || format == VK_FORMAT_EAC_R11G11_SNORM_BLOCK) {
+                info.bytes = 16;
+            }
+            return true;
+        case Family::Bc:
+            // BC1 and BC4 are 64-bit blocks, the rest 128-bit
+            info = {4, 4, 16};
+            if (format <= VK_FORMAT_BC1_RGBA_SRGB_BLOCK || format == VK_FORMAT_BC4_UNORM_BLOCK ||
+                format == VK_FORMAT_BC4_SNORM_BLOCK) {
+                info.bytes = 8;
+            }
+            return true;
+        case Family::Uncompressed:
+            info = {1, 1, 4};
+            return true;
+        default:
+            return false;
+    }
+}
+
+VkDeviceSize TextureFormats::getLevelSize(VkFormat format, uint32_t width, uint32_t height) {
+    BlockInfo info;
+    if (!getBlockInfo(format, info)) {
+        return 0;
+    }
+    VkDeviceSize blocksX = (width + info.width - 1) / info.width;
+    VkDeviceSize blocksY = (height + info.height - 1) / info.height;
+    return blocksX * blocksY * info.bytes;
+}
+
+std::vector<TextureFormats::Family> TextureFormats::getLoadOrder(bool astcSupported, bool bcSupported,
+                                                                 bool etc2Supported) {
+    std::vector<Family> order;
+    if (astcSupported) {
+        order.push_back(Family::Astc);
+    }
+    if (bcSupported) {
+        order.push_back(Family::Bc);
+    }
+    if (etc2Supported) {
+        order.push_back(Family::Etc2);
+    }
+    if (!bcSupported) {
+        order.push_back(Family::Bc);
+    }
+    order.push_back(Family::Uncompressed);
+    return order;
+}
+
+VkFormat TextureFormats::getDecodedFormat(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        default:
+            return VK_FORMAT_UNDEFINED;
+    }
+}
+
+namespace {
+
+void decodeColor565(uint16_t color, uint8_t *rgba) {
+    const uint32_t r = (color >> 11) & 0x1F;
+    const uint32_t g = (color >> 5) & 0x3F;
+    const uint32_t b = color & 0x1F;
+    rgba[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+    rgba[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+    rgba[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+    rgba[3] = 255;
+}
+
+// BC1 color block into a 4x4 RGBA block. The block inside BC3 always uses four colors,
+// standalone BC1 has three colors and transparent black when color0 <= color1.
+void decodeColorBlock(const uint8_t *block, bool alwaysFourColors, uint8_t texels[16][4]) {
+    const uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    const uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    uint8_t palette[4][4];
+    decodeColor565(color0, palette[0]);
+    decodeColor565(color1, palette[1]);
+    if (alwaysFourColors || color0 > color1) {
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c] + 1) / 3);
+            palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+        }
+        palette[2][3] = palette[3][3] = 255;
+    } else {
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 0;
+    }
+    const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+    for (uint32_t i = 0; i < 16; i++) {
+        const uint8_t *color = palette[(indices >> (2 * i)) & 0x3];
+        std::copy(color, color + 4, texels[i]);
+    }
+}
+
+// BC3 alpha block: two endpoints and 3-bit indices
+void decodeAlphaBlock(const uint8_t *block, uint8_t texels[16][4]) {
+    const uint32_t alpha0 = block[0];
+    const uint32_t alpha1 = block[1];
+    uint8_t palette[8];
+    palette[0] = static_cast<uint8_t>(alpha0);
+    palette[1] = static_cast<uint8_t>(alpha1);
+    if (alpha0 > alpha1) {
+        for (uint32_t i = 1; i < 7; i++) {
+            palette[i + 1] = static_cast<uint8_t>(((7 - i) * alpha0 + i * alpha1 + 3) / 7);
+        }
+    } else {
+        for (uint32_t i = 1; i < 5; i++) {
+            palette[i + 1] = static_cast<uint8_t>(((5 - i) * alpha0 + i * alpha1 + 2) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    }
+    for (uint32_t i = 0; i < 16; i++) {
+        texels[i][3] = palette[(indices >> (3 * i)) & 0x7];
+    }
+}
+
+}  // namespace
+
+bool TextureFormats::decode(VkFormat format, const uint8_t *src, size_t srcSize, uint32_t width,
+                            uint32_t height, uint8_t *dst) {
+    if (getDecodedFormat(format) == VK_FORMAT_UNDEFINED || srcSize < getLevelSize(format, width, height)) {
+        return false;
+    }
+    const bool bc3 = format == VK_FORMAT_BC3_UNORM_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK;
+    const bool opaque = format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+    const uint32_t blockBytes = bc3 ? 16 : 8;
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+
+    uint8_t texels[16][4];
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const uint8_t *block = src + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+            if (bc3) {
+                decodeColorBlock(block + 8, true, texels);
+                decodeAlphaBlock(block, texels);
+            } else {
+                decodeColorBlock(block, false, texels);
+                if (opaque) {
+                    for (auto &texel: texels) {
+                        texel[3] = 255;
+                    }
+                }
+            }
+            // Edge blocks of levels smaller than 4 texels are clipped
+            const uint32_t columns = std::min(4u, width - bx * 4);
+            const uint32_t rows = std::min(4u, height - by * 4);
+            for (uint32_t y = 0; y < rows; y++) {
+                uint8_t *row = dst + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4) * 4;
+                for (uint32_t x = 0; x < columns; x++) {
+                    std::copy(texels[y * 4 + x], texels[y * 4 + x] + 4, row + x * 4);
+                }
+            }
+        }
+    }
+    return true;
+}
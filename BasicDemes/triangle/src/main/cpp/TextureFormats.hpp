@@ -0,0 +1,58 @@
+/*
+ * Texture Formats
+ * Block compressed format properties, file preference and CPU decoding
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Describes the texture formats the loader handles
+ *
+ * Textures ship as one KTX2 file per compression family, e.g. rock.astc.ktx2 for
+ * mobile GPUs and rock.bc.ktx2 for desktop GPUs. getLoadOrder() ranks the files to
+ * try from what the device samples natively. If no natively supported file exists,
+ * BC1 and BC3 files are decoded on the CPU to RGBA8. That costs four to eight times
+ * the memory and bandwidth, so it is a fallback only.
+ */
+class TextureFormats {
+public:
+    enum class Family : uint8_t {
+        Astc,
+        Etc2,
+        Bc,
+        Uncompressed,
+        Unknown
+    };
+
+    struct BlockInfo {
+        uint32_t width = 1;   // Texels
+        uint32_t height = 1;
+        uint32_t bytes = 0;   // Bytes per block
+    };
+
+    static Family getFamily(VkFormat format);
+    static const char *getFamilyName(Family family);
+    // File name suffix of a family's variant, including the extension
+    static const char *getFileSuffix(Family family);
+
+    // False for formats the loader does not know
+    static bool getBlockInfo(VkFormat format, BlockInfo &info);
+    // Bytes of one tightly packed image, 0 for unknown formats
+    static VkDeviceSize getLevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+    // Families whose files are tried in this order: natively supported compressed
+    // families first (ASTC, BC, ETC2), then BC for the CPU decoder, then uncompressed
+    static std::vector<Family> getLoadOrder(bool astcSupported, bool bcSupported, bool etc2Supported);
+
+    // Format a CPU decoded texture is uploaded in, VK_FORMAT_UNDEFINED if the format
+    // has no decoder (only BC1 and BC3 have one)
+    static VkFormat getDecodedFormat(VkFormat format);
+    // Decode one level to tightly packed RGBA8; dst holds width * height * 4 bytes
+    static bool decode(VkFormat format, const uint8_t *src, size_t srcSize, uint32_t width,
+                       uint32_t height, uint8_t *dst);
+};
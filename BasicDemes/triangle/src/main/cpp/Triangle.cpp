@@ -4,83 +4,181 @@
  */
 
 #include "Triangle.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 
 Triangle::Triangle() : VulkanExampleBase() {
     title = "Vulkan Triangle";
     defaultClearColor = {{ 0.0f, 0.34f, 0.90f, 1.0f }};
+    requestedSampleCount = VK_SAMPLE_COUNT_4_BIT;
+    // Textures and the per frame matrices by handle where descriptor indexing is supported
+    enableBindless = true;
+    // Read during startup while the device is being created; whether the bindless pair
+    // is used is only known once it exists, the unused pair is dropped after startup
+    preloadShaderFiles = {"shaders/triangle.vert.spv", "shaders/triangle.frag.spv",
+                          "shaders/triangle_bindless.vert.spv", "shaders/triangle_bindless.frag.spv"};
+}
+
+void Triangle::addStartupTasks(StartupScheduler& scheduler) {
+    scheduler.add("build triangle mesh", [this]() { buildMesh(); });
 }
 
 Triangle::~Triangle() {
-    if (device != VK_NULL_HANDLE) {
-        vkDeviceWaitIdle(device);
+    simulation.stop();
 
-        // Destroy pipeline
-        if (pipeline != VK_NULL_HANDLE) {
-            vkDestroyPipeline(device, pipeline, nullptr);
+    if (device != VK_NULL_HANDLE) {
+        // Retired resources are destroyed by the base class once the device is idle
+        pipelineVariants.clear([this](VkPipeline variant) { retirePipeline(variant); });
+        for (VkShaderModule module : {vertShaderModule, fragShaderModule}) {
+            if (module != VK_NULL_HANDLE) {
+                retireResource([device = device, module]() { vkDestroyShaderModule(device, module, nullptr); });
+            }
         }
         if (pipelineLayout != VK_NULL_HANDLE) {
-            vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+            retireResource([device = device, layout = pipelineLayout]() {
+                vkDestroyPipelineLayout(device, layout, nullptr);
+            });
         }
 
-        // Destroy descriptor resources
+        // Descriptor resources
         if (descriptorSetLayout != VK_NULL_HANDLE) {
-            vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+            retireResource([device = device, layout = descriptorSetLayout]() {
+                vkDestroyDescriptorSetLayout(device, layout, nullptr);
+            });
         }
         if (descriptorPool != VK_NULL_HANDLE) {
-            vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+            retireResource([device = device, pool = descriptorPool]() {
+                vkDestroyDescriptorPool(device, pool, nullptr);
+            });
         }
 
-        // Destroy uniform buffers
+        // Uniform, vertex and index buffers
         for (auto& ub : uniformBuffers) {
-            if (ub.handle != VK_NULL_HANDLE) {
-                vkDestroyBuffer(device, ub.handle, nullptr);
+            if (ub.bindlessHandle != BindlessTable::INVALID_HANDLE) {
+                retireResource([&table = bindlessTable, handle = ub.bindlessHandle]() {
+                    table.removeBuffer(handle);
+                });
             }
-            if (ub.memory != VK_NULL_HANDLE) {
-                vkFreeMemory(device, ub.memory, nullptr);
-            }
-        }
-
-        // Destroy vertex/index buffers
-        if (vertexBuffer.handle != VK_NULL_HANDLE) {
-            vkDestroyBuffer(device, vertexBuffer.handle, nullptr);
-        }
-        if (vertexBuffer.memory != VK_NULL_HANDLE) {
-            vkFreeMemory(device, vertexBuffer.memory, nullptr);
+            retireBuffer(ub.handle, ub.memory);
         }
-        if (indexBuffer.handle != VK_NULL_HANDLE) {
-            vkDestroyBuffer(device, indexBuffer.handle, nullptr);
+        retireBuffer(vertexBuffer.handle, vertexBuffer.memory);
+        retireBuffer(indexBuffer.handle, indexBuffer.memory);
+        for (auto& staging : uploadStagingBuffers) {
+            retireBuffer(staging.handle, staging.memory);
         }
-        if (indexBuffer.memory != VK_NULL_HANDLE) {
-            vkFreeMemory(device, indexBuffer.memory, nullptr);
+        retireBuffer(uploadTargetBuffer.handle, uploadTargetBuffer.memory);
+        for (auto& instanceBuffer : instanceBuffers) {
+            retireBuffer(instanceBuffer.handle, instanceBuffer.memory);
         }
+        destroyTexture(texture);
     }
 }
 
 void Triangle::prepare() {
     VulkanExampleBase::prepare();
+    if (frameBenchmark.active()) {
+        configureScenario(frameBenchmark.getConfig().scenario);
+    }
     createVertexBuffer();
+    triangleNode = sceneGraph.addNode();
+    camera.setPerspective(60.0f, 0.1f, 256.0f);
+    culler.setJobSystem(&jobSystem);
+    sceneGraph.setJobSystem(&jobSystem);
+    createInstanceBuffers();
+    if (uploadStressSize > 0) {
+        createUploadStressBuffers();
+    }
     createUniformBuffers();
+    textured = loadTexture("triangle", texture) || createCheckerTexture();
+    if (!textured) {
+        createSolidTexture("white", {255, 255, 255, 255}, texture);
+    }
     createDescriptors();
     createPipeline();
+
+    // Simulate at a fixed 60 Hz independent of the display rate
+    simulation.start({0.0f, 2.5f}, 1.0 / 60.0, [this](SceneState& state, double stepSeconds) {
+        stepScene(state, stepSeconds);
+    });
+    simulation.setPaused(paused);
     LOGI("Triangle preparation complete");
 }
 
 void Triangle::cleanup() {
+    simulation.stop();
     VulkanExampleBase::cleanup();
 }
 
-void Triangle::createVertexBuffer() {
+void Triangle::pauseChanged() {
+    simulation.setPaused(paused);
+}
+
+void Triangle::stepScene(SceneState& state, double stepSeconds) {
+    // Dragging the primary pointer horizontally turns the triangle, 0.25 degrees per pixel
+    InputEvent event;
+    int64_t inputTimeNs = 0;
+    while (inputQueue.pop(event)) {
+        if (event.type != InputEvent::Type::Touch || event.pointerId != 0) {
+            continue;
+        }
+        if (event.action == AMOTION_EVENT_ACTION_DOWN) {
+            state.touching = true;
+            state.touchX = event.x;
+        } else if (event.action == AMOTION_EVENT_ACTION_MOVE && state.touching) {
+            state.rotation += (event.x - state.touchX) * 0.25f;
+            state.touchX = event.x;
+        } else if (event.action == AMOTION_EVENT_ACTION_UP || event.action == AMOTION_EVENT_ACTION_CANCEL) {
+            state.touching = false;
+        }
+        if (inputTimeNs == 0) {
+            inputTimeNs = event.firstEventTimeNs;
+        }
+    }
+    if (inputTimeNs != 0) {
+        state.inputTimeNs = inputTimeNs;
+    }
+
+    // 30 degrees per second
+    state.rotation += static_cast<float>(30.0 * stepSeconds);
+    state.rotation = std::fmod(state.rotation, 360.0f);
+    if (state.rotation < 0.0f) {
+        state.rotation += 360.0f;
+    }
+}
+
+Triangle::SceneState Triangle::interpolateScene(const SceneState& from, const SceneState& to, float alpha) {
+    // Interpolate the rotation along the short way across the 360 degree wrap
+    float delta = to.rotation - from.rotation;
+    if (delta < -180.0f) {
+        delta += 360.0f;
+    } else if (delta > 180.0f) {
+        delta -= 360.0f;
+    }
+
+    SceneState state = to;
+    state.rotation = from.rotation + delta * alpha;
+    state.cameraDistance = from.cameraDistance + (to.cameraDistance - from.cameraDistance) * alpha;
+    return state;
+}
+
+void Triangle::buildMesh() {
     // Define triangle vertices (position and color)
-    std::vector<Vertex> vertices = {
+    meshVertices = {
         {{ 1.0f,  1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}},  // Red
         {{-1.0f,  1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}},  // Green
         {{ 0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}   // Blue
     };
-    uint32_t vertexBufferSize = static_cast<uint32_t>(vertices.size() * sizeof(Vertex));
 
     // Define indices
-    std::vector<uint32_t> indices = {0, 1, 2};
+    meshIndices = {0, 1, 2};
+}
+
+void Triangle::createVertexBuffer() {
+    // Mesh data was built by a startup task
+    const std::vector<Vertex>& vertices = meshVertices;
+    const std::vector<uint32_t>& indices = meshIndices;
+    uint32_t vertexBufferSize = static_cast<uint32_t>(vertices.size() * sizeof(Vertex));
     indexCount = static_cast<uint32_t>(indices.size());
     uint32_t indexBufferSize = indexCount * sizeof(uint32_t);
 
@@ -102,8 +200,9 @@ void Triangle::createVertexBuffer() {
     memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits, 
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-    VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &stagingBuffer.memory));
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Staging, &stagingBuffer.memory));
     VK_CHECK_RESULT(vkBindBufferMemory(device, stagingBuffer.handle, stagingBuffer.memory, 0));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, stagingBuffer.handle, "triangle staging buffer");
 
     // Copy data to staging buffer
     uint8_t* data;
@@ -122,8 +221,9 @@ void Triangle::createVertexBuffer() {
     vkGetBufferMemoryRequirements(device, vertexBuffer.handle, &memReqs);
     memAlloc.allocationSize = memReqs.size;
     memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &vertexBuffer.memory));
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Buffer, &vertexBuffer.memory));
     VK_CHECK_RESULT(vkBindBufferMemory(device, vertexBuffer.handle, vertexBuffer.memory, 0));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, vertexBuffer.handle, "triangle vertex buffer");
 
     // Create device local index buffer
     VkBufferCreateInfo indexBufferCI{};
@@ -135,8 +235,9 @@ void Triangle::createVertexBuffer() {
     vkGetBufferMemoryRequirements(device, indexBuffer.handle, &memReqs);
     memAlloc.allocationSize = memReqs.size;
     memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &indexBuffer.memory));
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Buffer, &indexBuffer.memory));
     VK_CHECK_RESULT(vkBindBufferMemory(device, indexBuffer.handle, indexBuffer.memory, 0));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, indexBuffer.handle, "triangle index buffer");
 
     // Copy from staging buffer to device local buffers
     VkCommandBuffer copyCmd;
@@ -146,10 +247,12 @@ void Triangle::createVertexBuffer() {
     cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     cmdBufAllocInfo.commandBufferCount = 1;
     VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &cmdBufAllocInfo, &copyCmd));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_COMMAND_BUFFER, copyCmd, "triangle upload");
 
     VkCommandBufferBeginInfo cmdBufBeginInfo{};
     cmdBufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     VK_CHECK_RESULT(vkBeginCommandBuffer(copyCmd, &cmdBufBeginInfo));
+    debugUtils.beginLabel(copyCmd, "upload triangle mesh", 0.4f, 1.0f, 0.4f);
 
     VkBufferCopy copyRegion{};
     copyRegion.size = vertexBufferSize;
@@ -158,30 +261,155 @@ void Triangle::createVertexBuffer() {
     copyRegion.size = indexBufferSize;
     copyRegion.srcOffset = vertexBufferSize;
     vkCmdCopyBuffer(copyCmd, stagingBuffer.handle, indexBuffer.handle, 1, &copyRegion);
+    debugUtils.endLabel(copyCmd);
 
     VK_CHECK_RESULT(vkEndCommandBuffer(copyCmd));
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &copyCmd;
+    // Submit on the device timeline; the first frame waits for the copy on the GPU and
+    // the staging resources are released once the copy has completed
+    uint64_t uploadValue = submitUpload(copyCmd);
+    retireResource(uploadValue, [device = device, pool = commandPool, copyCmd]() {
+        vkFreeCommandBuffers(device, pool, 1, &copyCmd);
+    });
+    retireBuffer(stagingBuffer.handle, stagingBuffer.memory, uploadValue);
 
-    VkFenceCreateInfo fenceCI{};
-    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    VkFence fence;
-    VK_CHECK_RESULT(vkCreateFence(device, &fenceCI, nullptr, &fence));
+    LOGI("Vertex buffer created");
+}
 
-    VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, fence));
-    VK_CHECK_RESULT(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
+void Triangle::configureScenario(const std::string& scenario) {
+    // triangle, instanced_<count> or upload_<megabytes>
+    unsigned long value = 0;
+    if (sscanf(scenario.c_str(), "instanced_%lu", &value) == 1 && value > 0) {
+        instanceCount = static_cast<uint32_t>(std::min<unsigned long>(value, 1u << 20));
+        // Square grid filling about the same screen area as the single triangle
+        float columns = std::ceil(std::sqrt(static_cast<float>(instanceCount)));
+        float spacing = 2.4f / columns;
+        pushConstants.grid[0] = columns;
+        pushConstants.grid[1] = spacing;
+        pushConstants.grid[2] = 0.4f * spacing;
+        LOGI("Scenario %s: %u instances", scenario.c_str(), instanceCount);
+    } else if (sscanf(scenario.c_str(), "upload_%lu", &value) == 1 && value > 0) {
+        uploadStressSize = static_cast<VkDeviceSize>(std::min<unsigned long>(value, 256)) * 1024 * 1024;
+        LOGI("Scenario %s: %llu byte upload per frame", scenario.c_str(),
+             static_cast<unsigned long long>(uploadStressSize));
+    } else if (scenario != "triangle") {
+        LOGW("Unknown benchmark scenario %s, rendering the plain triangle", scenario.c_str());
+    }
+}
 
-    vkDestroyFence(device, fence, nullptr);
-    vkFreeCommandBuffers(device, commandPool, 1, &copyCmd);
+void Triangle::createUploadStressBuffers() {
+    VkBufferCreateInfo bufferCI{};
+    bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCI.size = uploadStressSize;
+    bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
-    // Clean up staging buffer
-    vkDestroyBuffer(device, stagingBuffer.handle, nullptr);
-    vkFreeMemory(device, stagingBuffer.memory, nullptr);
+    VkMemoryRequirements memReqs;
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 
-    LOGI("Vertex buffer created");
+    // One staging buffer per frame slot, the CPU fills it while the GPU copies the other
+    for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+        StagingBuffer& staging = uploadStagingBuffers[i];
+        VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCI, nullptr, &staging.handle));
+        vkGetBufferMemoryRequirements(device, staging.handle, &memReqs);
+        memAlloc.allocationSize = memReqs.size;
+        memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Staging, &staging.memory));
+        VK_CHECK_RESULT(vkBindBufferMemory(device, staging.handle, staging.memory, 0));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, staging.handle, "upload stress staging %u", i);
+        VK_CHECK_RESULT(vkMapMemory(device, staging.memory, 0, uploadStressSize, 0, (void**)&staging.mapped));
+    }
+
+    bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCI, nullptr, &uploadTargetBuffer.handle));
+    vkGetBufferMemoryRequirements(device, uploadTargetBuffer.handle, &memReqs);
+    memAlloc.allocationSize = memReqs.size;
+    memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Buffer, &uploadTargetBuffer.memory));
+    VK_CHECK_RESULT(vkBindBufferMemory(device, uploadTargetBuffer.handle, uploadTargetBuffer.memory, 0));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, uploadTargetBuffer.handle, "upload stress target");
+
+    LOGI("Upload stress buffers created");
+}
+
+void Triangle::recordUploadStress(VkCommandBuffer cmdBuffer) {
+    DebugUtils::LabelScope label(debugUtils, cmdBuffer, "upload stress", 1.0f, 0.4f, 0.4f);
+
+    // Write every byte on the CPU like a real streaming upload, then copy on the GPU
+    StagingBuffer& staging = uploadStagingBuffers[currentFrame];
+    memset(staging.mapped, static_cast<int>(currentFrame), static_cast<size_t>(uploadStressSize));
+
+    // The previous frame's copy writes the same target
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.size = uploadStressSize;
+    vkCmdCopyBuffer(cmdBuffer, staging.handle, uploadTargetBuffer.handle, 1, &copyRegion);
+}
+
+void Triangle::createInstanceBuffers() {
+    // Bounds of the grid cells laid out by triangle.vert. The model matrix only rotates
+    // around the origin, which the radius around the triangle's corners covers.
+    const float columns = pushConstants.grid[0];
+    const float spacing = pushConstants.grid[1];
+    const float radius = std::sqrt(2.0f) * pushConstants.grid[2];
+    const uint32_t columnCount = static_cast<uint32_t>(columns);
+    instanceBounds.resize(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; i++) {
+        float cellX = static_cast<float>(i % columnCount) - 0.5f * (columns - 1.0f);
+        float cellY = static_cast<float>(i / columnCount) - 0.5f * (columns - 1.0f);
+        instanceBounds.set(i, cellX * spacing, cellY * spacing, 0.0f, radius);
+    }
+    visibleInstances.reserve(instanceCount);
+
+    VkBufferCreateInfo bufferCI{};
+    bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCI.size = instanceCount * sizeof(uint32_t);
+    bufferCI.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+    VkMemoryRequirements memReqs;
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+
+    // Written by the CPU whenever culling produced a new list, like the uniform buffers
+    for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+        InstanceBuffer& instanceBuffer = instanceBuffers[i];
+        VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCI, nullptr, &instanceBuffer.handle));
+        vkGetBufferMemoryRequirements(device, instanceBuffer.handle, &memReqs);
+        memAlloc.allocationSize = memReqs.size;
+        memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Uniform, &instanceBuffer.memory));
+        VK_CHECK_RESULT(vkBindBufferMemory(device, instanceBuffer.handle, instanceBuffer.memory, 0));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, instanceBuffer.handle, "instance ids %u", i);
+        VK_CHECK_RESULT(vkMapMemory(device, instanceBuffer.memory, 0, bufferCI.size, 0,
+            (void**)&instanceBuffer.mapped));
+    }
+
+    LOGI("Instance buffers created, culling with %s", FrustumCuller::getSimdName());
+}
+
+uint32_t Triangle::cullInstances() {
+    if (culledCameraVersion != camera.getVersion()) {
+        float viewProjection[16];
+        multiplyMatrix(viewProjection, camera.getProjectionMatrix(), camera.getViewMatrix());
+        culler.cull(Frustum::fromMatrix(viewProjection), instanceBounds, visibleInstances);
+        culledCameraVersion = camera.getVersion();
+    }
+
+    // Each frame slot has its own copy of the ids, updated when it is reused
+    InstanceBuffer& instanceBuffer = instanceBuffers[currentFrame];
+    if (instanceBuffer.cameraVersion != culledCameraVersion) {
+        memcpy(instanceBuffer.mapped, visibleInstances.data(), visibleInstances.size() * sizeof(uint32_t));
+        instanceBuffer.cameraVersion = culledCameraVersion;
+    }
+    return static_cast<uint32_t>(visibleInstances.size());
 }
 
 void Triangle::createUniformBuffers() {
@@ -189,6 +417,9 @@ void Triangle::createUniformBuffers() {
     bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferCI.size = sizeof(ShaderData);
     bufferCI.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    if (bindless) {
+        bufferCI.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    }
 
     for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
         VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCI, nullptr, &uniformBuffers[i].handle));
@@ -202,42 +433,68 @@ void Triangle::createUniformBuffers() {
         memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-        VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &uniformBuffers[i].memory));
+        VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Uniform, &uniformBuffers[i].memory));
         VK_CHECK_RESULT(vkBindBufferMemory(device, uniformBuffers[i].handle, uniformBuffers[i].memory, 0));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, uniformBuffers[i].handle,
+                                 "triangle frame %u uniform buffer", i);
         VK_CHECK_RESULT(vkMapMemory(device, uniformBuffers[i].memory, 0, sizeof(ShaderData), 0, 
             (void**)&uniformBuffers[i].mapped));
+        if (bindless) {
+            uniformBuffers[i].bindlessHandle = bindlessTable.addBuffer(uniformBuffers[i].handle, 0,
+                                                                       sizeof(ShaderData));
+        }
     }
 
     LOGI("Uniform buffers created");
 }
 
 void Triangle::createDescriptors() {
+    // Bindless only needs every resource to have a handle; the table's set is bound instead
+    bindlessDraw = bindless && texture.bindlessHandle != BindlessTable::INVALID_HANDLE &&
+                   std::all_of(uniformBuffers.begin(), uniformBuffers.end(), [](const UniformBuffer& ub) {
+                       return ub.bindlessHandle != BindlessTable::INVALID_HANDLE;
+                   });
+    if (bindlessDraw) {
+        pushConstants.textureHandle = texture.bindlessHandle;
+        LOGI("Descriptors: bindless, texture handle %u", texture.bindlessHandle);
+        return;
+    }
+
     // Create descriptor pool
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize.descriptorCount = MAX_CONCURRENT_FRAMES;
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = MAX_CONCURRENT_FRAMES;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[1].descriptorCount = MAX_CONCURRENT_FRAMES;
 
     VkDescriptorPoolCreateInfo poolCI{};
     poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolCI.poolSizeCount = 1;
-    poolCI.pPoolSizes = &poolSize;
+    poolCI.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolCI.pPoolSizes = poolSizes.data();
     poolCI.maxSets = MAX_CONCURRENT_FRAMES;
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(device, &poolCI, nullptr, &descriptorPool));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_POOL, descriptorPool, "triangle descriptor pool");
 
     // Create descriptor set layout
-    VkDescriptorSetLayoutBinding layoutBinding{};
-    layoutBinding.binding = 0;
-    layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    layoutBinding.descriptorCount = 1;
-    layoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    std::array<VkDescriptorSetLayoutBinding, 2> layoutBindings{};
+    layoutBindings[0].binding = 0;
+    layoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    layoutBindings[0].descriptorCount = 1;
+    layoutBindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    layoutBindings[1].binding = 1;
+    layoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBindings[1].descriptorCount = 1;
+    layoutBindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
     VkDescriptorSetLayoutCreateInfo layoutCI{};
     layoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutCI.bindingCount = 1;
-    layoutCI.pBindings = &layoutBinding;
+    layoutCI.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+    layoutCI.pBindings = layoutBindings.data();
 
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &layoutCI, nullptr, &descriptorSetLayout));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, descriptorSetLayout,
+                             "triangle set layout");
 
     // Allocate and update descriptor sets
     for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
@@ -248,57 +505,138 @@ void Triangle::createDescriptors() {
         allocInfo.pSetLayouts = &descriptorSetLayout;
 
         VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocInfo, &uniformBuffers[i].descriptorSet));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, uniformBuffers[i].descriptorSet,
+                                 "triangle frame %u descriptor set", i);
 
         VkDescriptorBufferInfo bufferInfo{};
         bufferInfo.buffer = uniformBuffers[i].handle;
         bufferInfo.offset = 0;
         bufferInfo.range = sizeof(ShaderData);
 
-        VkWriteDescriptorSet writeDS{};
-        writeDS.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDS.dstSet = uniformBuffers[i].descriptorSet;
-        writeDS.dstBinding = 0;
-        writeDS.descriptorCount = 1;
-        writeDS.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        writeDS.pBufferInfo = &bufferInfo;
-
-        vkUpdateDescriptorSets(device, 1, &writeDS, 0, nullptr);
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.sampler = texture.sampler;
+        imageInfo.imageView = texture.view;
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        std::array<VkWriteDescriptorSet, 2> writeDS{};
+        writeDS[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDS[0].dstSet = uniformBuffers[i].descriptorSet;
+        writeDS[0].dstBinding = 0;
+        writeDS[0].descriptorCount = 1;
+        writeDS[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writeDS[0].pBufferInfo = &bufferInfo;
+        writeDS[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDS[1].dstSet = uniformBuffers[i].descriptorSet;
+        writeDS[1].dstBinding = 1;
+        writeDS[1].descriptorCount = 1;
+        writeDS[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeDS[1].pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDS.size()), writeDS.data(), 0, nullptr);
     }
 
     LOGI("Descriptors created");
 }
 
+bool Triangle::createCheckerTexture() {
+    // Light checkerboard that keeps the vertex colors visible; its mips fade to grey
+    // across the instance grid
+    constexpr uint32_t SIZE = 256;
+    constexpr uint32_t CELL = 16;
+    std::vector<uint8_t> pixels(SIZE * SIZE * 4);
+    for (uint32_t y = 0; y < SIZE; y++) {
+        for (uint32_t x = 0; x < SIZE; x++) {
+            const uint8_t value = ((x / CELL + y / CELL) & 1) ? 255 : 160;
+            uint8_t* pixel = &pixels[(y * SIZE + x) * 4];
+            pixel[0] = value;
+            pixel[1] = value;
+            pixel[2] = value;
+            pixel[3] = 255;
+        }
+    }
+    return createTexture("checker", VK_FORMAT_R8G8B8A8_UNORM, SIZE, SIZE, pixels.data(), pixels.size(), texture);
+}
+
 void Triangle::createPipeline() {
     // Create pipeline layout
+    VkDescriptorSetLayout setLayout = bindlessDraw ? bindlessTable.getSetLayout() : descriptorSetLayout;
     VkPipelineLayoutCreateInfo pipelineLayoutCI{};
     pipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutCI.setLayoutCount = 1;
-    pipelineLayoutCI.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutCI.pSetLayouts = &setLayout;
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.size = sizeof(PushConstants);
+    pipelineLayoutCI.pushConstantRangeCount = 1;
+    pipelineLayoutCI.pPushConstantRanges = &pushConstantRange;
 
     VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCI, nullptr, &pipelineLayout));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE_LAYOUT, pipelineLayout, "triangle pipeline layout");
+
+    // Load shaders, kept until destruction so further variants can be created later. The
+    // bindless ones are built from the same sources with BINDLESS defined.
+    if (bindlessDraw) {
+        vertShaderModule = loadShader("shaders/triangle_bindless.vert.spv");
+        fragShaderModule = loadShader("shaders/triangle_bindless.frag.spv");
+    } else {
+        vertShaderModule = loadShader("shaders/triangle.vert.spv");
+        fragShaderModule = loadShader("shaders/triangle.frag.spv");
+    }
+
+    pipeline = getPipeline(getPipelineConstants());
+
+    LOGI("Pipeline created");
+}
+
+SpecializationConstants Triangle::getPipelineConstants() const {
+    // The single triangle compiles without the instance grid math
+    SpecializationConstants constants;
+    constants.set(SPEC_INSTANCED, instanceCount > 1);
+    constants.set(SPEC_TEXTURED, textured);
+    return constants;
+}
+
+void Triangle::colorFormatChanged() {
+    // Every variant targets the old format; layout and shader modules are kept
+    pipelineVariants.clear([this](VkPipeline variant) { retirePipeline(variant); });
+    pipeline = getPipeline(getPipelineConstants());
+    LOGI("Pipelines recreated for the new color format");
+}
+
+VkPipeline Triangle::getPipeline(const SpecializationConstants& constants) {
+    return pipelineVariants.get(constants, [this](const SpecializationConstants& variant) {
+        return createPipelineVariant(variant);
+    });
+}
 
-    // Load shaders
-    VkShaderModule vertShaderModule = loadShader("shaders/triangle.vert.spv");
-    VkShaderModule fragShaderModule = loadShader("shaders/triangle.frag.spv");
+VkPipeline Triangle::createPipelineVariant(const SpecializationConstants& constants) {
+    // Both stages read the same constant IDs
+    const VkSpecializationInfo* specializationInfo = constants.info();
 
     std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
     shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
     shaderStages[0].module = vertShaderModule;
     shaderStages[0].pName = "main";
+    shaderStages[0].pSpecializationInfo = specializationInfo;
 
     shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     shaderStages[1].module = fragShaderModule;
     shaderStages[1].pName = "main";
-
-    // Vertex input
-    VkVertexInputBindingDescription vertexInputBinding{};
-    vertexInputBinding.binding = 0;
-    vertexInputBinding.stride = sizeof(Vertex);
-    vertexInputBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    std::array<VkVertexInputAttributeDescription, 2> vertexInputAttributes{};
+    shaderStages[1].pSpecializationInfo = specializationInfo;
+
+    // Vertex input: mesh vertices and the per instance ids of the visible instances
+    std::array<VkVertexInputBindingDescription, 2> vertexInputBindings{};
+    vertexInputBindings[0].binding = 0;
+    vertexInputBindings[0].stride = sizeof(Vertex);
+    vertexInputBindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    vertexInputBindings[1].binding = 1;
+    vertexInputBindings[1].stride = sizeof(uint32_t);
+    vertexInputBindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    std::array<VkVertexInputAttributeDescription, 3> vertexInputAttributes{};
     // Position
     vertexInputAttributes[0].binding = 0;
     vertexInputAttributes[0].location = 0;
@@ -309,11 +647,16 @@ void Triangle::createPipeline() {
     vertexInputAttributes[1].location = 1;
     vertexInputAttributes[1].format = VK_FORMAT_R32G32B32_SFLOAT;
     vertexInputAttributes[1].offset = offsetof(Vertex, color);
+    // Instance id
+    vertexInputAttributes[2].binding = 1;
+    vertexInputAttributes[2].location = 2;
+    vertexInputAttributes[2].format = VK_FORMAT_R32_UINT;
+    vertexInputAttributes[2].offset = 0;
 
     VkPipelineVertexInputStateCreateInfo vertexInputStateCI{};
     vertexInputStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputStateCI.vertexBindingDescriptionCount = 1;
-    vertexInputStateCI.pVertexBindingDescriptions = &vertexInputBinding;
+    vertexInputStateCI.vertexBindingDescriptionCount = static_cast<uint32_t>(vertexInputBindings.size());
+    vertexInputStateCI.pVertexBindingDescriptions = vertexInputBindings.data();
     vertexInputStateCI.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInputAttributes.size());
     vertexInputStateCI.pVertexAttributeDescriptions = vertexInputAttributes.data();
 
@@ -339,7 +682,7 @@ void Triangle::createPipeline() {
     // Multisampling
     VkPipelineMultisampleStateCreateInfo multisampleStateCI{};
     multisampleStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampleStateCI.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampleStateCI.rasterizationSamples = sampleCount;
 
     // Depth stencil
     VkPipelineDepthStencilStateCreateInfo depthStencilStateCI{};
@@ -385,35 +728,44 @@ void Triangle::createPipeline() {
     pipelineCI.pColorBlendState = &colorBlendStateCI;
     pipelineCI.pDynamicState = &dynamicStateCI;
     pipelineCI.layout = pipelineLayout;
-    pipelineCI.renderPass = renderPass;
 
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCI, nullptr, &pipeline));
+    // Render pass or, with dynamic rendering, the attachment formats
+    VkPipelineRenderingCreateInfoKHR pipelineRenderingCI{};
+    setupPipelineRenderingInfo(pipelineCI, pipelineRenderingCI);
 
-    // Cleanup shader modules
-    vkDestroyShaderModule(device, vertShaderModule, nullptr);
-    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    VkPipeline variant = VK_NULL_HANDLE;
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCI, nullptr, &variant));
+    std::string variantName = constants.describe();
+    debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE, variant, "triangle pipeline [%s]", variantName.c_str());
 
-    LOGI("Pipeline created");
+    LOGI("Pipeline variant created [%s]", variantName.c_str());
+    return variant;
 }
 
-void Triangle::updateUniformBuffer() {
-    ShaderData shaderData{};
-
-    // Create perspective matrix (Vulkan clip space: Y is flipped, depth 0..1)
-    float aspect = static_cast<float>(width) / static_cast<float>(height);
-    createPerspectiveMatrix(shaderData.projectionMatrix, 60.0f * 3.14159265f / 180.0f, aspect, 0.1f, 256.0f);
-
-    // Flip Y for Vulkan (Vulkan Y axis is inverted compared to OpenGL)
-    shaderData.projectionMatrix[5] *= -1.0f;
-
-    // Create view matrix (look at origin from z=2.5, looking towards negative z)
-    createLookAtMatrix(shaderData.viewMatrix, 0.0f, 0.0f, 2.5f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-    // Create model matrix with rotation
-    createRotationMatrix(shaderData.modelMatrix, rotation, 0.0f, 0.0f, 1.0f);
-
-    // Copy to uniform buffer
-    memcpy(uniformBuffers[currentFrame].mapped, &shaderData, sizeof(ShaderData));
+void Triangle::updateUniformBuffer(const SceneState& scene) {
+    // Look at the origin from the simulated camera distance on +z; unchanged camera
+    // inputs keep the cached matrices
+    const float eye[3] = {0.0f, 0.0f, scene.cameraDistance};
+    const float center[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    camera.setExtent(width, height);
+    camera.setLookAt(eye, center, up);
+
+    // Model rotation around Z
+    const float axis[3] = {0.0f, 0.0f, 1.0f};
+    sceneGraph.setRotation(triangleNode, scene.rotation, axis);
+    sceneGraph.update();
+
+    // Each frame slot has its own buffer, so the camera matrices are written until
+    // every slot has the current version
+    UniformBuffer& uniformBuffer = uniformBuffers[currentFrame];
+    ShaderData* shaderData = reinterpret_cast<ShaderData*>(uniformBuffer.mapped);
+    if (uniformBuffer.cameraVersion != camera.getVersion()) {
+        memcpy(shaderData->projectionMatrix, camera.getProjectionMatrix(), sizeof(shaderData->projectionMatrix));
+        memcpy(shaderData->viewMatrix, camera.getViewMatrix(), sizeof(shaderData->viewMatrix));
+        uniformBuffer.cameraVersion = camera.getVersion();
+    }
+    memcpy(shaderData->modelMatrix, sceneGraph.getWorldMatrix(triangleNode), sizeof(shaderData->modelMatrix));
 }
 
 void Triangle::render() {
@@ -425,13 +777,17 @@ void Triangle::render() {
 
     prepareFrame();
 
-    // Update rotation
-    rotation += 0.5f;
-    if (rotation > 360.0f) {
-        rotation -= 360.0f;
-    }
+    // Take the newest simulation snapshot and interpolate it to the current time
+    const auto& snapshot = simulation.latest();
+    float alpha = simulation.interpolationFactor(snapshot, std::chrono::steady_clock::now());
+    updateUniformBuffer(interpolateScene(snapshot.previous, snapshot.current, alpha));
+    uint32_t drawInstanceCount = cullInstances();
 
-    updateUniformBuffer();
+    // First frame showing new input reports its latency on present
+    if (snapshot.current.inputTimeNs != presentedInputTimeNs) {
+        presentedInputTimeNs = snapshot.current.inputTimeNs;
+        setFrameInputTime(presentedInputTimeNs);
+    }
 
     // Build command buffer
     VkCommandBuffer cmdBuffer = commandBuffers[currentFrame];
@@ -440,126 +796,67 @@ void Triangle::render() {
     VkCommandBufferBeginInfo cmdBufBeginInfo{};
     cmdBufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &cmdBufBeginInfo));
+    beginGpuFrameTimer(cmdBuffer);
+    if (uploadStressSize > 0) {
+        recordUploadStress(cmdBuffer);
+    }
 
-    // Begin render pass
+    // Begin rendering (vkCmdBeginRenderingKHR with dynamic rendering, otherwise a render pass)
     std::array<VkClearValue, 2> clearValues{};
     clearValues[0].color = defaultClearColor;
     clearValues[1].depthStencil = {1.0f, 0};
 
-    VkRenderPassBeginInfo renderPassBeginInfo{};
-    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassBeginInfo.renderPass = renderPass;
-    renderPassBeginInfo.framebuffer = frameBuffers[currentBuffer];
-    renderPassBeginInfo.renderArea.extent = {width, height};
-    renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassBeginInfo.pClearValues = clearValues.data();
-
-    vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    beginRendering(cmdBuffer, clearValues);
 
-    // Set viewport and scissor
+    // Set viewport and scissor (renderExtent is below the swapchain size with dynamic resolution)
     VkViewport viewport{};
-    viewport.width = static_cast<float>(width);
-    viewport.height = static_cast<float>(height);
+    viewport.width = static_cast<float>(renderExtent.width);
+    viewport.height = static_cast<float>(renderExtent.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
 
     VkRect2D scissor{};
-    scissor.extent = {width, height};
+    scissor.extent = renderExtent;
     vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 
     // Bind pipeline
+    debugUtils.beginLabel(cmdBuffer, "draw triangle", 0.4f, 1.0f, 0.4f);
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-    // Bind descriptor set
-    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 
-        0, 1, &uniformBuffers[currentFrame].descriptorSet, 0, nullptr);
+    // Bind descriptor set; the bindless set holds every frame's resources, draws only
+    // change the handles in the push constants
+    if (bindlessDraw) {
+        VkDescriptorSet bindlessSet = bindlessTable.getSet();
+        vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
+            0, 1, &bindlessSet, 0, nullptr);
+        pushConstants.shaderDataHandle = uniformBuffers[currentFrame].bindlessHandle;
+    } else {
+        vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
+            0, 1, &uniformBuffers[currentFrame].descriptorSet, 0, nullptr);
+    }
 
-    // Bind vertex buffer
-    VkDeviceSize offsets[1] = {0};
-    vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &vertexBuffer.handle, offsets);
+    // Bind the vertex buffer and this frame's instance ids
+    VkBuffer vertexBuffers[2] = {vertexBuffer.handle, instanceBuffers[currentFrame].handle};
+    VkDeviceSize offsets[2] = {0, 0};
+    vkCmdBindVertexBuffers(cmdBuffer, 0, 2, vertexBuffers, offsets);
 
     // Bind index buffer
     vkCmdBindIndexBuffer(cmdBuffer, indexBuffer.handle, 0, VK_INDEX_TYPE_UINT32);
 
-    // Draw indexed triangle
-    vkCmdDrawIndexed(cmdBuffer, indexCount, 1, 0, 0, 0);
+    // Draw indexed triangle, one instance unless a benchmark scenario asks for more, of
+    // which only those in the view frustum are drawn
+    // Levels still streaming in are excluded from sampling
+    pushConstants.textureMinLod = texture.getMinLod();
+    vkCmdPushConstants(cmdBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                       sizeof(pushConstants), &pushConstants);
+    vkCmdDrawIndexed(cmdBuffer, indexCount, drawInstanceCount, 0, 0, 0);
+    debugUtils.endLabel(cmdBuffer);
 
-    vkCmdEndRenderPass(cmdBuffer);
+    endRendering(cmdBuffer);
 
+    endGpuFrameTimer(cmdBuffer);
     VK_CHECK_RESULT(vkEndCommandBuffer(cmdBuffer));
 
     submitFrame();
 }
-
-// Matrix helper functions
-void Triangle::createIdentityMatrix(float* matrix) {
-    memset(matrix, 0, 16 * sizeof(float));
-    matrix[0] = matrix[5] = matrix[10] = matrix[15] = 1.0f;
-}
-
-void Triangle::createPerspectiveMatrix(float* matrix, float fov, float aspect, float near, float far) {
-    memset(matrix, 0, 16 * sizeof(float));
-    float tanHalfFov = tanf(fov / 2.0f);
-    
-    matrix[0] = 1.0f / (aspect * tanHalfFov);
-    matrix[5] = 1.0f / tanHalfFov;
-    matrix[10] = -(far + near) / (far - near);
-    matrix[11] = -1.0f;
-    matrix[14] = -(2.0f * far * near) / (far - near);
-}
-
-void Triangle::createLookAtMatrix(float* matrix, float eyeX, float eyeY, float eyeZ,
-                                  float centerX, float centerY, float centerZ,
-                                  float upX, float upY, float upZ) {
-    float fx = centerX - eyeX;
-    float fy = centerY - eyeY;
-    float fz = centerZ - eyeZ;
-
-    float fLen = sqrtf(fx * fx + fy * fy + fz * fz);
-    fx /= fLen; fy /= fLen; fz /= fLen;
-
-    float sx = fy * upZ - fz * upY;
-    float sy = fz * upX - fx * upZ;
-    float sz = fx * upY - fy * upX;
-
-    float sLen = sqrtf(sx * sx + sy * sy + sz * sz);
-    sx /= sLen; sy /= sLen; sz /= sLen;
-
-    float ux = sy * fz - sz * fy;
-    float uy = sz * fx - sx * fz;
-    float uz = sx * fy - sy * fx;
-
-    matrix[0] = sx;  matrix[4] = sy;  matrix[8]  = sz;  matrix[12] = -(sx * eyeX + sy * eyeY + sz * eyeZ);
-    matrix[1] = ux;  matrix[5] = uy;  matrix[9]  = uz;  matrix[13] = -(ux * eyeX + uy * eyeY + uz * eyeZ);
-    matrix[2] = -fx; matrix[6] = -fy; matrix[10] = -fz; matrix[14] = (fx * eyeX + fy * eyeY + fz * eyeZ);
-    matrix[3] = 0.0f; matrix[7] = 0.0f; matrix[11] = 0.0f; matrix[15] = 1.0f;
-}
-
-void Triangle::createRotationMatrix(float* matrix, float angle, float x, float y, float z) {
-    float rad = angle * 3.14159265f / 180.0f;
-    float c = cosf(rad);
-    float s = sinf(rad);
-    float len = sqrtf(x * x + y * y + z * z);
-    x /= len; y /= len; z /= len;
-
-    matrix[0] = x * x * (1 - c) + c;
-    matrix[1] = y * x * (1 - c) + z * s;
-    matrix[2] = x * z * (1 - c) - y * s;
-    matrix[3] = 0.0f;
-
-    matrix[4] = x * y * (1 - c) - z * s;
-    matrix[5] = y * y * (1 - c) + c;
-    matrix[6] = y * z * (1 - c) + x * s;
-    matrix[7] = 0.0f;
-
-    matrix[8] = x * z * (1 - c) + y * s;
-    matrix[9] = y * z * (1 - c) - x * s;
-    matrix[10] = z * z * (1 - c) + c;
-    matrix[11] = 0.0f;
-
-    matrix[12] = 0.0f;
-    matrix[13] = 0.0f;
-    matrix[14] = 0.0f;
-    matrix[15] = 1.0f;
-}
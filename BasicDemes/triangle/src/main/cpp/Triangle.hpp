@@ -6,7 +6,14 @@
 #pragma once
 
 #include "VulkanBase.hpp"
+#include "Simulation.hpp"
+#include "MatrixUtils.hpp"
+#include "SceneGraph.hpp"
+#include "Camera.hpp"
+#include "FrustumCuller.hpp"
+#include "PipelineVariants.hpp"
 #include <array>
+#include <vector>
 
 class Triangle : public VulkanExampleBase {
 public:
@@ -22,9 +29,22 @@ public:
         VkBuffer handle = VK_NULL_HANDLE;
     };
 
-    // Uniform buffer for shader data
+    // Uniform buffer for shader data; read as a storage buffer through its handle when bindless
     struct UniformBuffer : VulkanBuffer {
         VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t bindlessHandle = BindlessTable::INVALID_HANDLE;
+        uint8_t* mapped = nullptr;
+        uint64_t cameraVersion = 0;  // Camera matrices last written, 0 = never
+    };
+
+    // Per frame vertex buffer of the instances to draw, one id per instance
+    struct InstanceBuffer : VulkanBuffer {
+        uint32_t* mapped = nullptr;
+        uint64_t cameraVersion = 0;  // Camera the ids were culled with, 0 = never
+    };
+
+    // Persistently mapped host visible buffer
+    struct StagingBuffer : VulkanBuffer {
         uint8_t* mapped = nullptr;
     };
 
@@ -35,8 +55,28 @@ public:
         float viewMatrix[16];
     };
 
+    // Instance grid of the vertex shader (one unscaled instance draws the plain triangle),
+    // the texture LOD clamp of the fragment shader and, when bindless, the resource handles
+    struct PushConstants {
+        float grid[4];  // x: columns, y: spacing, z: triangle scale
+        float textureMinLod;
+        uint32_t textureHandle;
+        uint32_t shaderDataHandle;
+    };
+
+    // Scene state owned by the simulation thread, handed to rendering as immutable snapshots
+    struct SceneState {
+        float rotation;        // Model rotation around Z in degrees
+        float cameraDistance;  // Camera distance from the origin along Z
+        bool touching;         // Primary pointer is down
+        float touchX;          // Last primary pointer x in pixels
+        int64_t inputTimeNs;   // Oldest sample of the input last applied, for latency
+    };
+
 private:
-    // Vertex and index buffers
+    // CPU side mesh data and the vertex and index buffers
+    std::vector<Vertex> meshVertices;
+    std::vector<uint32_t> meshIndices;
     VulkanBuffer vertexBuffer;
     VulkanBuffer indexBuffer;
     uint32_t indexCount = 0;
@@ -44,16 +84,57 @@ private:
     // Uniform buffers (one per frame in flight)
     std::array<UniformBuffer, MAX_CONCURRENT_FRAMES> uniformBuffers;
 
-    // Descriptor set layout and pool
+    // Scene transforms and camera; their matrices are only rebuilt when something changed
+    SceneGraph sceneGraph;
+    uint32_t triangleNode = 0;
+    Camera camera;
+
+    // Bounding spheres of the instance grid, culled against the camera frustum into the
+    // ids of the instances to draw. The bounds are static, so culling only reruns when
+    // the camera changes.
+    BoundingSpheres instanceBounds;
+    FrustumCuller culler;
+    std::vector<uint32_t> visibleInstances;
+    uint64_t culledCameraVersion = 0;
+    std::array<InstanceBuffer, MAX_CONCURRENT_FRAMES> instanceBuffers;
+
+    // Descriptor set layout and pool, unused when drawing bindless: the shaders then index
+    // the base class' bindless table with handles from the push constants
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    bool bindlessDraw = false;
 
-    // Pipeline layout and pipeline
+    // Specialization constant IDs shared by triangle.vert and triangle.frag
+    static constexpr uint32_t SPEC_INSTANCED = 0;
+    static constexpr uint32_t SPEC_TEXTURED = 1;
+
+    // Texture modulating the vertex colors, streamed from textures/triangle.*.ktx2; a
+    // procedural checkerboard with GPU generated mips is used if no variant ships with
+    // the app, and a white texel if even that can't be created
+    Texture texture;
+    bool textured = false;
+
+    // Pipeline layout, shader modules and the pipeline of each specialization variant;
+    // pipeline is the variant currently drawn with
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkShaderModule vertShaderModule = VK_NULL_HANDLE;
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    PipelineVariantCache pipelineVariants;
     VkPipeline pipeline = VK_NULL_HANDLE;
 
-    // Rotation angle for animation
-    float rotation = 0.0f;
+    // Benchmark scenarios (see configureScenario()): instanced copies of the triangle laid
+    // out by the grid push constant, and a staging upload of uploadStressSize bytes
+    // recorded into every frame
+    uint32_t instanceCount = 1;
+    PushConstants pushConstants{{1.0f, 0.0f, 1.0f, 0.0f}, 0.0f, 0, 0};
+    VkDeviceSize uploadStressSize = 0;
+    std::array<StagingBuffer, MAX_CONCURRENT_FRAMES> uploadStagingBuffers;
+    VulkanBuffer uploadTargetBuffer;
+
+    // Fixed timestep simulation producing scene snapshots
+    FixedStepSimulation<SceneState> simulation;
+    // Input time of the last frame that reported input to present latency
+    int64_t presentedInputTimeNs = 0;
 
 public:
     Triangle();
@@ -63,22 +144,32 @@ protected:
     void prepare() override;
     void render() override;
     void cleanup() override;
+    void pauseChanged() override;
+    void addStartupTasks(StartupScheduler& scheduler) override;
+    void colorFormatChanged() override;
 
 private:
     // Setup methods
+    void buildMesh();
     void createVertexBuffer();
     void createUniformBuffers();
     void createDescriptors();
+    bool createCheckerTexture();
     void createPipeline();
+    SpecializationConstants getPipelineConstants() const;
+    VkPipeline getPipeline(const SpecializationConstants& constants);
+    VkPipeline createPipelineVariant(const SpecializationConstants& constants);
+    void configureScenario(const std::string& scenario);
+    void createUploadStressBuffers();
+    void createInstanceBuffers();
+    uint32_t cullInstances();
+    void recordUploadStress(VkCommandBuffer cmdBuffer);
+
+    // Simulation step (runs on the simulation thread and consumes the input queue)
+    // and interpolation between two snapshot states
+    void stepScene(SceneState& state, double stepSeconds);
+    static SceneState interpolateScene(const SceneState& from, const SceneState& to, float alpha);
 
     // Update uniform buffer for current frame
-    void updateUniformBuffer();
-
-    // Matrix helper functions
-    void createIdentityMatrix(float* matrix);
-    void createPerspectiveMatrix(float* matrix, float fov, float aspect, float near, float far);
-    void createLookAtMatrix(float* matrix, float eyeX, float eyeY, float eyeZ,
-                            float centerX, float centerY, float centerZ,
-                            float upX, float upY, float upZ);
-    void createRotationMatrix(float* matrix, float angle, float x, float y, float z);
+    void updateUniformBuffer(const SceneState& scene);
 };
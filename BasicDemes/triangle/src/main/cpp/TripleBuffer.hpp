@@ -0,0 +1,57 @@
+/*
+ * Lock-free triple buffer
+ * Single producer / single consumer handoff of the latest value
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Lock-free single producer, single consumer triple buffer
+ *
+ * The producer always owns one slot to write into and the consumer one slot to
+ * read from; the third slot is exchanged atomically between them. Neither side
+ * ever blocks, and the consumer always sees the most recently published value
+ * (older unread values are dropped).
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Producer: slot to fill before calling publish()
+    T &writeBuffer() { return buffers[writeIndex]; }
+
+    // Producer: hand the write slot over and take the spare one
+    void publish() {
+        uint8_t previous = middle.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Consumer: switch to the newest published value, returns false if there is none
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+            return false;
+        }
+        uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Consumer: current value, stable until the next update()
+    const T &readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    std::array<T, 3> buffers{};
+    std::atomic<uint8_t> middle{1};
+    uint8_t writeIndex = 0;
+    uint8_t readIndex = 2;
+};
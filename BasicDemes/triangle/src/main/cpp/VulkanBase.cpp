@@ -4,13 +4,43 @@
  */
 
 #include "VulkanBase.hpp"
+#include "TextureFormats.hpp"
+#include <sys/stat.h>
+#include <sys/system_properties.h>
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
 
 VulkanExampleBase::~VulkanExampleBase() {
+    // Jobs still queued may use the device
+    jobSystem.stop();
+
     if (device != VK_NULL_HANDLE) {
+        // Shutdown: drain the device once and destroy everything still retired
         vkDeviceWaitIdle(device);
+        deletionQueue.flush();
+
+        // Write out the last captures before their buffers go away
+        deliverReadbacks(timelineValue);
+        frameReadback.flush();
+        for (auto &buffer: readbackBuffers) {
+            if (buffer.buffer != VK_NULL_HANDLE) {
+                vkDestroyBuffer(device, buffer.buffer, nullptr);
+            }
+            freeMemory(buffer.memory);
+        }
+
+        // Destroy swapchain, size dependent targets and the surface
+        destroyWindowResources();
 
         // Destroy synchronization primitives
+        if (timelineSemaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, timelineSemaphore, nullptr);
+        }
+        if (computeTimelineSemaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, computeTimelineSemaphore, nullptr);
+        }
         for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
             if (waitFences[i] != VK_NULL_HANDLE) {
                 vkDestroyFence(device, waitFences[i], nullptr);
@@ -23,41 +53,45 @@ VulkanExampleBase::~VulkanExampleBase() {
             }
         }
 
-        // Destroy framebuffers
-        for (auto &fb: frameBuffers) {
-            vkDestroyFramebuffer(device, fb, nullptr);
+        // Destroy upscale pass
+        if (upscalePass.pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, upscalePass.pipeline, nullptr);
         }
-
-        // Destroy depth stencil
-        if (depthStencil.view != VK_NULL_HANDLE) {
-            vkDestroyImageView(device, depthStencil.view, nullptr);
+        if (upscalePass.pipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device, upscalePass.pipelineLayout, nullptr);
+        }
+        if (upscalePass.descriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(device, upscalePass.descriptorPool, nullptr);
         }
-        if (depthStencil.image != VK_NULL_HANDLE) {
-            vkDestroyImage(device, depthStencil.image, nullptr);
+        if (upscalePass.descriptorSetLayout != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(device, upscalePass.descriptorSetLayout, nullptr);
         }
-        if (depthStencil.memory != VK_NULL_HANDLE) {
-            vkFreeMemory(device, depthStencil.memory, nullptr);
+        if (upscalePass.renderPass != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(device, upscalePass.renderPass, nullptr);
         }
 
+        // Destroy the bindless table, shared samplers and the mip generation pipeline
+        bindlessTable.destroy();
+        mipGenerator.destroy();
+        samplerCache.destroy();
+
         // Destroy render pass
         if (renderPass != VK_NULL_HANDLE) {
             vkDestroyRenderPass(device, renderPass, nullptr);
         }
 
-        // Destroy swapchain image views
-        for (auto &buffer: swapChainBuffers) {
-            vkDestroyImageView(device, buffer.view, nullptr);
-        }
-
-        // Destroy swapchain
-        if (swapChain != VK_NULL_HANDLE) {
-            vkDestroySwapchainKHR(device, swapChain, nullptr);
+        // Destroy timestamp queries
+        if (timestampQueryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device, timestampQueryPool, nullptr);
         }
 
-        // Destroy command pool
+        // Destroy command pools
         if (commandPool != VK_NULL_HANDLE) {
             vkDestroyCommandPool(device, commandPool, nullptr);
         }
+        if (computeCommandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device, computeCommandPool, nullptr);
+        }
 
         // Destroy pipeline cache
         if (pipelineCache != VK_NULL_HANDLE) {
@@ -68,7 +102,7 @@ VulkanExampleBase::~VulkanExampleBase() {
         vkDestroyDevice(device, nullptr);
     }
 
-    // Destroy surface
+    // Surface without a device (already destroyed with the window resources otherwise)
     if (surface != VK_NULL_HANDLE) {
         vkDestroySurfaceKHR(instance, surface, nullptr);
     }
@@ -88,6 +122,48 @@ void VulkanExampleBase::initVulkan(android_app *app) {
     createDevice();
 }
 
+void VulkanExampleBase::startup() {
+    // One worker per fast core besides this thread's, pinned to those cores on big.LITTLE,
+    // but enough to overlap the file reads of startup on CPUs with few fast cores
+    jobSystem.start(JobSystem::AUTO, STARTUP_MIN_WORKERS);
+    const CpuTopology& topology = jobSystem.getTopology();
+    LOGI("Job system: %u workers, %zu of %u cores fast%s", jobSystem.getWorkerCount(),
+         topology.fastCores.size(), topology.coreCount, topology.uniform ? " (uniform)" : "");
+
+    StartupScheduler scheduler;
+
+    // Derived class CPU work, then file reads that need no device
+    addStartupTasks(scheduler);
+    if (enableDynamicResolution) {
+        preloadShaderFiles.emplace_back("shaders/upscale.vert.spv");
+        preloadShaderFiles.emplace_back("shaders/upscale.frag.spv");
+    }
+    for (const auto &file: preloadShaderFiles) {
+        scheduler.add("read " + file, [this, file]() { preloadShader(file); });
+    }
+    scheduler.add("read pipeline cache", [this]() { loadPipelineCacheData(); });
+    std::vector<StartupScheduler::TaskId> prepareDependencies = scheduler.getTaskIds();
+
+    // Device selection checks present support, so the device needs the surface
+    auto instanceTask = scheduler.add("create instance", [this]() { createInstance(); });
+    auto surfaceTask = scheduler.add("create surface", [this]() { createSurface(); }, {instanceTask});
+    prepareDependencies.push_back(
+            scheduler.add("create device", [this]() { createDevice(); }, {surfaceTask}));
+    scheduler.add("prepare", [this]() { prepare(); }, prepareDependencies, true);
+
+    scheduler.run(jobSystem);
+
+    LOGI("Startup timeline: %.1f ms on %u threads", scheduler.getTotalMs(), jobSystem.getWorkerCount() + 1);
+    for (const auto &entry: scheduler.getTimeline()) {
+        LOGI("  %-32s start %7.1f ms  duration %7.1f ms  thread %u", entry.name.c_str(),
+             entry.startMs, entry.durationMs, entry.thread);
+    }
+
+    // Drop shader code no pipeline asked for
+    std::lock_guard<std::mutex> lock(shaderCacheMutex);
+    shaderCache.clear();
+}
+
 void VulkanExampleBase::createInstance() {
     VkApplicationInfo appInfo{};
     appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -101,6 +177,11 @@ void VulkanExampleBase::createInstance() {
             VK_KHR_SURFACE_EXTENSION_NAME,
             VK_KHR_ANDROID_SURFACE_EXTENSION_NAME
     };
+    // Only requested in builds with VULKAN_DEBUG_UTILS, usually provided by a layer
+    if (const char *debugUtilsExtension = DebugUtils::getInstanceExtension()) {
+        instanceExtensions.push_back(debugUtilsExtension);
+        debugUtilsInstanceExtension = true;
+    }
 
     VkInstanceCreateInfo instanceCI{};
     instanceCI.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -122,57 +203,248 @@ void VulkanExampleBase::createSurface() {
 }
 
 void VulkanExampleBase::createDevice() {
-    // Enumerate physical devices
-    uint32_t gpuCount = 0;
-    VK_CHECK_RESULT(vkEnumeratePhysicalDevices(instance, &gpuCount, nullptr));
-    assert(gpuCount > 0);
-
-    std::vector<VkPhysicalDevice> physicalDevices(gpuCount);
-    VK_CHECK_RESULT(vkEnumeratePhysicalDevices(instance, &gpuCount, physicalDevices.data()));
-    physicalDevice = physicalDevices[0];
+    // Score all physical devices; present support is checked against the window surface
+    std::vector<DeviceSelector::Candidate> candidates =
+            DeviceSelector::queryCandidates(instance, surface);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const DeviceSelector::Candidate &candidate = candidates[i];
+        DeviceSelector::QueueFamilies families =
+                DeviceSelector::selectQueueFamilies(candidate.queueFamilies, candidate.presentSupport);
+        LOGI("GPU %zu: %s (%s), score %lld", i, candidate.properties.deviceName,
+             DeviceSelector::deviceTypeName(candidate.properties.deviceType),
+             static_cast<long long>(DeviceSelector::scoreDevice(candidate, families)));
+    }
+    if (!DeviceSelector::select(candidates, deviceSelection)) {
+        LOGE("No GPU can render and present to the window surface");
+        assert(false);
+        return;
+    }
+    physicalDevice = deviceSelection.physicalDevice;
+    const DeviceSelector::QueueFamilies &queueFamilies = deviceSelection.queueFamilies;
+    queueFamilyIndex = queueFamilies.graphics;
 
     // Get device properties
     vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
     vkGetPhysicalDeviceFeatures(physicalDevice, &deviceFeatures);
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &deviceMemoryProperties);
 
-    LOGI("Using GPU: %s", deviceProperties.deviceName);
+    memoryTracker.setHeapCount(deviceMemoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < deviceMemoryProperties.memoryHeapCount; i++) {
+        const VkMemoryHeap &heap = deviceMemoryProperties.memoryHeaps[i];
+        memoryTracker.setHeapInfo(i, heap.size, (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0);
+    }
 
-    // Find graphics queue family
-    uint32_t queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
-    std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount,
-                                             queueFamilyProperties.data());
+    LOGI("Using GPU: %s", deviceProperties.deviceName);
 
-    for (uint32_t i = 0; i < queueFamilyCount; i++) {
-        if (queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            queueFamilyIndex = i;
-            break;
-        }
+    // Get supported device extensions
+    uint32_t extensionCount = 0;
+    VK_CHECK_RESULT(
+            vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr));
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    VK_CHECK_RESULT(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount,
+                                                         extensions.data()));
+    supportedDeviceExtensions.clear();
+    for (const auto &extension: extensions) {
+        supportedDeviceExtensions.emplace_back(extension.extensionName);
     }
 
-    // Create logical device
+    LOGI("Queue families: graphics/present %u, compute %u%s, transfer %u%s",
+         queueFamilies.graphics,
+         queueFamilies.compute, queueFamilies.asyncCompute() ? " (async)" : "",
+         queueFamilies.transfer, queueFamilies.dedicatedTransfer() ? " (dedicated)" : "");
+
+    // GPU frame timing needs timestamp support on the graphics queue
+    timestampValidBits = deviceSelection.queueFamilyProperties[queueFamilyIndex].timestampValidBits;
+    gpuTimestamps = timestampValidBits > 0 && deviceProperties.limits.timestampPeriod > 0.0f;
+
+    // Create logical device with one queue per distinct selected family
     float queuePriority = 1.0f;
-    VkDeviceQueueCreateInfo queueCI{};
-    queueCI.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCI.queueFamilyIndex = queueFamilyIndex;
-    queueCI.queueCount = 1;
-    queueCI.pQueuePriorities = &queuePriority;
+    std::vector<VkDeviceQueueCreateInfo> queueCIs;
+    for (uint32_t family: {queueFamilies.graphics, queueFamilies.compute, queueFamilies.transfer}) {
+        bool added = std::any_of(queueCIs.begin(), queueCIs.end(),
+                                 [family](const VkDeviceQueueCreateInfo &queueCI) {
+                                     return queueCI.queueFamilyIndex == family;
+                                 });
+        if (!added) {
+            VkDeviceQueueCreateInfo queueCI{};
+            queueCI.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueCI.queueFamilyIndex = family;
+            queueCI.queueCount = 1;
+            queueCI.pQueuePriorities = &queuePriority;
+            queueCIs.push_back(queueCI);
+        }
+    }
 
     std::vector<const char *> deviceExtensions = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
 
+    // Query optional features, only chaining structures of supported extensions.
+    // Dynamic rendering needs depth/stencil resolve and renderpass2 on a 1.1 device.
+    const bool dynamicRenderingAvailable =
+            enableDynamicRendering &&
+            extensionSupported(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) &&
+            extensionSupported(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME) &&
+            extensionSupported(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+    const bool timelineSemaphoreAvailable =
+            extensionSupported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    // maintenance3, which descriptor indexing depends on, is core in 1.1
+    const bool descriptorIndexingAvailable =
+            enableBindless && extensionSupported(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures{};
+    timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+    descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    void **queryChain = &features2.pNext;
+    if (dynamicRenderingAvailable) {
+        *queryChain = &dynamicRenderingFeatures;
+        queryChain = &dynamicRenderingFeatures.pNext;
+    }
+    if (timelineSemaphoreAvailable) {
+        *queryChain = &timelineSemaphoreFeatures;
+        queryChain = &timelineSemaphoreFeatures.pNext;
+    }
+    if (descriptorIndexingAvailable) {
+        *queryChain = &descriptorIndexingFeatures;
+        queryChain = &descriptorIndexingFeatures.pNext;
+    }
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+    // Enabled features are chained into the device create info
+    void *featureChain = nullptr;
+
+    dynamicRendering = dynamicRenderingAvailable && dynamicRenderingFeatures.dynamicRendering;
+    if (dynamicRendering) {
+        deviceExtensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        dynamicRenderingFeatures.pNext = featureChain;
+        featureChain = &dynamicRenderingFeatures;
+    }
+
+    timelineSemaphores = timelineSemaphoreAvailable && timelineSemaphoreFeatures.timelineSemaphore;
+    if (timelineSemaphores) {
+        deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        timelineSemaphoreFeatures.pNext = featureChain;
+        featureChain = &timelineSemaphoreFeatures;
+    }
+
+    // Bindless arrays are partially bound, updated while in use and indexed by handles
+    // that are uniform per draw
+    bindless = descriptorIndexingAvailable &&
+               descriptorIndexingFeatures.runtimeDescriptorArray &&
+               descriptorIndexingFeatures.descriptorBindingPartiallyBound &&
+               descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+               descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+               descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+               deviceFeatures.shaderSampledImageArrayDynamicIndexing &&
+               deviceFeatures.shaderStorageBufferArrayDynamicIndexing;
+    if (bindless) {
+        deviceExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        descriptorIndexingFeatures.pNext = featureChain;
+        featureChain = &descriptorIndexingFeatures;
+        enabledFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+        enabledFeatures.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+
+        descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &descriptorIndexingProperties;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+    } else if (enableBindless) {
+        LOGW("Descriptor indexing not supported, using per draw descriptor sets");
+    }
+
+    // Compute mip generation writes storage images of any format from one shader
+    enabledFeatures.shaderStorageImageWriteWithoutFormat = deviceFeatures.shaderStorageImageWriteWithoutFormat;
+
+    // Per heap budget and usage of this process
+    memoryBudget = extensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memoryBudget) {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    // Actual present times for latency measurement
+    displayTiming = extensionSupported(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+    if (displayTiming) {
+        deviceExtensions.push_back(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+    }
+
     VkDeviceCreateInfo deviceCI{};
     deviceCI.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceCI.queueCreateInfoCount = 1;
-    deviceCI.pQueueCreateInfos = &queueCI;
+    deviceCI.pNext = featureChain;
+    deviceCI.queueCreateInfoCount = static_cast<uint32_t>(queueCIs.size());
+    deviceCI.pQueueCreateInfos = queueCIs.data();
     deviceCI.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
     deviceCI.ppEnabledExtensionNames = deviceExtensions.data();
+    deviceCI.pEnabledFeatures = &enabledFeatures;
 
     VK_CHECK_RESULT(vkCreateDevice(physicalDevice, &deviceCI, nullptr, &device));
     vkGetDeviceQueue(device, queueFamilyIndex, 0, &queue);
+    vkGetDeviceQueue(device, queueFamilies.compute, 0, &computeQueue);
+    vkGetDeviceQueue(device, queueFamilies.transfer, 0, &transferQueue);
+
+    debugUtils.setup(instance, device, debugUtilsInstanceExtension);
+    samplerCache.setup(device);
+    mipGenerator.setup(device, physicalDevice, enabledFeatures.shaderStorageImageWriteWithoutFormat == VK_TRUE);
+    // adb shell setprop debug.vulkan.mipcompute 1 generates mips with the compute shader
+    // wherever the format allows, to exercise it on devices that would blit
+    char mipComputeValue[PROP_VALUE_MAX] = {};
+    if (__system_property_get("debug.vulkan.mipcompute", mipComputeValue) > 0) {
+        mipGenerator.setPreferCompute(strtoul(mipComputeValue, nullptr, 10) != 0);
+    }
+    if (debugUtils.isEnabled()) {
+        debugUtils.setObjectName(VK_OBJECT_TYPE_DEVICE, device, "%s", deviceProperties.deviceName);
+        debugUtils.setObjectName(VK_OBJECT_TYPE_QUEUE, queue, "graphics queue");
+        if (queueFamilies.asyncCompute()) {
+            debugUtils.setObjectName(VK_OBJECT_TYPE_QUEUE, computeQueue, "compute queue");
+        }
+        if (queueFamilies.dedicatedTransfer()) {
+            debugUtils.setObjectName(VK_OBJECT_TYPE_QUEUE, transferQueue, "transfer queue");
+        }
+        LOGI("Using debug utils object names and labels");
+    }
+
+    if (dynamicRendering) {
+        vkCmdBeginRenderingKHR = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR"));
+        vkCmdEndRenderingKHR = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR"));
+        LOGI("Using dynamic rendering");
+    }
+
+    if (timelineSemaphores) {
+        vkWaitSemaphoresKHR = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+                vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+        vkGetSemaphoreCounterValueKHR = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+                vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+        LOGI("Using timeline semaphore for frame synchronization");
+    }
+
+    // Cross-queue waits use a compute timeline, so async compute needs timeline semaphores
+    asyncCompute = enableAsyncCompute && timelineSemaphores && queueFamilies.asyncCompute();
+    computeQueueFamilyIndex = asyncCompute ? queueFamilies.compute : queueFamilyIndex;
+    if (asyncCompute) {
+        LOGI("Using async compute queue (family %u)", computeQueueFamilyIndex);
+    }
+
+    if (displayTiming) {
+        vkGetPastPresentationTimingGOOGLE = reinterpret_cast<PFN_vkGetPastPresentationTimingGOOGLE>(
+                vkGetDeviceProcAddr(device, "vkGetPastPresentationTimingGOOGLE"));
+        pastPresentationTimings.reserve(LatencyTracker::MAX_OPEN_FRAMES);
+        latencyTracker.setPresentSource(LatencyTracker::PresentSource::DisplayTiming);
+        LOGI("Using display timing for present latency");
+    } else {
+        latencyTracker.setPresentSource(LatencyTracker::PresentSource::GpuComplete);
+    }
+
+    updateMemoryBudget();
 
     LOGI("Vulkan device created");
 }
@@ -230,6 +502,14 @@ void VulkanExampleBase::createSwapChain() {
     swapchainCI.imageExtent = swapchainExtent;
     swapchainCI.imageArrayLayers = 1;
     swapchainCI.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Transfer reads for frame capture, if requested and supported by the surface
+    swapchainReadback = enableSwapchainReadback &&
+                        (surfaceCaps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    if (swapchainReadback) {
+        swapchainCI.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    } else if (enableSwapchainReadback) {
+        LOGW("Swapchain images do not support transfer reads, frame capture disabled");
+    }
     swapchainCI.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapchainCI.preTransform = surfaceCaps.currentTransform;
     swapchainCI.compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
@@ -237,6 +517,7 @@ void VulkanExampleBase::createSwapChain() {
     swapchainCI.clipped = VK_TRUE;
 
     VK_CHECK_RESULT(vkCreateSwapchainKHR(device, &swapchainCI, nullptr, &swapChain));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_SWAPCHAIN_KHR, swapChain, "swapchain");
 
     // Get swapchain images
     VK_CHECK_RESULT(vkGetSwapchainImagesKHR(device, swapChain, &imageCount, nullptr));
@@ -263,6 +544,9 @@ void VulkanExampleBase::createSwapChain() {
         viewCI.subresourceRange.layerCount = 1;
 
         VK_CHECK_RESULT(vkCreateImageView(device, &viewCI, nullptr, &swapChainBuffers[i].view));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, images[i], "swapchain image %u", i);
+        debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, swapChainBuffers[i].view,
+                                 "swapchain view %u", i);
     }
 
     LOGI("Swapchain created: %dx%d, %d images", width, height, imageCount);
@@ -275,6 +559,12 @@ void VulkanExampleBase::createCommandPool() {
     cmdPoolCI.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     VK_CHECK_RESULT(vkCreateCommandPool(device, &cmdPoolCI, nullptr, &commandPool));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_COMMAND_POOL, commandPool, "graphics command pool");
+
+    // Command buffers are tied to the family of their pool, compute gets its own
+    cmdPoolCI.queueFamilyIndex = computeQueueFamilyIndex;
+    VK_CHECK_RESULT(vkCreateCommandPool(device, &cmdPoolCI, nullptr, &computeCommandPool));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_COMMAND_POOL, computeCommandPool, "compute command pool");
 }
 
 void VulkanExampleBase::createCommandBuffers() {
@@ -285,6 +575,15 @@ void VulkanExampleBase::createCommandBuffers() {
     cmdBufAllocInfo.commandBufferCount = MAX_CONCURRENT_FRAMES;
 
     VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &cmdBufAllocInfo, commandBuffers.data()));
+
+    cmdBufAllocInfo.commandPool = computeCommandPool;
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &cmdBufAllocInfo, computeCommandBuffers.data()));
+    for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+        debugUtils.setObjectName(VK_OBJECT_TYPE_COMMAND_BUFFER, commandBuffers[i],
+                                 "frame %u command buffer", i);
+        debugUtils.setObjectName(VK_OBJECT_TYPE_COMMAND_BUFFER, computeCommandBuffers[i],
+                                 "frame %u compute command buffer", i);
+    }
 }
 
 void VulkanExampleBase::createSynchronizationPrimitives() {
@@ -295,19 +594,127 @@ void VulkanExampleBase::createSynchronizationPrimitives() {
     VkSemaphoreCreateInfo semaphoreCI{};
     semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
+    if (timelineSemaphores) {
+        VkSemaphoreTypeCreateInfoKHR semaphoreTypeCI{};
+        semaphoreTypeCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+        semaphoreTypeCI.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+        semaphoreTypeCI.initialValue = timelineValue;
+
+        VkSemaphoreCreateInfo timelineCI{};
+        timelineCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        timelineCI.pNext = &semaphoreTypeCI;
+        VK_CHECK_RESULT(vkCreateSemaphore(device, &timelineCI, nullptr, &timelineSemaphore));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_SEMAPHORE, timelineSemaphore, "timeline");
+
+        if (asyncCompute) {
+            semaphoreTypeCI.initialValue = computeTimelineValue;
+            VK_CHECK_RESULT(vkCreateSemaphore(device, &timelineCI, nullptr, &computeTimelineSemaphore));
+            debugUtils.setObjectName(VK_OBJECT_TYPE_SEMAPHORE, computeTimelineSemaphore,
+                                     "compute timeline");
+        }
+    }
+
     for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
-        VK_CHECK_RESULT(vkCreateFence(device, &fenceCI, nullptr, &waitFences[i]));
+        if (!timelineSemaphores) {
+            VK_CHECK_RESULT(vkCreateFence(device, &fenceCI, nullptr, &waitFences[i]));
+            debugUtils.setObjectName(VK_OBJECT_TYPE_FENCE, waitFences[i], "frame %u fence", i);
+        }
         VK_CHECK_RESULT(
                 vkCreateSemaphore(device, &semaphoreCI, nullptr, &presentCompleteSemaphores[i]));
         VK_CHECK_RESULT(
                 vkCreateSemaphore(device, &semaphoreCI, nullptr, &renderCompleteSemaphores[i]));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_SEMAPHORE, presentCompleteSemaphores[i],
+                                 "frame %u present complete", i);
+        debugUtils.setObjectName(VK_OBJECT_TYPE_SEMAPHORE, renderCompleteSemaphores[i],
+                                 "frame %u render complete", i);
     }
 }
 
 void VulkanExampleBase::createPipelineCache() {
     VkPipelineCacheCreateInfo pipelineCacheCI{};
     pipelineCacheCI.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    // Only seed the cache with data written by this driver on this device
+    VkPipelineCacheHeaderVersionOne header{};
+    if (pipelineCacheData.size() >= sizeof(header)) {
+        memcpy(&header, pipelineCacheData.data(), sizeof(header));
+        if (header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+            header.vendorID == deviceProperties.vendorID &&
+            header.deviceID == deviceProperties.deviceID &&
+            memcmp(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0) {
+            pipelineCacheCI.initialDataSize = pipelineCacheData.size();
+            pipelineCacheCI.pInitialData = pipelineCacheData.data();
+            LOGI("Using pipeline cache data (%zu bytes)", pipelineCacheData.size());
+        } else {
+            LOGW("Pipeline cache data is from another device or driver, ignoring it");
+        }
+    }
     VK_CHECK_RESULT(vkCreatePipelineCache(device, &pipelineCacheCI, nullptr, &pipelineCache));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE_CACHE, pipelineCache, "pipeline cache");
+    pipelineCacheData.clear();
+    pipelineCacheData.shrink_to_fit();
+}
+
+std::string VulkanExampleBase::getPipelineCachePath() const {
+    return std::string(androidApp->activity->internalDataPath) + "/pipeline_cache.bin";
+}
+
+void VulkanExampleBase::loadPipelineCacheData() {
+    FILE *file = fopen(getPipelineCachePath().c_str(), "rb");
+    if (file == nullptr) {
+        return;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0) {
+        pipelineCacheData.resize(static_cast<size_t>(size));
+        if (fread(pipelineCacheData.data(), 1, pipelineCacheData.size(), file) != pipelineCacheData.size()) {
+            pipelineCacheData.clear();
+        }
+    }
+    fclose(file);
+}
+
+void VulkanExampleBase::savePipelineCache() {
+    if (pipelineCache == VK_NULL_HANDLE) {
+        return;
+    }
+    size_t size = 0;
+    VK_CHECK_RESULT(vkGetPipelineCacheData(device, pipelineCache, &size, nullptr));
+    std::vector<char> data(size);
+    VK_CHECK_RESULT(vkGetPipelineCacheData(device, pipelineCache, &size, data.data()));
+
+    // Write to a temporary file first so a kill mid-write never leaves a torn cache
+    std::string path = getPipelineCachePath();
+    std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr) {
+        LOGW("Could not write pipeline cache to %s", tempPath.c_str());
+        return;
+    }
+    bool written = fwrite(data.data(), 1, size, file) == size;
+    written = fclose(file) == 0 && written;
+    if (written && rename(tempPath.c_str(), path.c_str()) == 0) {
+        LOGI("Pipeline cache saved (%zu bytes)", size);
+    } else {
+        LOGW("Could not write pipeline cache to %s", path.c_str());
+        remove(tempPath.c_str());
+    }
+}
+
+void VulkanExampleBase::createTimestampQueryPool() {
+    if (!gpuTimestamps) {
+        LOGW("Timestamp queries not supported, GPU frame time unavailable");
+        return;
+    }
+
+    VkQueryPoolCreateInfo queryPoolCI{};
+    queryPoolCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCI.queryCount = MAX_CONCURRENT_FRAMES * 2;
+    VK_CHECK_RESULT(vkCreateQueryPool(device, &queryPoolCI, nullptr, &timestampQueryPool));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_QUERY_POOL, timestampQueryPool, "frame timestamps");
 }
 
 void VulkanExampleBase::setupDepthStencil() {
@@ -336,9 +743,11 @@ void VulkanExampleBase::setupDepthStencil() {
     imageCI.extent = {width, height, 1};
     imageCI.mipLevels = 1;
     imageCI.arrayLayers = 1;
-    imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCI.samples = sampleCount;
     imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
-    imageCI.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    // Depth is never stored, so it can live in tile memory only
+    imageCI.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                    VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
     imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
     VK_CHECK_RESULT(vkCreateImage(device, &imageCI, nullptr, &depthStencil.image));
@@ -349,10 +758,9 @@ void VulkanExampleBase::setupDepthStencil() {
     VkMemoryAllocateInfo memAlloc{};
     memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
     memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits,
-                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    memAlloc.memoryTypeIndex = getTransientMemoryTypeIndex(memReqs.memoryTypeBits);
 
-    VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &depthStencil.memory));
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Image, &depthStencil.memory));
     VK_CHECK_RESULT(vkBindImageMemory(device, depthStencil.image, depthStencil.memory, 0));
 
     VkImageViewCreateInfo viewCI{};
@@ -370,24 +778,307 @@ void VulkanExampleBase::setupDepthStencil() {
     viewCI.image = depthStencil.image;
 
     VK_CHECK_RESULT(vkCreateImageView(device, &viewCI, nullptr, &depthStencil.view));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, depthStencil.image, "depth stencil");
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, depthStencil.view, "depth stencil view");
+}
+
+void VulkanExampleBase::setupMultisampleTarget() {
+    VkImageCreateInfo imageCI{};
+    imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCI.imageType = VK_IMAGE_TYPE_2D;
+    imageCI.format = colorFormat;
+    imageCI.extent = {width, height, 1};
+    imageCI.mipLevels = 1;
+    imageCI.arrayLayers = 1;
+    imageCI.samples = sampleCount;
+    imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+    // Samples are resolved inside the render pass and never written back to memory
+    imageCI.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    imageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VK_CHECK_RESULT(vkCreateImage(device, &imageCI, nullptr, &multisampleTarget.image));
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, multisampleTarget.image, &memReqs);
+
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = memReqs.size;
+    memAlloc.memoryTypeIndex = getTransientMemoryTypeIndex(memReqs.memoryTypeBits);
+
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Image, &multisampleTarget.memory));
+    VK_CHECK_RESULT(vkBindImageMemory(device, multisampleTarget.image, multisampleTarget.memory, 0));
+
+    VkImageViewCreateInfo viewCI{};
+    viewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewCI.format = colorFormat;
+    viewCI.components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B,
+                         VK_COMPONENT_SWIZZLE_A};
+    viewCI.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewCI.subresourceRange.baseMipLevel = 0;
+    viewCI.subresourceRange.levelCount = 1;
+    viewCI.subresourceRange.baseArrayLayer = 0;
+    viewCI.subresourceRange.layerCount = 1;
+    viewCI.image = multisampleTarget.image;
+
+    VK_CHECK_RESULT(vkCreateImageView(device, &viewCI, nullptr, &multisampleTarget.view));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, multisampleTarget.image, "multisample color");
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, multisampleTarget.view, "multisample color view");
+}
+
+void VulkanExampleBase::setupOffscreenTarget() {
+    VkImageCreateInfo imageCI{};
+    imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCI.imageType = VK_IMAGE_TYPE_2D;
+    imageCI.format = colorFormat;
+    imageCI.extent = {width, height, 1};
+    imageCI.mipLevels = 1;
+    imageCI.arrayLayers = 1;
+    imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCI.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VK_CHECK_RESULT(vkCreateImage(device, &imageCI, nullptr, &offscreenTarget.image));
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, offscreenTarget.image, &memReqs);
+
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = memReqs.size;
+    memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits,
+                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Image, &offscreenTarget.memory));
+    VK_CHECK_RESULT(vkBindImageMemory(device, offscreenTarget.image, offscreenTarget.memory, 0));
+
+    VkImageViewCreateInfo viewCI{};
+    viewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewCI.format = colorFormat;
+    viewCI.components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B,
+                         VK_COMPONENT_SWIZZLE_A};
+    viewCI.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewCI.subresourceRange.baseMipLevel = 0;
+    viewCI.subresourceRange.levelCount = 1;
+    viewCI.subresourceRange.baseArrayLayer = 0;
+    viewCI.subresourceRange.layerCount = 1;
+    viewCI.image = offscreenTarget.image;
+
+    VK_CHECK_RESULT(vkCreateImageView(device, &viewCI, nullptr, &offscreenTarget.view));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, offscreenTarget.image, "offscreen color");
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, offscreenTarget.view, "offscreen color view");
+}
+
+void VulkanExampleBase::setupUpscalePass() {
+    // Bilinear sampler for the upscale
+    VkSamplerCreateInfo samplerCI{};
+    samplerCI.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCI.magFilter = VK_FILTER_LINEAR;
+    samplerCI.minFilter = VK_FILTER_LINEAR;
+    samplerCI.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerCI.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCI.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCI.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCI.maxLod = 1.0f;
+    samplerCI.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    VK_CHECK_RESULT(samplerCache.get(samplerCI, &upscalePass.sampler));
+
+    // Descriptor set sampling the offscreen target
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolCI{};
+    poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCI.poolSizeCount = 1;
+    poolCI.pPoolSizes = &poolSize;
+    poolCI.maxSets = 1;
+    VK_CHECK_RESULT(vkCreateDescriptorPool(device, &poolCI, nullptr, &upscalePass.descriptorPool));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_POOL, upscalePass.descriptorPool,
+                             "upscale descriptor pool");
+
+    VkDescriptorSetLayoutBinding layoutBinding{};
+    layoutBinding.binding = 0;
+    layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBinding.descriptorCount = 1;
+    layoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutCI{};
+    layoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutCI.bindingCount = 1;
+    layoutCI.pBindings = &layoutBinding;
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &layoutCI, nullptr,
+                                                &upscalePass.descriptorSetLayout));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, upscalePass.descriptorSetLayout,
+                             "upscale set layout");
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = upscalePass.descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &upscalePass.descriptorSetLayout;
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocInfo, &upscalePass.descriptorSet));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, upscalePass.descriptorSet,
+                             "upscale descriptor set");
+    updateUpscaleDescriptorSet();
+
+    // Pipeline layout: UV scale and clamp of the rendered sub-rectangle as push constants
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.size = 4 * sizeof(float);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCI{};
+    pipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCI.setLayoutCount = 1;
+    pipelineLayoutCI.pSetLayouts = &upscalePass.descriptorSetLayout;
+    pipelineLayoutCI.pushConstantRangeCount = 1;
+    pipelineLayoutCI.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCI, nullptr,
+                                           &upscalePass.pipelineLayout));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE_LAYOUT, upscalePass.pipelineLayout,
+                             "upscale pipeline layout");
+
+    createUpscalePipeline();
+
+    LOGI("Dynamic resolution upscale pass created");
+}
+
+void VulkanExampleBase::createUpscalePipeline() {
+    // Full-screen triangle pipeline, vertices are generated in the shader
+    VkShaderModule vertShaderModule = loadShader("shaders/upscale.vert.spv");
+    VkShaderModule fragShaderModule = loadShader("shaders/upscale.frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertShaderModule;
+    shaderStages[0].pName = "main";
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = fragShaderModule;
+    shaderStages[1].pName = "main";
+
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCI{};
+    vertexInputStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCI{};
+    inputAssemblyStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssemblyStateCI.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportStateCI{};
+    viewportStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportStateCI.viewportCount = 1;
+    viewportStateCI.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizationStateCI{};
+    rasterizationStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizationStateCI.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizationStateCI.cullMode = VK_CULL_MODE_NONE;
+    rasterizationStateCI.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizationStateCI.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampleStateCI{};
+    multisampleStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampleStateCI.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencilStateCI{};
+    depthStencilStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+
+    VkPipelineColorBlendAttachmentState blendAttachmentState{};
+    blendAttachmentState.colorWriteMask = 0xF;
+
+    VkPipelineColorBlendStateCreateInfo colorBlendStateCI{};
+    colorBlendStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendStateCI.attachmentCount = 1;
+    colorBlendStateCI.pAttachments = &blendAttachmentState;
+
+    std::array<VkDynamicState, 2> dynamicStates = {
+            VK_DYNAMIC_STATE_VIEWPORT,
+            VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicStateCI{};
+    dynamicStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicStateCI.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicStateCI.pDynamicStates = dynamicStates.data();
+
+    VkGraphicsPipelineCreateInfo pipelineCI{};
+    pipelineCI.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineCI.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineCI.pStages = shaderStages.data();
+    pipelineCI.pVertexInputState = &vertexInputStateCI;
+    pipelineCI.pInputAssemblyState = &inputAssemblyStateCI;
+    pipelineCI.pViewportState = &viewportStateCI;
+    pipelineCI.pRasterizationState = &rasterizationStateCI;
+    pipelineCI.pMultisampleState = &multisampleStateCI;
+    pipelineCI.pDepthStencilState = &depthStencilStateCI;
+    pipelineCI.pColorBlendState = &colorBlendStateCI;
+    pipelineCI.pDynamicState = &dynamicStateCI;
+    pipelineCI.layout = upscalePass.pipelineLayout;
+
+    // Swapchain color only, no depth
+    VkPipelineRenderingCreateInfoKHR pipelineRenderingCI{};
+    if (dynamicRendering) {
+        pipelineRenderingCI.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        pipelineRenderingCI.colorAttachmentCount = 1;
+        pipelineRenderingCI.pColorAttachmentFormats = &colorFormat;
+        pipelineCI.pNext = &pipelineRenderingCI;
+    } else {
+        pipelineCI.renderPass = upscalePass.renderPass;
+    }
+
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCI, nullptr,
+                                              &upscalePass.pipeline));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_PIPELINE, upscalePass.pipeline, "upscale pipeline");
+
+    vkDestroyShaderModule(device, vertShaderModule, nullptr);
+    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+}
+
+void VulkanExampleBase::updateUpscaleDescriptorSet() {
+    // Points at the offscreen target, which is recreated with the window
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = upscalePass.sampler;
+    imageInfo.imageView = offscreenTarget.view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet writeDS{};
+    writeDS.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDS.dstSet = upscalePass.descriptorSet;
+    writeDS.dstBinding = 0;
+    writeDS.descriptorCount = 1;
+    writeDS.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDS.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(device, 1, &writeDS, 0, nullptr);
 }
 
 void VulkanExampleBase::setupRenderPass() {
-    std::array<VkAttachmentDescription, 2> attachments{};
+    const bool multisampled = sampleCount != VK_SAMPLE_COUNT_1_BIT;
+    // With dynamic resolution the scene is resolved into the offscreen target and sampled later
+    const VkImageLayout targetLayout = dynamicResolution ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                                         : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    std::vector<VkAttachmentDescription> attachments(multisampled ? 3 : 2);
 
-    // Color attachment
+    // Color attachment (multisampled and transient when MSAA is enabled)
     attachments[0].format = colorFormat;
-    attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[0].samples = sampleCount;
     attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE
+                                          : VK_ATTACHMENT_STORE_OP_STORE;
     attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    attachments[0].finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+                                              : targetLayout;
 
     // Depth attachment
     attachments[1].format = depthFormat;
-    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[1].samples = sampleCount;
     attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
@@ -403,21 +1094,49 @@ void VulkanExampleBase::setupRenderPass() {
     depthReference.attachment = 1;
     depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
+    if (multisampled) {
+        // Resolve target: the swapchain or offscreen image, only written by the in-tile resolve
+        attachments[2].format = colorFormat;
+        attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[2].finalLayout = targetLayout;
+    }
+
+    VkAttachmentReference resolveReference{};
+    resolveReference.attachment = 2;
+    resolveReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorReference;
+    subpass.pResolveAttachments = multisampled ? &resolveReference : nullptr;
     subpass.pDepthStencilAttachment = &depthReference;
 
     std::array<VkSubpassDependency, 2> dependencies{};
 
+    // The depth and multisampled color images are shared by all frames in flight,
+    // so the previous frame's attachment writes must finish before this frame clears them
     dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
     dependencies[0].dstSubpass = 0;
-    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    if (dynamicResolution) {
+        // The offscreen target may still be sampled by the previous frame's upscale
+        dependencies[0].srcStageMask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                   VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     dependencies[0].dstAccessMask =
-            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
     dependencies[1].srcSubpass = 0;
@@ -428,6 +1147,12 @@ void VulkanExampleBase::setupRenderPass() {
             VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
     dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
     dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+    if (dynamicResolution) {
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        // The upscale samples with a different footprint, so this can't be by region
+        dependencies[1].dependencyFlags = 0;
+    }
 
     VkRenderPassCreateInfo renderPassCI{};
     renderPassCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -439,50 +1164,256 @@ void VulkanExampleBase::setupRenderPass() {
     renderPassCI.pDependencies = dependencies.data();
 
     VK_CHECK_RESULT(vkCreateRenderPass(device, &renderPassCI, nullptr, &renderPass));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_RENDER_PASS, renderPass, "scene render pass");
+
+    if (!dynamicResolution) {
+        return;
+    }
+
+    // Upscale pass: overwrites the whole swapchain image, so nothing needs to be loaded
+    VkAttachmentDescription presentAttachment{};
+    presentAttachment.format = colorFormat;
+    presentAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    presentAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    presentAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    presentAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    presentAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    presentAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    presentAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkSubpassDescription upscaleSubpass{};
+    upscaleSubpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    upscaleSubpass.colorAttachmentCount = 1;
+    upscaleSubpass.pColorAttachments = &colorReference;
+
+    std::array<VkSubpassDependency, 2> upscaleDependencies{};
+    upscaleDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    upscaleDependencies[0].dstSubpass = 0;
+    upscaleDependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    upscaleDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    upscaleDependencies[0].srcAccessMask = 0;
+    upscaleDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    upscaleDependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    upscaleDependencies[1] = dependencies[1];
+    upscaleDependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    upscaleDependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    upscaleDependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    renderPassCI.attachmentCount = 1;
+    renderPassCI.pAttachments = &presentAttachment;
+    renderPassCI.pSubpasses = &upscaleSubpass;
+    renderPassCI.dependencyCount = static_cast<uint32_t>(upscaleDependencies.size());
+    renderPassCI.pDependencies = upscaleDependencies.data();
+
+    VK_CHECK_RESULT(vkCreateRenderPass(device, &renderPassCI, nullptr, &upscalePass.renderPass));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_RENDER_PASS, upscalePass.renderPass,
+                             "upscale render pass");
 }
 
 void VulkanExampleBase::setupFrameBuffer() {
-    frameBuffers.resize(imageCount);
-
-    for (uint32_t i = 0; i < imageCount; i++) {
-        std::array<VkImageView, 2> attachments = {
-                swapChainBuffers[i].view,
-                depthStencil.view
-        };
+    VkFramebufferCreateInfo fbCI{};
+    fbCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbCI.width = width;
+    fbCI.height = height;
+    fbCI.layers = 1;
+
+    // Attachment order matches setupRenderPass(): color, depth, [resolve]
+    auto sceneAttachments = [this](VkImageView target) {
+        if (sampleCount != VK_SAMPLE_COUNT_1_BIT) {
+            return std::vector<VkImageView>{multisampleTarget.view, depthStencil.view, target};
+        }
+        return std::vector<VkImageView>{target, depthStencil.view};
+    };
 
-        VkFramebufferCreateInfo fbCI{};
-        fbCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    if (dynamicResolution) {
+        // A single scene framebuffer on the offscreen target
+        std::vector<VkImageView> attachments = sceneAttachments(offscreenTarget.view);
         fbCI.renderPass = renderPass;
         fbCI.attachmentCount = static_cast<uint32_t>(attachments.size());
         fbCI.pAttachments = attachments.data();
-        fbCI.width = width;
-        fbCI.height = height;
-        fbCI.layers = 1;
+        VK_CHECK_RESULT(vkCreateFramebuffer(device, &fbCI, nullptr, &offscreenTarget.frameBuffer));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_FRAMEBUFFER, offscreenTarget.frameBuffer,
+                                 "offscreen framebuffer");
+    }
+
+    // Per swapchain image: the scene pass, or the upscale pass with dynamic resolution
+    frameBuffers.resize(imageCount);
+    for (uint32_t i = 0; i < imageCount; i++) {
+        std::vector<VkImageView> attachments;
+        if (dynamicResolution) {
+            attachments = {swapChainBuffers[i].view};
+            fbCI.renderPass = upscalePass.renderPass;
+        } else {
+            attachments = sceneAttachments(swapChainBuffers[i].view);
+            fbCI.renderPass = renderPass;
+        }
+        fbCI.attachmentCount = static_cast<uint32_t>(attachments.size());
+        fbCI.pAttachments = attachments.data();
 
         VK_CHECK_RESULT(vkCreateFramebuffer(device, &fbCI, nullptr, &frameBuffers[i]));
+        debugUtils.setObjectName(VK_OBJECT_TYPE_FRAMEBUFFER, frameBuffers[i],
+                                 "swapchain framebuffer %u", i);
     }
 }
 
 void VulkanExampleBase::prepare() {
-    createSwapChain();
+    // Objects that live as long as the device
     createCommandPool();
     createCommandBuffers();
     createSynchronizationPrimitives();
     createPipelineCache();
-    setupDepthStencil();
-    setupRenderPass();
-    setupFrameBuffer();
+    createTimestampQueryPool();
+    if (bindless) {
+        createBindlessTable();
+    }
+    sampleCount = getMaxUsableSampleCount();
+    setupBenchmark();
+    dynamicResolution = enableDynamicResolution;
+    setupFrameCapture();
+
+    // Window dependent objects, recreated by resumeWindow() after the window was lost
+    createSwapChain();
+    setupRenderTargets();
+    // Render passes only depend on formats and sample count and survive window loss.
+    // With dynamic rendering, attachments are passed at record time instead.
+    if (!dynamicRendering) {
+        setupRenderPass();
+        setupFrameBuffer();
+    }
+    if (dynamicResolution) {
+        setupUpscalePass();
+    }
     prepared = true;
     LOGI("Vulkan preparation complete");
 }
 
+void VulkanExampleBase::createBindlessTable() {
+    VK_CHECK_RESULT(bindlessTable.create(device, descriptorIndexingProperties, bindlessCapacity));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, bindlessTable.getSetLayout(),
+                             "bindless set layout");
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, bindlessTable.getSet(), "bindless set");
+    LOGI("Bindless table: %u textures, %u storage buffers", bindlessTable.getCapacity().textures,
+         bindlessTable.getCapacity().buffers);
+}
+
+void VulkanExampleBase::setupRenderTargets() {
+    setupDepthStencil();
+    if (sampleCount != VK_SAMPLE_COUNT_1_BIT) {
+        setupMultisampleTarget();
+    }
+    renderExtent = {width, height};
+    resolutionController.reset();
+    if (dynamicResolution) {
+        setupOffscreenTarget();
+    }
+}
+
+void VulkanExampleBase::resumeWindow() {
+    VkFormat previousColorFormat = colorFormat;
+
+    createSurface();
+    VkBool32 presentSupport = VK_FALSE;
+    VK_CHECK_RESULT(vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, queueFamilyIndex, surface,
+                                                         &presentSupport));
+    if (!presentSupport) {
+        LOGE("Graphics queue family %u cannot present to the new window", queueFamilyIndex);
+    }
+    createSwapChain();
+    if (colorFormat != previousColorFormat) {
+        // Render passes and pipelines were created for the previous format. Nothing uses
+        // them, destroyWindowResources() left the device idle.
+        LOGW("Surface format changed on resume (%d -> %d)", previousColorFormat, colorFormat);
+        if (!dynamicRendering) {
+            vkDestroyRenderPass(device, renderPass, nullptr);
+            renderPass = VK_NULL_HANDLE;
+            if (upscalePass.renderPass != VK_NULL_HANDLE) {
+                vkDestroyRenderPass(device, upscalePass.renderPass, nullptr);
+                upscalePass.renderPass = VK_NULL_HANDLE;
+            }
+            setupRenderPass();
+        }
+        if (dynamicResolution) {
+            vkDestroyPipeline(device, upscalePass.pipeline, nullptr);
+            createUpscalePipeline();
+        }
+        colorFormatChanged();
+    }
+    setupRenderTargets();
+    if (!dynamicRendering) {
+        setupFrameBuffer();
+    }
+    if (dynamicResolution) {
+        updateUpscaleDescriptorSet();
+    }
+    prepared = true;
+}
+
+void VulkanExampleBase::destroyWindowResources() {
+    // The swapchain images and targets may still be in use by submitted frames, queued
+    // presents and async compute, which the graphics timeline does not cover
+    VK_CHECK_RESULT(vkDeviceWaitIdle(device));
+    deletionQueue.collect(getCompletedTimelineValue());
+
+    for (auto &fb: frameBuffers) {
+        vkDestroyFramebuffer(device, fb, nullptr);
+    }
+    frameBuffers.clear();
+    if (offscreenTarget.frameBuffer != VK_NULL_HANDLE) {
+        vkDestroyFramebuffer(device, offscreenTarget.frameBuffer, nullptr);
+        offscreenTarget.frameBuffer = VK_NULL_HANDLE;
+    }
+
+    // Depth stencil, multisample and offscreen targets
+    auto destroyTarget = [this](VkImage &image, VkImageView &view, VkDeviceMemory &memory) {
+        if (view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, view, nullptr);
+        }
+        if (image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, image, nullptr);
+        }
+        freeMemory(memory);
+        image = VK_NULL_HANDLE;
+        view = VK_NULL_HANDLE;
+        memory = VK_NULL_HANDLE;
+    };
+    destroyTarget(depthStencil.image, depthStencil.view, depthStencil.memory);
+    destroyTarget(multisampleTarget.image, multisampleTarget.view, multisampleTarget.memory);
+    destroyTarget(offscreenTarget.image, offscreenTarget.view, offscreenTarget.memory);
+
+    // Swapchain and surface
+    for (auto &buffer: swapChainBuffers) {
+        vkDestroyImageView(device, buffer.view, nullptr);
+    }
+    swapChainBuffers.clear();
+    if (swapChain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(device, swapChain, nullptr);
+        swapChain = VK_NULL_HANDLE;
+    }
+    if (surface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+        surface = VK_NULL_HANDLE;
+    }
+}
+
 void VulkanExampleBase::cleanup() {
     prepared = false;
 }
 
 void VulkanExampleBase::prepareFrame() {
-    VK_CHECK_RESULT(vkWaitForFences(device, 1, &waitFences[currentFrame], VK_TRUE, UINT64_MAX));
-    VK_CHECK_RESULT(vkResetFences(device, 1, &waitFences[currentFrame]));
+    // Wait until the GPU is done with the last submission that used this frame slot
+    waitForTimelineValue(frameTimelineValues[currentFrame]);
+
+    // The slot's timestamps are available now, which may also pick a new render scale
+    updateGpuFrameTime();
+    updatePresentTimes();
+    deletionQueue.collect(getCompletedTimelineValue());
+    deliverReadbacks(completedTimelineValue);
+    streamTextures();
+    if (++framesSinceMemoryBudgetUpdate >= memoryBudgetInterval) {
+        updateMemoryBudget();
+    }
+    latencyFrameId = latencyTracker.beginFrame(InputQueue::nowNs());
 
     VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX,
                                             presentCompleteSemaphores[currentFrame], VK_NULL_HANDLE,
@@ -495,19 +1426,69 @@ void VulkanExampleBase::prepareFrame() {
 }
 
 void VulkanExampleBase::submitFrame() {
-    VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // Wait for the swapchain image, on the timeline for uploads not known complete and on
+    // the compute timeline for this frame's async compute work
+    std::array<VkSemaphore, 3> waitSemaphores{};
+    std::array<VkPipelineStageFlags, 3> waitStageMasks{};
+    std::array<uint64_t, 3> waitValues{};
+    uint32_t waitCount = 0;
+    auto addWait = [&](VkSemaphore semaphore, VkPipelineStageFlags stageMask, uint64_t value) {
+        waitSemaphores[waitCount] = semaphore;
+        waitStageMasks[waitCount] = stageMask;
+        waitValues[waitCount] = value;
+        waitCount++;
+    };
+    addWait(presentCompleteSemaphores[currentFrame], VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0);
+    if (timelineSemaphores && uploadTimelineValue > completedTimelineValue) {
+        addWait(timelineSemaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, uploadTimelineValue);
+    }
+    if (frameComputeWaitValue > 0) {
+        addWait(computeTimelineSemaphore, frameComputeWaitStages, frameComputeWaitValue);
+        frameComputeWaitValue = 0;
+        frameComputeWaitStages = 0;
+    }
+
+    frameTimelineValues[currentFrame] = ++timelineValue;
+    // Everything retired while recording this frame is destroyed after it completes
+    deletionQueue.stamp(timelineValue);
+    if (readbackSlot >= 0) {
+        frameReadback.endCapture(static_cast<uint32_t>(readbackSlot), timelineValue, readbackFrame);
+        readbackSlot = -1;
+    }
+
+    // The binary semaphore feeds present, the timeline semaphore tracks completion
+    std::array<VkSemaphore, 2> signalSemaphores = {renderCompleteSemaphores[currentFrame],
+                                                   timelineSemaphore};
+    std::array<uint64_t, 2> signalValues = {0, timelineValue};
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineSubmitInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
+    timelineSubmitInfo.waitSemaphoreValueCount = waitCount;
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pWaitDstStageMask = &waitStageMask;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &presentCompleteSemaphores[currentFrame];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &renderCompleteSemaphores[currentFrame];
+    submitInfo.pWaitDstStageMask = waitStageMasks.data();
+    submitInfo.waitSemaphoreCount = waitCount;
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.signalSemaphoreCount = timelineSemaphores ? 2 : 1;
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+    if (timelineSemaphores) {
+        submitInfo.pNext = &timelineSubmitInfo;
+    }
 
-    VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, waitFences[currentFrame]));
+    // Reset only once the frame is certain to be submitted, a skipped frame would leave
+    // the fence unsignaled and the next wait on this slot would never return
+    if (!timelineSemaphores) {
+        VK_CHECK_RESULT(vkResetFences(device, 1, &waitFences[currentFrame]));
+    }
+    VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo,
+                                  timelineSemaphores ? VK_NULL_HANDLE : waitFences[currentFrame]));
+    latencyTracker.markSubmitted(latencyFrameId, InputQueue::nowNs(), timelineValue);
 
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -517,56 +1498,1367 @@ void VulkanExampleBase::submitFrame() {
     presentInfo.pSwapchains = &swapChain;
     presentInfo.pImageIndices = &currentBuffer;
 
+    // Tag the present with the latency frame id to match its reported timing later
+    VkPresentTimeGOOGLE presentTime{};
+    presentTime.presentID = latencyFrameId;
+    presentTime.desiredPresentTime = 0;
+    VkPresentTimesInfoGOOGLE presentTimesInfo{};
+    presentTimesInfo.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+    presentTimesInfo.swapchainCount = 1;
+    presentTimesInfo.pTimes = &presentTime;
+    if (displayTiming) {
+        presentInfo.pNext = &presentTimesInfo;
+    }
+
     vkQueuePresentKHR(queue, &presentInfo);
 
     currentFrame = (currentFrame + 1) % MAX_CONCURRENT_FRAMES;
 }
 
-uint32_t
-VulkanExampleBase::getMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties) {
-    for (uint32_t i = 0; i < deviceMemoryProperties.memoryTypeCount; i++) {
-        if ((typeBits & 1) == 1) {
-            if ((deviceMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                return i;
-            }
-        }
-        typeBits >>= 1;
+void VulkanExampleBase::updatePresentTimes() {
+    if (!displayTiming) {
+        // Estimate: the present time of a frame is taken as the time its GPU work is
+        // seen complete, which is checked once per frame
+        latencyTracker.markCompleted(getCompletedTimelineValue(), InputQueue::nowNs());
+        return;
+    }
+
+    // Times are CLOCK_MONOTONIC on Android, the same clock as the CPU timestamps
+    uint32_t count = 0;
+    vkGetPastPresentationTimingGOOGLE(device, swapChain, &count, nullptr);
+    if (count == 0) {
+        return;
+    }
+    count = std::min(count, static_cast<uint32_t>(pastPresentationTimings.capacity()));
+    pastPresentationTimings.resize(count);
+    vkGetPastPresentationTimingGOOGLE(device, swapChain, &count, pastPresentationTimings.data());
+    for (uint32_t i = 0; i < count; i++) {
+        latencyTracker.markPresented(pastPresentationTimings[i].presentID,
+                                     static_cast<int64_t>(pastPresentationTimings[i].actualPresentTime));
     }
-    LOGE("Could not find suitable memory type!");
-    return 0;
 }
 
-VkShaderModule VulkanExampleBase::loadShader(const std::string &filename) {
-    LOGI("Loading shader: %s", filename.c_str());
+uint64_t VulkanExampleBase::submitUpload(VkCommandBuffer cmdBuffer) {
+    uint64_t value = ++timelineValue;
+    uploadTimelineValue = value;
 
-    AAsset *asset = AAssetManager_open(androidApp->activity->assetManager, filename.c_str(),
-                                       AASSET_MODE_BUFFER);
-    if (!asset) {
-        LOGE("FATAL: Could not open shader file: %s", filename.c_str());
-        LOGE("Make sure shader files are compiled and placed in assets/shaders/");
-        return VK_NULL_HANDLE;
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmdBuffer;
+
+    if (timelineSemaphores) {
+        VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo{};
+        timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineSubmitInfo.signalSemaphoreValueCount = 1;
+        timelineSubmitInfo.pSignalSemaphoreValues = &value;
+
+        submitInfo.pNext = &timelineSubmitInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &timelineSemaphore;
+
+        VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+        return value;
     }
 
-    size_t size = AAsset_getLength(asset);
-    LOGI("Shader file size: %zu bytes", size);
+    // Without timeline semaphores the upload completes synchronously
+    VkFenceCreateInfo fenceCI{};
+    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    VK_CHECK_RESULT(vkCreateFence(device, &fenceCI, nullptr, &fence));
+    VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, fence));
+    VK_CHECK_RESULT(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
+    vkDestroyFence(device, fence, nullptr);
+
+    // A fence signal covers all earlier submissions on the queue
+    completedTimelineValue = value;
+    return value;
+}
 
-    char *code = new char[size];
-    AAsset_read(asset, code, size);
-    AAsset_close(asset);
+void VulkanExampleBase::retireResource(DeletionQueue::Deleter deleter) {
+    deletionQueue.retire(std::move(deleter));
+}
+
+void VulkanExampleBase::retireResource(uint64_t timelineValue, DeletionQueue::Deleter deleter) {
+    deletionQueue.retire(timelineValue, std::move(deleter));
+}
+
+void VulkanExampleBase::retireBuffer(VkBuffer buffer, VkDeviceMemory memory, uint64_t timelineValue) {
+    auto deleter = [this, buffer, memory]() {
+        if (buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, buffer, nullptr);
+        }
+        freeMemory(memory);
+    };
+    if (timelineValue != 0) {
+        retireResource(timelineValue, deleter);
+    } else {
+        retireResource(deleter);
+    }
+}
+
+void VulkanExampleBase::retireImage(VkImage image, VkImageView view, VkDeviceMemory memory) {
+    retireResource([this, image, view, memory]() {
+        if (view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, view, nullptr);
+        }
+        if (image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, image, nullptr);
+        }
+        freeMemory(memory);
+    });
+}
+
+void VulkanExampleBase::retirePipeline(VkPipeline pipeline) {
+    if (pipeline == VK_NULL_HANDLE) {
+        return;
+    }
+    retireResource([this, pipeline]() {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    });
+}
+
+bool VulkanExampleBase::formatSupportsSampling(VkFormat format) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+                                          VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+bool VulkanExampleBase::loadTexture(const std::string &name, Texture &texture) {
+    // One representative format per family tells which files are worth trying first
+    const std::vector<TextureFormats::Family> loadOrder = TextureFormats::getLoadOrder(
+            formatSupportsSampling(VK_FORMAT_ASTC_4x4_UNORM_BLOCK),
+            formatSupportsSampling(VK_FORMAT_BC3_UNORM_BLOCK),
+            formatSupportsSampling(VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK));
+
+    for (TextureFormats::Family family: loadOrder) {
+        const std::string path = "textures/" + name + TextureFormats::getFileSuffix(family);
+        std::vector<char> data;
+        if (!readAsset(path, data)) {
+            continue;
+        }
+        Ktx2 file;
+        std::string error;
+        if (!Ktx2::parse(reinterpret_cast<const uint8_t *>(data.data()), data.size(), file, error)) {
+            LOGW("Skipping texture %s: %s", path.c_str(), error.c_str());
+            continue;
+        }
+
+        VkFormat format = file.format;
+        bool decoded = false;
+        if (!formatSupportsSampling(format)) {
+            format = TextureFormats::getDecodedFormat(file.format);
+            if (format == VK_FORMAT_UNDEFINED || !formatSupportsSampling(format)) {
+                LOGW("Skipping texture %s: format %d not supported", path.c_str(), file.format);
+                continue;
+            }
+            decoded = true;
+        }
+
+        // Files with only a base level get their mips generated on the GPU
+        uint32_t levelCount = file.levelCount;
+        if (file.generateMips) {
+            MipGenerator::Method method = mipGenerator.selectMethod(format);
+            if (method != MipGenerator::Method::None) {
+                levelCount = MipGenerator::getFullLevelCount(file.width, file.height);
+            } else {
+                LOGW("Texture %s: no mip generation for format %d, base level only", path.c_str(), format);
+            }
+        }
+
+        texture.name = name;
+        texture.format = format;
+        texture.width = file.width;
+        texture.height = file.height;
+        texture.levelCount = levelCount;
+        texture.decoded = decoded;
+        texture.fileData = std::move(data);
+        texture.file = file;
+        createTextureImage(texture);
+
+        // Upload sizes, which for decoded textures are the RGBA8 sizes
+        std::vector<uint64_t> levelSizes(file.levelCount);
+        for (uint32_t level = 0; level < file.levelCount; level++) {
+            levelSizes[level] = decoded ? TextureFormats::getLevelSize(format, std::max(file.width >> level, 1u),
+                                                                       std::max(file.height >> level, 1u))
+                                        : file.levels[level].length;
+        }
+        texture.streamer.start(levelSizes);
+
+        uint32_t firstLevel;
+        uint32_t batchLevelCount;
+        texture.streamer.nextBatch(textureInitialBudget, completedTimelineValue, firstLevel, batchLevelCount);
+        uploadTextureLevels(texture, firstLevel, batchLevelCount);
+        if (texture.streamer.complete()) {
+            texture.fileData.clear();
+            texture.fileData.shrink_to_fit();
+        } else {
+            streamingTextures.push_back(&texture);
+        }
+
+        LOGI("Texture %s: %ux%u, %u levels%s, %s%s, %u levels streaming", path.c_str(), texture.width,
+             texture.height, texture.levelCount, texture.levelCount > file.levelCount ? " generated" : "",
+             TextureFormats::getFamilyName(family), decoded ? " decoded to RGBA8" : "",
+             texture.streamer.getResidentLevel());
+        return true;
+    }
+    LOGE("No loadable variant of texture %s", name.c_str());
+    return false;
+}
+
+void VulkanExampleBase::createSolidTexture(const std::string &name, const std::array<uint8_t, 4> &rgba,
+                                           Texture &texture) {
+    createTexture(name, VK_FORMAT_R8G8B8A8_UNORM, 1, 1, rgba.data(), rgba.size(), texture);
+}
+
+bool VulkanExampleBase::createTexture(const std::string &name, VkFormat format, uint32_t width, uint32_t height,
+                                      const void *pixels, size_t size, Texture &texture) {
+    if (!formatSupportsSampling(format) || TextureFormats::getLevelSize(format, width, height) != size) {
+        LOGE("Texture %s: format %d with %zu bytes for %ux%u not supported", name.c_str(), format, size,
+             width, height);
+        return false;
+    }
+
+    // Same path as a file with only a base level: uploaded once, the chain generated from it
+    uint32_t levelCount = 1;
+    const MipGenerator::Method method = mipGenerator.selectMethod(format);
+    if (method != MipGenerator::Method::None) {
+        levelCount = MipGenerator::getFullLevelCount(width, height);
+    }
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(pixels);
+    texture.name = name;
+    texture.format = format;
+    texture.width = width;
+    texture.height = height;
+    texture.levelCount = levelCount;
+    texture.decoded = false;
+    texture.fileData.assign(bytes, bytes + size);
+    texture.file = Ktx2();
+    texture.file.format = format;
+    texture.file.width = width;
+    texture.file.height = height;
+    texture.file.levelCount = 1;
+    texture.file.levels = {{0, size}};
+    createTextureImage(texture);
+
+    texture.streamer.start({size});
+    uploadTextureLevels(texture, 0, 1);
+    texture.fileData.clear();
+    texture.fileData.shrink_to_fit();
+    if (levelCount > 1) {
+        LOGI("Texture %s: %ux%u, %u levels generated (%s)", name.c_str(), width, height, levelCount,
+             MipGenerator::getMethodName(method));
+    }
+    return true;
+}
+
+void VulkanExampleBase::destroyTexture(Texture &texture) {
+    streamingTextures.erase(std::remove(streamingTextures.begin(), streamingTextures.end(), &texture),
+                            streamingTextures.end());
+    retireImage(texture.image, texture.view, texture.memory);
+    if (texture.bindlessHandle != BindlessTable::INVALID_HANDLE) {
+        // Frames in flight may still index the handle
+        retireResource([this, handle = texture.bindlessHandle]() {
+            bindlessTable.removeTexture(handle);
+        });
+        texture.bindlessHandle = BindlessTable::INVALID_HANDLE;
+    }
+    texture.image = VK_NULL_HANDLE;
+    texture.view = VK_NULL_HANDLE;
+    texture.memory = VK_NULL_HANDLE;
+    texture.sampler = VK_NULL_HANDLE;
+    texture.fileData.clear();
+}
+
+void VulkanExampleBase::createTextureImage(Texture &texture) {
+    // Full mip chain up front; levels not uploaded yet are never sampled
+    VkImageCreateInfo imageCI{};
+    imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCI.imageType = VK_IMAGE_TYPE_2D;
+    imageCI.format = texture.format;
+    imageCI.extent = {texture.width, texture.height, 1};
+    imageCI.mipLevels = texture.levelCount;
+    imageCI.arrayLayers = 1;
+    imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (texture.levelCount > texture.file.levelCount) {
+        imageCI.usage |= MipGenerator::getRequiredUsage(mipGenerator.selectMethod(texture.format));
+    }
+    imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VK_CHECK_RESULT(vkCreateImage(device, &imageCI, nullptr, &texture.image));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE, texture.image, "texture %s", texture.name.c_str());
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, texture.image, &memReqs);
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = memReqs.size;
+    memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Image, &texture.memory));
+    VK_CHECK_RESULT(vkBindImageMemory(device, texture.image, texture.memory, 0));
+
+    VkImageViewCreateInfo viewCI{};
+    viewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewCI.image = texture.image;
+    viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewCI.format = texture.format;
+    viewCI.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.levelCount, 0, 1};
+    VK_CHECK_RESULT(vkCreateImageView(device, &viewCI, nullptr, &texture.view));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, texture.view, "texture %s view", texture.name.c_str());
+
+    VkSamplerCreateInfo samplerCI{};
+    samplerCI.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCI.magFilter = VK_FILTER_LINEAR;
+    samplerCI.minFilter = VK_FILTER_LINEAR;
+    samplerCI.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerCI.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCI.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCI.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCI.maxLod = static_cast<float>(texture.levelCount);
+    samplerCI.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    VK_CHECK_RESULT(samplerCache.get(samplerCI, &texture.sampler));
+
+    // Unwritten levels are never sampled, so the view can be registered before the upload
+    if (bindless) {
+        texture.bindlessHandle = bindlessTable.addTexture(texture.view, texture.sampler,
+                                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        if (texture.bindlessHandle == BindlessTable::INVALID_HANDLE) {
+            LOGW("Bindless texture array full, texture %s has no handle", texture.name.c_str());
+        }
+    }
+}
+
+VkDeviceSize VulkanExampleBase::uploadTextureLevels(Texture &texture, uint32_t firstLevel, uint32_t levelCount) {
+    const uint32_t endLevel = firstLevel + levelCount;
+    const bool firstUpload = endLevel == texture.file.levelCount;
+
+    // Levels packed into one staging buffer, offsets aligned for any block size
+    std::vector<VkBufferImageCopy> regions(levelCount);
+    VkDeviceSize stagingSize = 0;
+    for (uint32_t level = firstLevel; level < endLevel; level++) {
+        const uint32_t width = std::max(texture.width >> level, 1u);
+        const uint32_t height = std::max(texture.height >> level, 1u);
+        VkBufferImageCopy &region = regions[level - firstLevel];
+        region.bufferOffset = stagingSize;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        region.imageExtent = {width, height, 1};
+        stagingSize += (TextureFormats::getLevelSize(texture.format, width, height) + 15) & ~VkDeviceSize(15);
+    }
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    VkBufferCreateInfo bufferCI{};
+    bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCI.size = stagingSize;
+    bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCI, nullptr, &stagingBuffer));
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(device, stagingBuffer, &memReqs);
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = memReqs.size;
+    memAlloc.memoryTypeIndex = getMemoryTypeIndex(memReqs.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    VK_CHECK_RESULT(allocateMemory(memAlloc, MemoryCategory::Staging, &stagingMemory));
+    VK_CHECK_RESULT(vkBindBufferMemory(device, stagingBuffer, stagingMemory, 0));
+
+    // Copy, or decode on the CPU, straight into the mapped staging memory
+    uint8_t *mapped;
+    VK_CHECK_RESULT(vkMapMemory(device, stagingMemory, 0, stagingSize, 0, (void **) &mapped));
+    const uint8_t *fileData = reinterpret_cast<const uint8_t *>(texture.fileData.data());
+    for (uint32_t level = firstLevel; level < endLevel; level++) {
+        const VkBufferImageCopy &region = regions[level - firstLevel];
+        const Ktx2::Level &source = texture.file.levels[level];
+        if (texture.decoded) {
+            TextureFormats::decode(texture.file.format, fileData + source.offset, source.length,
+                                   region.imageExtent.width, region.imageExtent.height,
+                                   mapped + region.bufferOffset);
+        } else {
+            memcpy(mapped + region.bufferOffset, fileData + source.offset, source.length);
+        }
+    }
+    vkUnmapMemory(device, stagingMemory);
+
+    VkCommandBuffer copyCmd;
+    VkCommandBufferAllocateInfo cmdBufAllocInfo{};
+    cmdBufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufAllocInfo.commandPool = commandPool;
+    cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufAllocInfo.commandBufferCount = 1;
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &cmdBufAllocInfo, &copyCmd));
+
+    VkCommandBufferBeginInfo cmdBufBeginInfo{};
+    cmdBufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(copyCmd, &cmdBufBeginInfo));
+    debugUtils.beginLabel(copyCmd, "upload texture", 0.4f, 1.0f, 0.4f);
+
+    // The first upload also gives the finer levels, not written yet, a layout the image
+    // view can be used in. Their contents are undefined until uploaded, which is fine
+    // as long as the LOD is clamped to the resident level.
+    if (firstUpload && firstLevel > 0) {
+        setImageLayout(copyCmd, texture.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                       {VK_IMAGE_ASPECT_COLOR_BIT, 0, firstLevel, 0, 1},
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+    // Levels being uploaded were never sampled, so their old contents are discarded
+    const VkImageSubresourceRange range = {VK_IMAGE_ASPECT_COLOR_BIT, firstLevel, levelCount, 0, 1};
+    setImageLayout(copyCmd, texture.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, range,
+                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    vkCmdCopyBufferToImage(copyCmd, stagingBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    if (texture.levelCount > texture.file.levelCount) {
+        // Only the base level comes from the file, the rest of the chain is generated from it
+        MipGenerator::Image image;
+        image.image = texture.image;
+        image.format = texture.format;
+        image.width = texture.width;
+        image.height = texture.height;
+        image.levelCount = texture.levelCount;
+        generateMipmaps(copyCmd, image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    } else {
+        setImageLayout(copyCmd, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, range,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+    debugUtils.endLabel(copyCmd);
+    VK_CHECK_RESULT(vkEndCommandBuffer(copyCmd));
+
+    // Frames submitted from now on wait for the upload, so the new levels are resident
+    // for them right away
+    uint64_t uploadValue = submitUpload(copyCmd);
+    retireResource(uploadValue, [this, copyCmd]() {
+        vkFreeCommandBuffers(device, commandPool, 1, &copyCmd);
+    });
+    retireBuffer(stagingBuffer, stagingMemory, uploadValue);
+    texture.streamer.submitted(firstLevel, uploadValue);
+    return stagingSize;
+}
+
+void VulkanExampleBase::streamTextures() {
+    VkDeviceSize budget = textureStreamBudget;
+    for (Texture *texture: streamingTextures) {
+        uint32_t firstLevel;
+        uint32_t levelCount;
+        if (budget == 0) {
+            break;
+        }
+        if (!texture->streamer.nextBatch(budget, completedTimelineValue, firstLevel, levelCount)) {
+            continue;
+        }
+        budget -= std::min(budget, uploadTextureLevels(*texture, firstLevel, levelCount));
+        if (texture->streamer.complete()) {
+            LOGI("Texture %s fully resident", texture->name.c_str());
+            texture->fileData.clear();
+            texture->fileData.shrink_to_fit();
+        }
+    }
+    streamingTextures.erase(std::remove_if(streamingTextures.begin(), streamingTextures.end(),
+                                           [](const Texture *texture) { return texture->streamer.complete(); }),
+                            streamingTextures.end());
+}
+
+void VulkanExampleBase::generateMipmaps(VkCommandBuffer cmdBuffer, const MipGenerator::Image &image,
+                                        VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask,
+                                        VkAccessFlags dstAccessMask) {
+    const MipGenerator::Method method = mipGenerator.selectMethod(image.format);
+    assert(method != MipGenerator::Method::None);
+    debugUtils.beginLabel(cmdBuffer, "generate mipmaps", 0.4f, 0.8f, 1.0f);
+    if (method == MipGenerator::Method::Blit) {
+        mipGenerator.recordBlit(cmdBuffer, image, finalLayout, dstStageMask, dstAccessMask);
+    } else {
+        // Created on first use, most devices never need it
+        if (!mipGenerator.hasComputePipeline()) {
+            VkShaderModule shaderModule = loadShader("shaders/mipmap.comp.spv");
+            VK_CHECK_RESULT(mipGenerator.createComputePipeline(shaderModule, pipelineCache));
+            vkDestroyShaderModule(device, shaderModule, nullptr);
+        }
+        // Views and descriptors live until the commands have run; retiring without a
+        // value covers uploads too, as the next frame waits for them
+        MipGenerator::Transient transient;
+        VK_CHECK_RESULT(mipGenerator.recordCompute(cmdBuffer, image, finalLayout, dstStageMask, dstAccessMask,
+                                                   transient));
+        retireResource([this, transient]() {
+            mipGenerator.destroyTransient(transient);
+        });
+    }
+    debugUtils.endLabel(cmdBuffer);
+}
+
+void VulkanExampleBase::waitForTimelineValue(uint64_t value) {
+    if (value <= completedTimelineValue) {
+        return;
+    }
+
+    if (timelineSemaphores) {
+        VkSemaphoreWaitInfoKHR waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timelineSemaphore;
+        waitInfo.pValues = &value;
+        VK_CHECK_RESULT(vkWaitSemaphoresKHR(device, &waitInfo, UINT64_MAX));
+    } else {
+        for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+            if (frameTimelineValues[i] > completedTimelineValue && frameTimelineValues[i] <= value) {
+                VK_CHECK_RESULT(vkWaitForFences(device, 1, &waitFences[i], VK_TRUE, UINT64_MAX));
+            }
+        }
+    }
+    completedTimelineValue = value;
+}
+
+uint64_t VulkanExampleBase::getCompletedTimelineValue() {
+    if (timelineSemaphores) {
+        uint64_t value = 0;
+        VK_CHECK_RESULT(vkGetSemaphoreCounterValueKHR(device, timelineSemaphore, &value));
+        completedTimelineValue = std::max(completedTimelineValue, value);
+        return completedTimelineValue;
+    }
+
+    // Fence fallback: completed up to the oldest frame that is still pending
+    uint64_t newestSignaled = completedTimelineValue;
+    uint64_t oldestPending = UINT64_MAX;
+    for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+        if (frameTimelineValues[i] <= completedTimelineValue) {
+            continue;
+        }
+        if (vkGetFenceStatus(device, waitFences[i]) == VK_SUCCESS) {
+            newestSignaled = std::max(newestSignaled, frameTimelineValues[i]);
+        } else {
+            oldestPending = std::min(oldestPending, frameTimelineValues[i]);
+        }
+    }
+    completedTimelineValue = std::max(completedTimelineValue,
+                                      std::min(newestSignaled, oldestPending - 1));
+    return completedTimelineValue;
+}
+
+VkCommandBuffer VulkanExampleBase::beginComputeCommands() {
+    // The frame's graphics work waited for this slot's last compute submission, which
+    // prepareFrame() has seen complete, so this normally returns at once
+    uint64_t slotValue = computeFrameTimelineValues[currentFrame];
+    if (asyncCompute && slotValue > 0) {
+        VkSemaphoreWaitInfoKHR waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &computeTimelineSemaphore;
+        waitInfo.pValues = &slotValue;
+        VK_CHECK_RESULT(vkWaitSemaphoresKHR(device, &waitInfo, UINT64_MAX));
+    }
+
+    VkCommandBuffer cmdBuffer = computeCommandBuffers[currentFrame];
+    VK_CHECK_RESULT(vkResetCommandBuffer(cmdBuffer, 0));
+    VkCommandBufferBeginInfo cmdBufBeginInfo{};
+    cmdBufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &cmdBufBeginInfo));
+    return cmdBuffer;
+}
+
+void VulkanExampleBase::submitCompute(VkCommandBuffer cmdBuffer,
+                                      VkPipelineStageFlags graphicsWaitStages,
+                                      uint64_t graphicsValue) {
+    // The frame's submission waits on the compute timeline with these stages, a wait
+    // with an empty stage mask is invalid
+    assert(graphicsWaitStages != 0);
+    if (graphicsWaitStages == 0) {
+        LOGE("submitCompute: empty graphics wait stage mask, waiting at all commands");
+        graphicsWaitStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmdBuffer));
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmdBuffer;
+
+    if (!asyncCompute) {
+        // Same queue as the frame: submission order plus the barriers recorded in the
+        // frame (see acquireBuffer()) order the work, and the frame's completion covers it
+        VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+        return;
+    }
+
+    uint64_t value = ++computeTimelineValue;
+    computeFrameTimelineValues[currentFrame] = value;
+    const bool waitForGraphics = graphicsValue > completedTimelineValue;
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineSubmitInfo.waitSemaphoreValueCount = waitForGraphics ? 1 : 0;
+    timelineSubmitInfo.pWaitSemaphoreValues = &graphicsValue;
+    timelineSubmitInfo.signalSemaphoreValueCount = 1;
+    timelineSubmitInfo.pSignalSemaphoreValues = &value;
+
+    submitInfo.pNext = &timelineSubmitInfo;
+    if (waitForGraphics) {
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &timelineSemaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+    }
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &computeTimelineSemaphore;
+    VK_CHECK_RESULT(vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+    frameComputeWaitValue = value;
+    frameComputeWaitStages |= graphicsWaitStages;
+}
+
+void VulkanExampleBase::releaseBuffer(VkCommandBuffer cmdBuffer, const BufferHandoff &handoff) {
+    if (handoff.srcQueueFamily == handoff.dstQueueFamily) {
+        return;
+    }
+    // Release: source access only, the destination half is ignored
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = handoff.srcAccessMask;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = handoff.srcQueueFamily;
+    barrier.dstQueueFamilyIndex = handoff.dstQueueFamily;
+    barrier.buffer = handoff.buffer;
+    barrier.offset = handoff.offset;
+    barrier.size = handoff.size;
+    vkCmdPipelineBarrier(cmdBuffer, handoff.srcStageMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                         0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void VulkanExampleBase::acquireBuffer(VkCommandBuffer cmdBuffer, const BufferHandoff &handoff) {
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.buffer = handoff.buffer;
+    barrier.offset = handoff.offset;
+    barrier.size = handoff.size;
+    barrier.dstAccessMask = handoff.dstAccessMask;
+
+    if (handoff.srcQueueFamily == handoff.dstQueueFamily) {
+        // Same family: an ordinary barrier from the writes to the reads
+        barrier.srcAccessMask = handoff.srcAccessMask;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vkCmdPipelineBarrier(cmdBuffer, handoff.srcStageMask, handoff.dstStageMask, 0,
+                             0, nullptr, 1, &barrier, 0, nullptr);
+        return;
+    }
+
+    // Acquire: the semaphore wait provides the dependency on the release
+    barrier.srcAccessMask = 0;
+    barrier.srcQueueFamilyIndex = handoff.srcQueueFamily;
+    barrier.dstQueueFamilyIndex = handoff.dstQueueFamily;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, handoff.dstStageMask, 0,
+                         0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void VulkanExampleBase::beginRendering(VkCommandBuffer cmdBuffer,
+                                       const std::array<VkClearValue, 2> &clearValues) {
+    const bool multisampled = sampleCount != VK_SAMPLE_COUNT_1_BIT;
+
+    // Label region closed in endRendering()
+    debugUtils.beginLabel(cmdBuffer, "scene", 0.2f, 0.6f, 1.0f);
+
+    if (!dynamicRendering) {
+        VkRenderPassBeginInfo renderPassBeginInfo{};
+        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassBeginInfo.renderPass = renderPass;
+        renderPassBeginInfo.framebuffer = dynamicResolution ? offscreenTarget.frameBuffer
+                                                            : frameBuffers[currentBuffer];
+        renderPassBeginInfo.renderArea.extent = renderExtent;
+        renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+        renderPassBeginInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    // Single sampled target: the swapchain image, or the offscreen target with dynamic resolution
+    VkImage targetImage = dynamicResolution ? offscreenTarget.image
+                                            : swapChainBuffers[currentBuffer].image;
+    VkImageView targetView = dynamicResolution ? offscreenTarget.view
+                                               : swapChainBuffers[currentBuffer].view;
+
+    // Without a render pass the layout transitions and the dependencies on the
+    // previous frame's use of the shared depth/MSAA images are recorded explicitly
+    VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (depthFormat >= VK_FORMAT_D16_UNORM_S8_UINT) {
+        depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+
+    std::vector<VkImageMemoryBarrier> barriers;
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.image = targetImage;
+    barriers.push_back(barrier);
+
+    if (multisampled) {
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.image = multisampleTarget.image;
+        barriers.push_back(barrier);
+    }
+
+    barrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barrier.image = depthStencil.image;
+    barrier.subresourceRange.aspectMask = depthAspect;
+    barriers.push_back(barrier);
+
+    VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    if (dynamicResolution) {
+        // The offscreen target may still be sampled by the previous frame's upscale
+        srcStageMask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+
+    vkCmdPipelineBarrier(cmdBuffer,
+                         srcStageMask,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                         0, 0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    VkRenderingAttachmentInfoKHR colorAttachment{};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.clearValue = clearValues[0];
+    if (multisampled) {
+        colorAttachment.imageView = multisampleTarget.view;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT_KHR;
+        colorAttachment.resolveImageView = targetView;
+        colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    } else {
+        colorAttachment.imageView = targetView;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    }
+
+    VkRenderingAttachmentInfoKHR depthStencilAttachment{};
+    depthStencilAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depthStencilAttachment.imageView = depthStencil.view;
+    depthStencilAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthStencilAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthStencilAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthStencilAttachment.clearValue = clearValues[1];
+
+    VkRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.renderArea.extent = renderExtent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = &depthStencilAttachment;
+    if (depthAspect & VK_IMAGE_ASPECT_STENCIL_BIT) {
+        renderingInfo.pStencilAttachment = &depthStencilAttachment;
+    }
+
+    vkCmdBeginRenderingKHR(cmdBuffer, &renderingInfo);
+}
+
+void VulkanExampleBase::endRendering(VkCommandBuffer cmdBuffer) {
+    if (!dynamicRendering) {
+        vkCmdEndRenderPass(cmdBuffer);
+    } else {
+        vkCmdEndRenderingKHR(cmdBuffer);
+
+        if (dynamicResolution) {
+            setImageLayout(cmdBuffer, offscreenTarget.image,
+                           VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+                           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        } else {
+            setImageLayout(cmdBuffer, swapChainBuffers[currentBuffer].image,
+                           VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                           VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                           {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+                           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                           VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        }
+    }
+    debugUtils.endLabel(cmdBuffer);
+
+    if (dynamicResolution) {
+        recordUpscalePass(cmdBuffer);
+    }
+    // Every path leaves the swapchain image ready to present, through a transition whose
+    // second scope is bottom of pipe with the writes already made available. Only all
+    // commands chains onto that, so the transition to transfer source waits for it.
+    if (swapchainReadback) {
+        readbackImage(cmdBuffer, swapChainBuffers[currentBuffer].image,
+                      VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, colorFormat, {width, height},
+                      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0);
+    }
+}
+
+void VulkanExampleBase::recordUpscalePass(VkCommandBuffer cmdBuffer) {
+    DebugUtils::LabelScope label(debugUtils, cmdBuffer, "upscale", 1.0f, 0.6f, 0.2f);
+    VkImage swapChainImage = swapChainBuffers[currentBuffer].image;
+
+    if (!dynamicRendering) {
+        VkRenderPassBeginInfo renderPassBeginInfo{};
+        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassBeginInfo.renderPass = upscalePass.renderPass;
+        renderPassBeginInfo.framebuffer = frameBuffers[currentBuffer];
+        renderPassBeginInfo.renderArea.extent = {width, height};
+        vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    } else {
+        setImageLayout(cmdBuffer, swapChainImage,
+                       VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                       {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+        VkRenderingAttachmentInfoKHR colorAttachment{};
+        colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        colorAttachment.imageView = swapChainBuffers[currentBuffer].view;
+        colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+        VkRenderingInfoKHR renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        renderingInfo.renderArea.extent = {width, height};
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachments = &colorAttachment;
+        vkCmdBeginRenderingKHR(cmdBuffer, &renderingInfo);
+    }
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(width);
+    viewport.height = static_cast<float>(height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = {width, height};
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+    // Map the full screen onto the rendered sub-rectangle of the offscreen target
+    float pushConstants[4] = {
+            static_cast<float>(renderExtent.width) / static_cast<float>(width),
+            static_cast<float>(renderExtent.height) / static_cast<float>(height),
+            (static_cast<float>(renderExtent.width) - 0.5f) / static_cast<float>(width),
+            (static_cast<float>(renderExtent.height) - 0.5f) / static_cast<float>(height)
+    };
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, upscalePass.pipeline);
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, upscalePass.pipelineLayout,
+                            0, 1, &upscalePass.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(cmdBuffer, upscalePass.pipelineLayout,
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(pushConstants), pushConstants);
+    vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
+
+    if (!dynamicRendering) {
+        vkCmdEndRenderPass(cmdBuffer);
+    } else {
+        vkCmdEndRenderingKHR(cmdBuffer);
+        setImageLayout(cmdBuffer, swapChainImage,
+                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                       {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+}
+
+bool VulkanExampleBase::readbackImage(VkCommandBuffer cmdBuffer, VkImage image,
+                                      VkImageLayout layout, VkFormat format, VkExtent2D extent,
+                                      VkPipelineStageFlags srcStageMask,
+                                      VkAccessFlags srcAccessMask) {
+    FrameReadback::PixelFormat pixelFormat;
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            pixelFormat = FrameReadback::PixelFormat::RGBA8;
+            break;
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            pixelFormat = FrameReadback::PixelFormat::BGRA8;
+            break;
+        default:
+            return false;
+    }
+    if (readbackSlot >= 0) {
+        return false;
+    }
+    int32_t slot = frameReadback.beginCapture();
+    if (slot < 0) {
+        return false;
+    }
+
+    ReadbackBuffer &buffer = readbackBuffers[slot];
+    VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    if (buffer.size < size) {
+        // A free slot is neither in flight nor being written, so its buffer can go now
+        if (buffer.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, buffer.buffer, nullptr);
+            freeMemory(buffer.memory);
+            buffer = {};
+        }
+        if (!createReadbackBuffer(buffer, size)) {
+            LOGE("Failed to create a %llu byte readback buffer", static_cast<unsigned long long>(size));
+            frameReadback.cancelCapture(static_cast<uint32_t>(slot));
+            return false;
+        }
+    }
+
+    DebugUtils::LabelScope label(debugUtils, cmdBuffer, "readback", 0.6f, 0.6f, 0.6f);
+
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = srcAccessMask;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.oldLayout = layout;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = image;
+    imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(cmdBuffer, srcStageMask, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyImageToBuffer(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer.buffer,
+                           1, &region);
+
+    // Back to the original layout for present or later passes, and the copy made
+    // available to the host once the frame's timeline value is reached
+    imageBarrier.srcAccessMask = 0;
+    imageBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.newLayout = layout;
+
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = buffer.buffer;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         0, nullptr, 1, &bufferBarrier, 1, &imageBarrier);
+
+    readbackFrame.frameNumber = renderLoopStats.frames;
+    readbackFrame.width = extent.width;
+    readbackFrame.height = extent.height;
+    readbackFrame.rowPitch = extent.width * 4;
+    readbackFrame.format = pixelFormat;
+    readbackFrame.pixels = buffer.mapped;
+    readbackSlot = slot;
+    return true;
+}
+
+void VulkanExampleBase::deliverReadbacks(uint64_t completedValue) {
+    frameReadback.deliverCompleted(completedValue, [this](uint32_t slot) {
+        // Host cached memory has to pull the GPU writes into the CPU caches first
+        const ReadbackBuffer &buffer = readbackBuffers[slot];
+        if (!buffer.coherent) {
+            VkMappedMemoryRange range{};
+            range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = buffer.memory;
+            range.size = VK_WHOLE_SIZE;
+            VK_CHECK_RESULT(vkInvalidateMappedMemoryRanges(device, 1, &range));
+        }
+    });
+}
+
+bool VulkanExampleBase::createReadbackBuffer(ReadbackBuffer &buffer, VkDeviceSize size) {
+    VkBufferCreateInfo bufferCI{};
+    bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCI.size = size;
+    bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCI, nullptr, &buffer.buffer));
+
+    // The CPU reads every byte, so cached memory is preferred over coherent memory
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(device, buffer.buffer, &memReqs);
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = memReqs.size;
+    bool found = getMemoryTypeIndex(memReqs.memoryTypeBits,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                    VK_MEMORY_PROPERTY_HOST_CACHED_BIT, &memAlloc.memoryTypeIndex) ||
+                 getMemoryTypeIndex(memReqs.memoryTypeBits,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &memAlloc.memoryTypeIndex);
+    if (!found || allocateMemory(memAlloc, MemoryCategory::Readback, &buffer.memory) != VK_SUCCESS) {
+        vkDestroyBuffer(device, buffer.buffer, nullptr);
+        buffer = {};
+        return false;
+    }
+    VK_CHECK_RESULT(vkBindBufferMemory(device, buffer.buffer, buffer.memory, 0));
+
+    void *data = nullptr;
+    VK_CHECK_RESULT(vkMapMemory(device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &data));
+    buffer.mapped = static_cast<uint8_t *>(data);
+    buffer.size = size;
+    buffer.coherent = (deviceMemoryProperties.memoryTypes[memAlloc.memoryTypeIndex].propertyFlags &
+                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    debugUtils.setObjectName(VK_OBJECT_TYPE_BUFFER, buffer.buffer, "readback buffer");
+    return true;
+}
+
+void VulkanExampleBase::setupFrameCapture() {
+    // adb shell setprop debug.vulkan.capture <frames> writes that many presented frames as
+    // PPM files to <internal data path>/captures
+    char value[PROP_VALUE_MAX] = {};
+    if (__system_property_get("debug.vulkan.capture", value) <= 0) {
+        return;
+    }
+    unsigned long frames = strtoul(value, nullptr, 10);
+    if (frames == 0) {
+        return;
+    }
+    std::string directory = std::string(androidApp->activity->internalDataPath) + "/captures";
+    mkdir(directory.c_str(), 0755);
+
+    enableSwapchainReadback = true;
+    frameReadback.setOutputDirectory(directory, FrameReadback::FileFormat::Ppm);
+    frameReadback.request(static_cast<uint32_t>(std::min<unsigned long>(frames, UINT32_MAX)));
+    LOGI("Capturing %lu frames to %s", frames, directory.c_str());
+}
+
+void VulkanExampleBase::setupBenchmark() {
+    // adb shell setprop debug.vulkan.benchmark <scenario>, optionally with
+    // debug.vulkan.benchmark.frames <measured frames>
+    char value[PROP_VALUE_MAX] = {};
+    if (__system_property_get("debug.vulkan.benchmark", value) <= 0) {
+        return;
+    }
+    FrameBenchmark::Config config;
+    config.scenario = value;
+    if (__system_property_get("debug.vulkan.benchmark.frames", value) > 0) {
+        unsigned long frames = strtoul(value, nullptr, 10);
+        if (frames > 0) {
+            config.measuredFrames = static_cast<uint32_t>(std::min<unsigned long>(frames, 100000));
+        }
+    }
+
+    // Same workload every frame: no pacing, no resolution changes
+    frameRateLimit = 0;
+    renderMode = RenderMode::Continuous;
+    enableDynamicResolution = false;
+    frameBenchmark.start(config);
+    LOGI("Benchmark %s: %u warmup and %u measured frames", config.scenario.c_str(),
+         config.warmupFrames, config.measuredFrames);
+}
+
+void VulkanExampleBase::finishBenchmark() {
+    // The last GPU samples arrive once their frame slots are reused
+    waitForTimelineValue(timelineValue);
+    for (uint32_t i = 0; i < MAX_CONCURRENT_FRAMES; i++) {
+        updateGpuFrameTime();
+        currentFrame = (currentFrame + 1) % MAX_CONCURRENT_FRAMES;
+    }
+
+    const FrameBenchmark::Config &config = frameBenchmark.getConfig();
+    FrameBenchmark::DeviceInfo deviceInfo;
+    deviceInfo.deviceName = deviceProperties.deviceName;
+    deviceInfo.driverVersion = deviceProperties.driverVersion;
+    deviceInfo.width = width;
+    deviceInfo.height = height;
+    std::string path = std::string(androidApp->activity->internalDataPath) + "/benchmark_" +
+                       config.scenario + ".json";
+    if (frameBenchmark.writeJson(path, deviceInfo)) {
+        LOGI("Benchmark %s complete, results written to %s", config.scenario.c_str(), path.c_str());
+    } else {
+        LOGE("Failed to write benchmark results to %s", path.c_str());
+    }
+    frameBenchmark.stop();
+    GameActivity_finish(androidApp->activity);
+}
+
+void VulkanExampleBase::beginGpuFrameTimer(VkCommandBuffer cmdBuffer) {
+    if (!gpuTimestamps) {
+        return;
+    }
+    vkCmdResetQueryPool(cmdBuffer, timestampQueryPool, currentFrame * 2, 2);
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool,
+                        currentFrame * 2);
+}
+
+void VulkanExampleBase::endGpuFrameTimer(VkCommandBuffer cmdBuffer) {
+    if (!gpuTimestamps) {
+        return;
+    }
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool,
+                        currentFrame * 2 + 1);
+    timestampsWritten[currentFrame] = true;
+}
+
+void VulkanExampleBase::updateGpuFrameTime() {
+    // Only called once the frame slot's last submission has completed, so this never waits
+    if (!gpuTimestamps || !timestampsWritten[currentFrame]) {
+        return;
+    }
+    timestampsWritten[currentFrame] = false;
+
+    std::array<uint64_t, 2> timestamps{};
+    VkResult result = vkGetQueryPoolResults(device, timestampQueryPool, currentFrame * 2, 2,
+                                            sizeof(timestamps), timestamps.data(),
+                                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return;
+    }
+
+    uint64_t mask = timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1;
+    uint64_t elapsed = ((timestamps[1] & mask) - (timestamps[0] & mask)) & mask;
+    gpuFrameTimeMs = static_cast<float>(static_cast<double>(elapsed) *
+                                        deviceProperties.limits.timestampPeriod / 1.0e6);
+    frameBenchmark.addGpuSample(gpuFrameTimeMs);
+
+    if (dynamicResolution) {
+        float scale = resolutionController.update(gpuFrameTimeMs);
+        renderExtent.width = std::max(1u, static_cast<uint32_t>(width * scale + 0.5f));
+        renderExtent.height = std::max(1u, static_cast<uint32_t>(height * scale + 0.5f));
+    }
+}
+
+void VulkanExampleBase::setupPipelineRenderingInfo(VkGraphicsPipelineCreateInfo &pipelineCI,
+                                                   VkPipelineRenderingCreateInfoKHR &renderingCI) {
+    if (!dynamicRendering) {
+        pipelineCI.renderPass = renderPass;
+        return;
+    }
+
+    renderingCI = {};
+    renderingCI.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    renderingCI.colorAttachmentCount = 1;
+    renderingCI.pColorAttachmentFormats = &colorFormat;
+    renderingCI.depthAttachmentFormat = depthFormat;
+    if (depthFormat >= VK_FORMAT_D16_UNORM_S8_UINT) {
+        renderingCI.stencilAttachmentFormat = depthFormat;
+    }
+    renderingCI.pNext = pipelineCI.pNext;
+    pipelineCI.pNext = &renderingCI;
+    pipelineCI.renderPass = VK_NULL_HANDLE;
+}
+
+bool VulkanExampleBase::extensionSupported(const std::string &extension) {
+    return std::find(supportedDeviceExtensions.begin(), supportedDeviceExtensions.end(),
+                     extension) != supportedDeviceExtensions.end();
+}
+
+uint32_t
+VulkanExampleBase::getMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties) {
+    uint32_t typeIndex = 0;
+    if (getMemoryTypeIndex(typeBits, properties, &typeIndex)) {
+        return typeIndex;
+    }
+    LOGE("Could not find suitable memory type!");
+    return 0;
+}
+
+bool VulkanExampleBase::getMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties,
+                                           uint32_t *typeIndex) {
+    for (uint32_t i = 0; i < deviceMemoryProperties.memoryTypeCount; i++) {
+        if ((typeBits & 1) == 1) {
+            if ((deviceMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                *typeIndex = i;
+                return true;
+            }
+        }
+        typeBits >>= 1;
+    }
+    return false;
+}
+
+VkResult VulkanExampleBase::allocateMemory(const VkMemoryAllocateInfo &allocInfo,
+                                           MemoryCategory category, VkDeviceMemory *memory) {
+    VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, memory);
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to allocate %llu bytes for %s",
+             static_cast<unsigned long long>(allocInfo.allocationSize),
+             MemoryTracker::categoryName(category));
+        logMemoryStats();
+        return result;
+    }
+
+    uint32_t heapIndex = deviceMemoryProperties.memoryTypes[allocInfo.memoryTypeIndex].heapIndex;
+    memoryAllocations[*memory] = {category, heapIndex, allocInfo.allocationSize};
+    debugUtils.setObjectName(VK_OBJECT_TYPE_DEVICE_MEMORY, *memory, "%s memory",
+                             MemoryTracker::categoryName(category));
+    memoryTracker.recordAllocation(category, heapIndex, allocInfo.allocationSize);
+    checkMemoryBudgets();
+    return result;
+}
+
+void VulkanExampleBase::freeMemory(VkDeviceMemory memory) {
+    if (memory == VK_NULL_HANDLE) {
+        return;
+    }
+    auto allocation = memoryAllocations.find(memory);
+    if (allocation != memoryAllocations.end()) {
+        memoryTracker.recordFree(allocation->second.category, allocation->second.heapIndex,
+                                 allocation->second.size);
+        memoryAllocations.erase(allocation);
+    } else {
+        LOGW("Freeing untracked device memory");
+    }
+    vkFreeMemory(device, memory, nullptr);
+}
+
+void VulkanExampleBase::updateMemoryBudget() {
+    framesSinceMemoryBudgetUpdate = 0;
+    if (memoryBudget) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        VkPhysicalDeviceMemoryProperties2 memoryProperties2{};
+        memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memoryProperties2.pNext = &budgetProperties;
+        vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &memoryProperties2);
+
+        for (uint32_t i = 0; i < memoryProperties2.memoryProperties.memoryHeapCount; i++) {
+            memoryTracker.setHeapBudget(i, budgetProperties.heapBudget[i],
+                                        budgetProperties.heapUsage[i]);
+        }
+    }
+    checkMemoryBudgets();
+}
+
+void VulkanExampleBase::checkMemoryBudgets() {
+    uint32_t warnings = memoryTracker.checkBudgets();
+    for (uint32_t i = 0; warnings != 0; i++, warnings >>= 1) {
+        if (warnings & 1) {
+            memoryBudgetWarning(i, memoryTracker.getSnapshot());
+        }
+    }
+}
+
+void VulkanExampleBase::memoryBudgetWarning(uint32_t heapIndex,
+                                            const MemoryTracker::Snapshot &snapshot) {
+    const MemoryTracker::HeapStats &heap = snapshot.heaps[heapIndex];
+    uint64_t usage = snapshot.driverBudget ? heap.estimatedUsage() : heap.engineBytes;
+    LOGW("Memory heap %u at %.1f of %.1f MB budget", heapIndex,
+         static_cast<double>(usage) / (1024.0 * 1024.0),
+         static_cast<double>(heap.budget) / (1024.0 * 1024.0));
+    logMemoryStats();
+}
+
+void VulkanExampleBase::logMemoryStats() {
+    const MemoryTracker::Snapshot &snapshot = memoryTracker.getSnapshot();
+    const double mb = 1024.0 * 1024.0;
+    LOGI("Device memory: %.2f MB allocated, high-water %.2f MB (%s budget)",
+         static_cast<double>(snapshot.totalBytes) / mb,
+         static_cast<double>(snapshot.totalHighWater) / mb,
+         snapshot.driverBudget ? "driver" : "heap size");
+    for (size_t i = 0; i < MemoryTracker::CATEGORY_COUNT; i++) {
+        const MemoryTracker::CategoryStats &category = snapshot.categories[i];
+        LOGI("  %s: %u allocations, %.2f MB, high-water %.2f MB",
+             MemoryTracker::categoryName(static_cast<MemoryCategory>(i)), category.allocations,
+             static_cast<double>(category.bytes) / mb, static_cast<double>(category.highWater) / mb);
+    }
+    for (uint32_t i = 0; i < snapshot.heapCount; i++) {
+        const MemoryTracker::HeapStats &heap = snapshot.heaps[i];
+        LOGI("  heap %u%s: usage %.2f MB of %.2f MB budget, engine %.2f MB", i,
+             heap.deviceLocal ? " (device local)" : "",
+             static_cast<double>(heap.estimatedUsage()) / mb,
+             static_cast<double>(heap.budget) / mb,
+             static_cast<double>(heap.engineBytes) / mb);
+    }
+}
+
+uint32_t VulkanExampleBase::getTransientMemoryTypeIndex(uint32_t typeBits) {
+    // Tile-based GPUs expose lazily allocated memory that is only backed on demand,
+    // so transient attachments cost no physical memory at all
+    uint32_t typeIndex = 0;
+    if (getMemoryTypeIndex(typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                     VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &typeIndex)) {
+        return typeIndex;
+    }
+    return getMemoryTypeIndex(typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+VkSampleCountFlagBits VulkanExampleBase::getMaxUsableSampleCount() {
+    // Color and depth share the subpass, so both limits apply
+    VkSampleCountFlags counts = deviceProperties.limits.framebufferColorSampleCounts &
+                                deviceProperties.limits.framebufferDepthSampleCounts;
+    for (VkSampleCountFlagBits candidate: {VK_SAMPLE_COUNT_4_BIT, VK_SAMPLE_COUNT_2_BIT}) {
+        if (candidate <= requestedSampleCount && (counts & candidate)) {
+            LOGI("Using %dx MSAA", static_cast<int>(candidate));
+            return candidate;
+        }
+    }
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+
+VkShaderModule VulkanExampleBase::loadShader(const std::string &filename) {
+    LOGI("Loading shader: %s", filename.c_str());
+
+    // Use the code read ahead during startup if there is any
+    std::vector<char> code;
+    {
+        std::lock_guard<std::mutex> lock(shaderCacheMutex);
+        auto cached = shaderCache.find(filename);
+        if (cached != shaderCache.end()) {
+            code = std::move(cached->second);
+            shaderCache.erase(cached);
+        }
+    }
+    if (code.empty() && !readAsset(filename, code)) {
+        LOGE("FATAL: Could not open shader file: %s", filename.c_str());
+        LOGE("Make sure shader files are compiled and placed in assets/shaders/");
+        return VK_NULL_HANDLE;
+    }
+    LOGI("Shader file size: %zu bytes", code.size());
 
     VkShaderModuleCreateInfo shaderModuleCI{};
     shaderModuleCI.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    shaderModuleCI.codeSize = size;
-    shaderModuleCI.pCode = reinterpret_cast<const uint32_t *>(code);
+    shaderModuleCI.codeSize = code.size();
+    shaderModuleCI.pCode = reinterpret_cast<const uint32_t *>(code.data());
 
     VkShaderModule shaderModule;
     VK_CHECK_RESULT(vkCreateShaderModule(device, &shaderModuleCI, nullptr, &shaderModule));
+    debugUtils.setObjectName(VK_OBJECT_TYPE_SHADER_MODULE, shaderModule, "%s", filename.c_str());
 
-    delete[] code;
     LOGI("Shader loaded successfully: %s", filename.c_str());
     return shaderModule;
 }
 
+bool VulkanExampleBase::readAsset(const std::string &filename, std::vector<char> &data) {
+    // AAssetManager may be used from any thread, each read opens its own asset
+    AAsset *asset = AAssetManager_open(androidApp->activity->assetManager, filename.c_str(),
+                                       AASSET_MODE_BUFFER);
+    if (!asset) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(AAsset_getLength(asset)));
+    int read = AAsset_read(asset, data.data(), data.size());
+    AAsset_close(asset);
+    return read == static_cast<int>(data.size());
+}
+
+void VulkanExampleBase::preloadShader(const std::string &filename) {
+    std::vector<char> code;
+    if (readAsset(filename, code)) {
+        std::lock_guard<std::mutex> lock(shaderCacheMutex);
+        shaderCache[filename] = std::move(code);
+    }
+}
+
 void VulkanExampleBase::setImageLayout(
         VkCommandBuffer cmdBuffer,
         VkImage image,
@@ -634,47 +2926,196 @@ void VulkanExampleBase::setImageLayout(
                          &barrier);
 }
 
+// CPU time of the calling thread, excludes time blocked in waits
+static double threadCpuTimeMs() {
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) * 1.0e3 + static_cast<double>(time.tv_nsec) / 1.0e6;
+}
+
 void VulkanExampleBase::renderLoop() {
+    using Clock = std::chrono::steady_clock;
     int events;
     android_poll_source *source;
+    Clock::time_point nextFrameTime = Clock::now();
+    Clock::time_point lastStatsReport = Clock::now();
 
-    // Use the same do-while pattern as the reference app:
-    // - Poll ONE event per iteration (not drain all events)
-    // - When not prepared: block with -1 to wait for APP_CMD_INIT_WINDOW
-    // - When prepared: use 0 for non-blocking so we can render immediately
+    // Poll ONE event per iteration (not drain all events). The timeout depends on the
+    // state: blocking (-1) without a window or while paused, so nothing spins; 0 while
+    // rendering continuously; the time left until the next frame with a frame rate cap.
     do {
-        if (ALooper_pollOnce(prepared ? 0 : -1, nullptr, &events, (void **) &source) >= 0) {
-            if (source != nullptr) {
-                source->process(source->app, source);
-            }
+        RenderLoopState state = evaluateRenderLoopState();
+        Clock::time_point pollStart = Clock::now();
+        int result = ALooper_pollOnce(getPollTimeout(state, nextFrameTime), nullptr, &events,
+                                      (void **) &source);
+        if (result >= 0 && source != nullptr) {
+            source->process(source->app, source);
+        }
+        if (result == ALOOPER_POLL_WAKE) {
+            renderLoopStats.wakeups++;
+        }
+        renderLoopStats.pollSeconds[static_cast<size_t>(state)] +=
+                std::chrono::duration<double>(Clock::now() - pollStart).count();
+
+        // Copy GameActivity input events into the input queue, any input makes an on
+        // demand frame due
+        if (androidApp != nullptr && inputQueue.collect(androidApp)) {
+            renderRequested = true;
+        }
+
+        // App commands may have changed the state
+        state = evaluateRenderLoopState();
+        if (state != renderLoopState) {
+            LOGI("Render loop state %u -> %u", static_cast<uint32_t>(renderLoopState),
+                 static_cast<uint32_t>(state));
+            renderLoopState = state;
+            nextFrameTime = Clock::now();
         }
 
-        // Process GameActivity input events
-        if (androidApp != nullptr) {
-            android_input_buffer *inputBuffer = android_app_swap_input_buffers(androidApp);
-            if (inputBuffer != nullptr) {
-                if (inputBuffer->motionEventsCount > 0) {
-                    android_app_clear_motion_events(inputBuffer);
+        // Render frame if ready and due
+        Clock::time_point now = Clock::now();
+        if (state == RenderLoopState::Active && now >= nextFrameTime) {
+            renderRequested = false;
+            // Hand this frame's merged moves to the scene update
+            inputQueue.flush();
+            double cpuStartMs = threadCpuTimeMs();
+            render();
+            if (frameBenchmark.active()) {
+                frameBenchmark.addCpuSample(threadCpuTimeMs() - cpuStartMs);
+                if (frameBenchmark.complete()) {
+                    finishBenchmark();
                 }
-                if (inputBuffer->keyEventsCount > 0) {
-                    android_app_clear_key_events(inputBuffer);
+            }
+            if (firstFramePending) {
+                firstFramePending = false;
+                LOGI("Time to first frame after %s: %.1f ms",
+                     windowResumed ? "resume" : "cold start",
+                     std::chrono::duration<double, std::milli>(Clock::now() - windowStartTime).count());
+            }
+            renderLoopStats.frames++;
+            renderLoopStats.renderSeconds[static_cast<size_t>(state)] +=
+                    std::chrono::duration<double>(Clock::now() - now).count();
+
+            if (frameRateLimit > 0) {
+                // Advance by whole intervals; after a late frame pace from now
+                nextFrameTime += std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(1.0 / frameRateLimit));
+                if (nextFrameTime < now) {
+                    nextFrameTime = now;
                 }
             }
         }
 
-        // Render frame if ready
-        if (prepared && !paused) {
-            render();
+        if (Clock::now() - lastStatsReport > std::chrono::seconds(10)) {
+            reportRenderLoopStats();
+            lastStatsReport = Clock::now();
         }
     } while (androidApp == nullptr || androidApp->destroyRequested == 0);
 
     LOGI("Exiting render loop");
+    reportRenderLoopStats();
     if (device != VK_NULL_HANDLE) {
-        vkDeviceWaitIdle(device);
+        logMemoryStats();
+        // Every submission signals the timeline, so its newest value covers all GPU work
+        waitForTimelineValue(timelineValue);
+        deletionQueue.collect(getCompletedTimelineValue());
+        deliverReadbacks(completedTimelineValue);
+        frameReadback.flush();
+        FrameReadback::Stats readbackStats = frameReadback.getStats();
+        if (readbackStats.captured > 0 || readbackStats.dropped > 0) {
+            LOGI("Frame readback: %llu captured, %llu dropped, %llu write errors",
+                 static_cast<unsigned long long>(readbackStats.captured),
+                 static_cast<unsigned long long>(readbackStats.dropped),
+                 static_cast<unsigned long long>(readbackStats.writeErrors));
+        }
+        savePipelineCache();
     }
     cleanup();
 }
 
+void VulkanExampleBase::requestRender() {
+    renderRequested = true;
+    if (androidApp != nullptr && androidApp->looper != nullptr) {
+        ALooper_wake(androidApp->looper);
+    }
+}
+
+VulkanExampleBase::RenderLoopState VulkanExampleBase::evaluateRenderLoopState() const {
+    if (!prepared) {
+        return RenderLoopState::WaitingForWindow;
+    }
+    if (paused) {
+        return RenderLoopState::Paused;
+    }
+    if (renderMode == RenderMode::OnDemand && !renderRequested) {
+        return RenderLoopState::Idle;
+    }
+    return RenderLoopState::Active;
+}
+
+int VulkanExampleBase::getPollTimeout(RenderLoopState state,
+                                      std::chrono::steady_clock::time_point nextFrameTime) const {
+    switch (state) {
+        case RenderLoopState::WaitingForWindow:
+        case RenderLoopState::Paused:
+            return -1;
+        case RenderLoopState::Idle:
+            return idlePollTimeoutMs;
+        case RenderLoopState::Active:
+        default:
+            break;
+    }
+    if (frameRateLimit == 0) {
+        return 0;
+    }
+    // Sleep in the looper until the frame deadline, events still wake it early. Rounded
+    // up, truncating would return 0 and spin for the last fraction of a millisecond
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+            nextFrameTime - std::chrono::steady_clock::now());
+    return std::max(0, static_cast<int>(remaining.count()));
+}
+
+void VulkanExampleBase::reportRenderLoopStats() {
+    static const char *stateNames[] = {"waiting", "paused", "idle", "active"};
+    for (size_t i = 0; i < static_cast<size_t>(RenderLoopState::Count); i++) {
+        if (renderLoopStats.pollSeconds[i] > 0.0 || renderLoopStats.renderSeconds[i] > 0.0) {
+            LOGI("Render loop %s: poll %.1f ms, render %.1f ms", stateNames[i],
+                 renderLoopStats.pollSeconds[i] * 1000.0,
+                 renderLoopStats.renderSeconds[i] * 1000.0);
+        }
+    }
+    LOGI("Render loop: %llu frames, %llu wakeups",
+         static_cast<unsigned long long>(renderLoopStats.frames),
+         static_cast<unsigned long long>(renderLoopStats.wakeups));
+    renderLoopStats = {};
+
+    LatencyTracker::Report latency = latencyTracker.takeReport();
+    if (latency.frames > 0) {
+        const char *source = latency.presentSource == LatencyTracker::PresentSource::DisplayTiming
+                             ? "display timing" : "GPU completion estimate";
+        LOGI("Latency (%s): %llu frames, %llu lost, queued frames avg %.2f max %u", source,
+             static_cast<unsigned long long>(latency.frames),
+             static_cast<unsigned long long>(latency.lostFrames),
+             latency.averageQueuedFrames, latency.maxQueuedFrames);
+        LOGI("CPU to present: p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms",
+             latency.cpuToPresent.p50Ms, latency.cpuToPresent.p90Ms,
+             latency.cpuToPresent.p99Ms, latency.cpuToPresent.maxMs);
+        LOGI("CPU to submit: p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms",
+             latency.cpuToSubmit.p50Ms, latency.cpuToSubmit.p90Ms,
+             latency.cpuToSubmit.p99Ms, latency.cpuToSubmit.maxMs);
+    }
+    if (latency.inputToPresent.count > 0) {
+        LOGI("Input to present: %u frames, p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms",
+             latency.inputToPresent.count, latency.inputToPresent.p50Ms,
+             latency.inputToPresent.p90Ms, latency.inputToPresent.p99Ms,
+             latency.inputToPresent.maxMs);
+    }
+    if (inputQueue.getDroppedCount() > 0) {
+        LOGW("Input queue full, %llu events dropped",
+             static_cast<unsigned long long>(inputQueue.getDroppedCount()));
+    }
+}
+
 // Static callback handler
 void VulkanExampleBase::handleAppCommand(android_app *app, int32_t cmd) {
     VulkanExampleBase *example = reinterpret_cast<VulkanExampleBase *>(app->userData);
@@ -692,24 +3133,52 @@ void VulkanExampleBase::handleAppCommandInternal(int32_t cmd) {
         case APP_CMD_INIT_WINDOW:
             LOGI("APP_CMD_INIT_WINDOW received");
             if (androidApp->window != nullptr) {
-                initVulkan(androidApp);
-                prepare();
-                LOGI("Vulkan initialized and prepared, ready to render");
+                auto start = std::chrono::steady_clock::now();
+                const bool resume = device != VK_NULL_HANDLE;
+                if (resume) {
+                    // Device, memory, pipelines and uploaded data survived the window loss
+                    resumeWindow();
+                } else {
+                    startup();
+                }
+                windowStartTime = start;
+                windowResumed = resume;
+                firstFramePending = true;
+                renderRequested = true;
+                LOGI("Vulkan %s in %.1f ms, ready to render", resume ? "resumed" : "initialized",
+                     std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start).count());
             } else {
                 LOGW("APP_CMD_INIT_WINDOW: window is null!");
             }
             break;
         case APP_CMD_TERM_WINDOW:
             LOGI("APP_CMD_TERM_WINDOW received");
-            cleanup();
+            // Only the surface and window sized objects go away, the device is kept.
+            // The app may be killed in the background, so persist the pipeline cache now.
+            prepared = false;
+            if (device != VK_NULL_HANDLE) {
+                destroyWindowResources();
+                savePipelineCache();
+            }
             break;
         case APP_CMD_GAINED_FOCUS:
             LOGI("APP_CMD_GAINED_FOCUS");
             paused = false;
+            pauseChanged();
+            renderRequested = true;
             break;
         case APP_CMD_LOST_FOCUS:
             LOGI("APP_CMD_LOST_FOCUS");
             paused = true;
+            pauseChanged();
+            break;
+        case APP_CMD_LOW_MEMORY:
+            LOGW("APP_CMD_LOW_MEMORY");
+            if (device != VK_NULL_HANDLE) {
+                updateMemoryBudget();
+                logMemoryStats();
+            }
             break;
         default:
             LOGD("Unhandled app command: %d", cmd);
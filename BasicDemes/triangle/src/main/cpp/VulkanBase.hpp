@@ -12,9 +12,30 @@
 #include <android/log.h>
 #include <android/asset_manager.h>
 
+#include "DynamicResolution.hpp"
+#include "InputQueue.hpp"
+#include "LatencyTracker.hpp"
+#include "MemoryTracker.hpp"
+#include "DeletionQueue.hpp"
+#include "JobSystem.hpp"
+#include "StartupScheduler.hpp"
+#include "DebugUtils.hpp"
+#include "DeviceSelector.hpp"
+#include "FrameReadback.hpp"
+#include "FrameBenchmark.hpp"
+#include "Ktx2.hpp"
+#include "MipStreamer.hpp"
+#include "MipGenerator.hpp"
+#include "SamplerCache.hpp"
+#include "BindlessTable.hpp"
+
 #include <vector>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <cassert>
 #include <cstring>
 
@@ -38,6 +59,9 @@
 // Maximum number of concurrent frames
 constexpr uint32_t MAX_CONCURRENT_FRAMES = 2;
 
+// Minimum job system workers during startup, whose tasks mostly wait on file reads
+constexpr uint32_t STARTUP_MIN_WORKERS = 3;
+
 /**
  * @brief Vulkan Example Base Class
  * 
@@ -58,6 +82,103 @@ public:
         VkImageView view;
     };
 
+    // Multisampled color target, resolved into the swapchain image at the end of the subpass
+    struct MultisampleTarget {
+        VkImage image;
+        VkDeviceMemory memory;
+        VkImageView view;
+    };
+
+    // Sampled color target the scene is rendered to when dynamic resolution is enabled
+    struct OffscreenTarget {
+        VkImage image;
+        VkDeviceMemory memory;
+        VkImageView view;
+        VkFramebuffer frameBuffer;
+    };
+
+    // Continuous rendering, or rendering only after requestRender()/input
+    enum class RenderMode {
+        Continuous,
+        OnDemand
+    };
+
+    // Render loop states; blocking states sleep in the looper instead of polling
+    enum class RenderLoopState : uint32_t {
+        WaitingForWindow,  // No window/device yet, block until an app command arrives
+        Paused,            // Focus lost, block until an app command arrives
+        Idle,              // On demand mode with nothing to draw
+        Active,            // Rendering
+        Count
+    };
+
+    // Wall time spent per state, split into looper polling/sleeping and rendering
+    struct RenderLoopStats {
+        std::array<double, static_cast<size_t>(RenderLoopState::Count)> pollSeconds{};
+        std::array<double, static_cast<size_t>(RenderLoopState::Count)> renderSeconds{};
+        uint64_t frames = 0;
+        uint64_t wakeups = 0;
+    };
+
+    // Buffer handed from one queue family to another, e.g. written by compute and read by
+    // graphics. Release on the source queue, acquire on the destination queue; with equal
+    // families only acquire records a (plain) barrier.
+    struct BufferHandoff {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = VK_WHOLE_SIZE;
+        uint32_t srcQueueFamily = 0;
+        uint32_t dstQueueFamily = 0;
+        VkAccessFlags srcAccessMask = 0;
+        VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkAccessFlags dstAccessMask = 0;
+        VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    };
+
+    // Sampled 2D texture. KTX2 textures stream their mip levels in from the smallest; until
+    // the stream completes shaders clamp their LOD to getMinLod(). Streaming textures are
+    // referenced by address, so a texture must not move between load and destroy.
+    struct Texture {
+        std::string name;
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkSampler sampler = VK_NULL_HANDLE;  // Owned by samplerCache
+        // Index in bindlessTable's texture array, if bindless is enabled
+        uint32_t bindlessHandle = BindlessTable::INVALID_HANDLE;
+        VkFormat format = VK_FORMAT_UNDEFINED;  // On the GPU; RGBA8 if decoded on the CPU
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t levelCount = 0;
+        bool decoded = false;
+        // Source file until every level is uploaded
+        std::vector<char> fileData;
+        Ktx2 file;
+        MipStreamer streamer;
+
+        float getMinLod() const { return static_cast<float>(streamer.getResidentLevel()); }
+    };
+
+    // Host visible buffer a readback slot copies into, mapped for its whole lifetime
+    struct ReadbackBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint8_t* mapped = nullptr;
+        VkDeviceSize size = 0;
+        bool coherent = false;
+    };
+
+    // Full-screen pass upscaling the offscreen target into the swapchain image
+    struct UpscalePass {
+        VkRenderPass renderPass;
+        VkSampler sampler;
+        VkDescriptorSetLayout descriptorSetLayout;
+        VkDescriptorPool descriptorPool;
+        VkDescriptorSet descriptorSet;
+        VkPipelineLayout pipelineLayout;
+        VkPipeline pipeline;
+    };
+
 protected:
     // Android app context
     android_app* androidApp = nullptr;
@@ -69,10 +190,36 @@ protected:
     VkQueue queue = VK_NULL_HANDLE;
     uint32_t queueFamilyIndex = 0;
 
+    // Selected physical device and queue families. computeQueue and transferQueue are
+    // separate queues only if the device has dedicated families, otherwise they are the
+    // graphics queue; see deviceSelection.queueFamilies before submitting to them
+    DeviceSelector::Selection deviceSelection;
+    VkQueue computeQueue = VK_NULL_HANDLE;
+    VkQueue transferQueue = VK_NULL_HANDLE;
+
     // Physical device properties
     VkPhysicalDeviceProperties deviceProperties{};
     VkPhysicalDeviceFeatures deviceFeatures{};
+    // Core features turned on at device creation, a subset of deviceFeatures
+    VkPhysicalDeviceFeatures enabledFeatures{};
     VkPhysicalDeviceMemoryProperties deviceMemoryProperties{};
+    std::vector<std::string> supportedDeviceExtensions;
+
+    // Object names and command buffer labels (VK_EXT_debug_utils), compiled out unless
+    // VULKAN_DEBUG_UTILS is set
+    bool debugUtilsInstanceExtension = false;
+    DebugUtils debugUtils;
+
+    // Device memory accounting; heap budgets come from VK_EXT_memory_budget if supported
+    struct MemoryAllocation {
+        MemoryCategory category;
+        uint32_t heapIndex;
+        VkDeviceSize size;
+    };
+    bool memoryBudget = false;
+    MemoryTracker memoryTracker;
+    std::unordered_map<VkDeviceMemory, MemoryAllocation> memoryAllocations;
+    uint32_t framesSinceMemoryBudgetUpdate = 0;
 
     // Surface and swapchain
     VkSurfaceKHR surface = VK_NULL_HANDLE;
@@ -86,21 +233,114 @@ protected:
     VkFormat depthFormat = VK_FORMAT_UNDEFINED;
     DepthStencil depthStencil{};
 
-    // Render pass and framebuffers
+    // Multisampling (color and depth are transient and lazily allocated when available)
+    VkSampleCountFlagBits sampleCount = VK_SAMPLE_COUNT_1_BIT;
+    MultisampleTarget multisampleTarget{};
+
+    // Render pass and framebuffers (not created when dynamic rendering is used)
     VkRenderPass renderPass = VK_NULL_HANDLE;
     std::vector<VkFramebuffer> frameBuffers;
 
+    // Dynamic resolution: the scene renders into the top-left renderExtent of an offscreen
+    // target sized to the swapchain, so scale changes never reallocate anything
+    bool dynamicResolution = false;
+    OffscreenTarget offscreenTarget{};
+    UpscalePass upscalePass{};
+    DynamicResolutionController resolutionController;
+    VkExtent2D renderExtent{};
+
+    // GPU frame timing (two timestamp queries per frame slot)
+    bool gpuTimestamps = false;
+    uint32_t timestampValidBits = 0;
+    VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+    std::array<bool, MAX_CONCURRENT_FRAMES> timestampsWritten{};
+    float gpuFrameTimeMs = 0.0f;
+
+    // Bindless resources (VK_EXT_descriptor_indexing): textures and storage buffers in one
+    // update-after-bind set, indexed by handles passed to shaders
+    bool bindless = false;
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties{};
+    BindlessTable bindlessTable;
+
+    // Dynamic rendering (VK_KHR_dynamic_rendering)
+    bool dynamicRendering = false;
+    PFN_vkCmdBeginRenderingKHR vkCmdBeginRenderingKHR = nullptr;
+    PFN_vkCmdEndRenderingKHR vkCmdEndRenderingKHR = nullptr;
+
     // Command pool and buffers
     VkCommandPool commandPool = VK_NULL_HANDLE;
     std::array<VkCommandBuffer, MAX_CONCURRENT_FRAMES> commandBuffers{};
 
-    // Synchronization
+    // Async compute: with a separate compute family and timeline semaphores, compute command
+    // buffers go to computeQueue and signal their own timeline, which the frame's graphics
+    // submission waits for. Compute for frame N then overlaps graphics of frame N-1.
+    // Otherwise they are submitted to the graphics queue ahead of the frame.
+    bool asyncCompute = false;
+    uint32_t computeQueueFamilyIndex = 0;
+    VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+    std::array<VkCommandBuffer, MAX_CONCURRENT_FRAMES> computeCommandBuffers{};
+    VkSemaphore computeTimelineSemaphore = VK_NULL_HANDLE;
+    uint64_t computeTimelineValue = 0;
+    std::array<uint64_t, MAX_CONCURRENT_FRAMES> computeFrameTimelineValues{};
+    // Compute value and stages the next frame submission waits for (0 = none)
+    uint64_t frameComputeWaitValue = 0;
+    VkPipelineStageFlags frameComputeWaitStages = 0;
+
+    // Synchronization (binary semaphores are only used for swapchain acquire/present)
     std::array<VkSemaphore, MAX_CONCURRENT_FRAMES> presentCompleteSemaphores{};
     std::array<VkSemaphore, MAX_CONCURRENT_FRAMES> renderCompleteSemaphores{};
+    // Fallback when timeline semaphores are not supported
     std::array<VkFence, MAX_CONCURRENT_FRAMES> waitFences{};
 
-    // Pipeline cache
+    // Timeline semaphore (VK_KHR_timeline_semaphore) tracking frame and transfer progress.
+    // Every submission signals the next value; a frame slot can be reused once its value is reached.
+    bool timelineSemaphores = false;
+    VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+    uint64_t timelineValue = 0;
+    uint64_t completedTimelineValue = 0;
+    std::array<uint64_t, MAX_CONCURRENT_FRAMES> frameTimelineValues{};
+    // Newest upload the next frame has to wait for on the GPU
+    uint64_t uploadTimelineValue = 0;
+    // Resources destroyed once the timeline passes the submission that last used them
+    DeletionQueue deletionQueue;
+    PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR = nullptr;
+    PFN_vkGetSemaphoreCounterValueKHR vkGetSemaphoreCounterValueKHR = nullptr;
+
+    // Frame readback: copies recorded into the frame go to a ring of host visible buffers,
+    // which are only read once the frame's timeline value has completed
+    bool swapchainReadback = false;  // Swapchain images were created with transfer reads
+    FrameReadback frameReadback;
+    std::array<ReadbackBuffer, FrameReadback::SLOT_COUNT> readbackBuffers{};
+    int32_t readbackSlot = -1;       // Slot the current frame copies into
+    FrameReadback::Frame readbackFrame{};
+
+    // Benchmark run: adb shell setprop debug.vulkan.benchmark <scenario> renders a fixed
+    // number of frames uncapped, writes <internal data path>/benchmark_<scenario>.json
+    // and finishes the activity. Samples read the scenario in prepare().
+    FrameBenchmark frameBenchmark;
+
+    // Textures with mip levels left to upload. Each frame uploads at most
+    // textureStreamBudget bytes (at least one level per texture), loading uploads up to
+    // textureInitialBudget at once so a texture is usable from its first frame.
+    std::vector<Texture*> streamingTextures;
+    // Samplers are shared by create info and destroyed with the device, never by users
+    SamplerCache samplerCache;
+    MipGenerator mipGenerator;
+    VkDeviceSize textureStreamBudget = 4 * 1024 * 1024;
+    VkDeviceSize textureInitialBudget = 256 * 1024;
+
+    // Worker pool for all CPU side parallel work (startup tasks, culling, ...), started by
+    // startup() with the render thread as its main thread
+    JobSystem jobSystem;
+
+    // Pipeline cache, persisted in the app's internal data path between runs
     VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    std::vector<char> pipelineCacheData;
+
+    // Shader code read ahead during startup, consumed by loadShader()
+    std::vector<std::string> preloadShaderFiles;
+    std::unordered_map<std::string, std::vector<char>> shaderCache;
+    std::mutex shaderCacheMutex;
 
     // State
     bool prepared = false;
@@ -110,9 +350,53 @@ protected:
     uint32_t currentFrame = 0;
     uint32_t currentBuffer = 0;
 
+    // Render loop
+    RenderLoopState renderLoopState = RenderLoopState::WaitingForWindow;
+    RenderLoopStats renderLoopStats{};
+    std::atomic<bool> renderRequested{true};
+
+    // Time to first frame after the window was (re)created
+    std::chrono::steady_clock::time_point windowStartTime{};
+    bool windowResumed = false;
+    bool firstFramePending = false;
+
+    // Input, collected on the main thread and consumed by the scene update
+    InputQueue inputQueue;
+
+    // Frame latency; present times come from VK_GOOGLE_display_timing if supported,
+    // otherwise from observed GPU completion of the frame
+    LatencyTracker latencyTracker;
+    uint32_t latencyFrameId = 0;
+    bool displayTiming = false;
+    std::vector<VkPastPresentationTimingGOOGLE> pastPresentationTimings;
+    PFN_vkGetPastPresentationTimingGOOGLE vkGetPastPresentationTimingGOOGLE = nullptr;
+
     // Settings
     std::string title = "Vulkan Example";
     VkClearColorValue defaultClearColor = {{ 0.025f, 0.025f, 0.025f, 1.0f }};
+    // Requested MSAA sample count, capped by the device's framebuffer sample count limits
+    VkSampleCountFlagBits requestedSampleCount = VK_SAMPLE_COUNT_1_BIT;
+    // Use VK_KHR_dynamic_rendering instead of render pass objects if the device supports it
+    bool enableDynamicRendering = true;
+    // Register textures and buffers in bindlessTable if the device supports descriptor indexing
+    bool enableBindless = false;
+    BindlessTable::Capacity bindlessCapacity;
+    // Render the scene at a GPU time driven fraction of the swapchain extent and upscale
+    bool enableDynamicResolution = false;
+    RenderMode renderMode = RenderMode::Continuous;
+    // Frame rate cap in frames per second (0 = uncapped, paced by present only)
+    uint32_t frameRateLimit = 0;
+    // Longest sleep while idle in on demand mode, bounds input latency when the
+    // GameActivity glue does not wake the looper for input
+    int idlePollTimeoutMs = 16;
+    // Frames between driver memory budget queries
+    uint32_t memoryBudgetInterval = 120;
+    // Submit compute work to a dedicated compute queue if the device has one
+    bool enableAsyncCompute = true;
+    // Create swapchain images with transfer reads so endRendering() can capture them.
+    // Off by default, the extra usage can disable framebuffer compression on some GPUs.
+    // Also enabled by adb shell setprop debug.vulkan.capture <frames>.
+    bool enableSwapchainReadback = false;
 
 public:
     VulkanExampleBase() = default;
@@ -124,20 +408,49 @@ public:
     // Main render loop
     void renderLoop();
 
+    // Ask for a frame in on demand mode, safe to call from any thread
+    void requestRender();
+    const RenderLoopStats& getRenderLoopStats() const { return renderLoopStats; }
+    // Request captures and choose where they go (files or a callback), safe from any thread
+    FrameReadback& getFrameReadback() { return frameReadback; }
+
     // Static callback for Android app commands
     // Note: GameActivity does not use onInputEvent callback
     static void handleAppCommand(android_app* app, int32_t cmd);
 
 protected:
-    // Virtual methods to be overridden by derived classes
+    // Virtual methods to be overridden by derived classes. prepare() runs once per
+    // device on the first window, cleanup() when the render loop exits.
     virtual void prepare();
     virtual void render() = 0;
     virtual void cleanup();
+    // Called when the app gains or loses focus, after paused has been updated
+    virtual void pauseChanged() {}
+    // Add CPU-only startup work (asset reads, mesh processing). These tasks run as jobs
+    // in parallel with instance and device creation and finish before prepare().
+    virtual void addStartupTasks(StartupScheduler& scheduler) {}
+    // Called once when a heap's usage crosses the tracker's warning threshold,
+    // e.g. to drop caches or lower quality before the system kills the app
+    virtual void memoryBudgetWarning(uint32_t heapIndex, const MemoryTracker::Snapshot& snapshot);
+    // Called by resumeWindow() when the new surface has another color format, after the
+    // render passes were recreated; pipelines built for the old format must be rebuilt
+    virtual void colorFormatChanged() {}
 
     // Setup methods
     virtual void setupRenderPass();
     virtual void setupDepthStencil();
+    virtual void setupMultisampleTarget();
+    virtual void setupOffscreenTarget();
+    virtual void setupUpscalePass();
+    void createUpscalePipeline();
     virtual void setupFrameBuffer();
+    void updateUpscaleDescriptorSet();
+
+    // Window lifecycle: the device and everything created by prepare() outlive the
+    // window; only the surface, swapchain and size dependent targets are recreated
+    void setupRenderTargets();
+    void resumeWindow();
+    void destroyWindowResources();
 
     // Helper methods
     void createInstance();
@@ -148,13 +461,34 @@ protected:
     void createCommandBuffers();
     void createSynchronizationPrimitives();
     void createPipelineCache();
+    void createTimestampQueryPool();
+    void createBindlessTable();
     void createDepthStencil();
     void createRenderPass();
     void createFrameBuffers();
 
     // Utility methods
     uint32_t getMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties);
+    bool getMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t* typeIndex);
+    uint32_t getTransientMemoryTypeIndex(uint32_t typeBits);
+    VkSampleCountFlagBits getMaxUsableSampleCount();
+
+    // Device memory allocation with per category accounting, use instead of
+    // vkAllocateMemory/vkFreeMemory
+    VkResult allocateMemory(const VkMemoryAllocateInfo& allocInfo, MemoryCategory category,
+                            VkDeviceMemory* memory);
+    void freeMemory(VkDeviceMemory memory);
+    // Refresh heap budgets from the driver and check them against the warning threshold
+    void updateMemoryBudget();
+    const MemoryTracker::Snapshot& getMemorySnapshot() const { return memoryTracker.getSnapshot(); }
+    void logMemoryStats();
+    bool extensionSupported(const std::string& extension);
     VkShaderModule loadShader(const std::string& filename);
+    bool readAsset(const std::string& filename, std::vector<char>& data);
+    void preloadShader(const std::string& filename);
+    std::string getPipelineCachePath() const;
+    void loadPipelineCacheData();
+    void savePipelineCache();
     void setImageLayout(
         VkCommandBuffer cmdBuffer,
         VkImage image,
@@ -167,7 +501,104 @@ protected:
     // Frame handling
     void prepareFrame();
     void submitFrame();
+    // Mark the current frame as showing input first sampled at this time (InputQueue::nowNs
+    // clock), the latency tracker reports input to present latency for it
+    void setFrameInputTime(int64_t eventTimeNs) { latencyTracker.setInputTime(latencyFrameId, eventTimeNs); }
+    // Close latency records of presented (or GPU completed) frames
+    void updatePresentTimes();
+
+    // Timeline helpers: submit a one-off command buffer (e.g. staging copies) signaling the
+    // next timeline value, block until a value is reached, or poll the reached value.
+    // The next frame submission waits for pending uploads on the GPU, so uploads used
+    // only for rendering need no CPU wait.
+    uint64_t submitUpload(VkCommandBuffer cmdBuffer);
+    void waitForTimelineValue(uint64_t value);
+    uint64_t getCompletedTimelineValue();
+
+    // Compute work of the current frame, recorded between prepareFrame() and submitFrame().
+    // beginComputeCommands() returns the frame slot's compute command buffer, begun.
+    // submitCompute() ends and submits it; the frame's graphics submission waits for it at
+    // graphicsWaitStages; 0 is a bug and waits at all commands instead. A non-zero graphicsValue makes the compute
+    // work wait for that graphics timeline value first (e.g. a previous frame still
+    // reading its output).
+    VkCommandBuffer beginComputeCommands();
+    void submitCompute(VkCommandBuffer cmdBuffer, VkPipelineStageFlags graphicsWaitStages,
+                       uint64_t graphicsValue = 0);
+    // Queue family ownership transfer of a shared exclusive buffer
+    void releaseBuffer(VkCommandBuffer cmdBuffer, const BufferHandoff& handoff);
+    void acquireBuffer(VkCommandBuffer cmdBuffer, const BufferHandoff& handoff);
+
+    // Deferred destruction instead of waiting for the device to idle. Without a value
+    // the resource lives until the next frame submission (including the frame being
+    // recorded) has completed; with one, until that timeline value has completed.
+    // Deleters may run from this class's destructor, after a derived class is gone, so
+    // derived classes capture handles by value rather than this.
+    void retireResource(DeletionQueue::Deleter deleter);
+    void retireResource(uint64_t timelineValue, DeletionQueue::Deleter deleter);
+    void retireBuffer(VkBuffer buffer, VkDeviceMemory memory, uint64_t timelineValue = 0);
+    void retireImage(VkImage image, VkImageView view, VkDeviceMemory memory);
+    void retirePipeline(VkPipeline pipeline);
+
+    // Load textures/<name>.<family>.ktx2, choosing the file from the compressed formats
+    // the device samples natively (see TextureFormats::getLoadOrder). BC files are decoded
+    // on the CPU if nothing fits. Returns false if no variant can be loaded.
+    bool loadTexture(const std::string& name, Texture& texture);
+    // 1x1 RGBA8 texture, e.g. bound in place of a texture that failed to load
+    void createSolidTexture(const std::string& name, const std::array<uint8_t, 4>& rgba, Texture& texture);
+    // Texture from pixels made at runtime (procedural or computed), tightly packed in
+    // format, RGBA8 or a block format TextureFormats knows. The full mip chain is
+    // generated on the GPU when the format allows it, otherwise it has a single level.
+    // Returns false if the format can't be sampled or size doesn't match.
+    bool createTexture(const std::string& name, VkFormat format, uint32_t width, uint32_t height,
+                       const void* pixels, size_t size, Texture& texture);
+    // Retire the texture's resources and stop streaming it
+    void destroyTexture(Texture& texture);
+    // Upload the next mip levels of streaming textures within the frame budget
+    void streamTextures();
+    // Fill levels 1 and up of image from level 0 with the method selected for its
+    // format, which must not be None; the image needs MipGenerator::getRequiredUsage()
+    void generateMipmaps(VkCommandBuffer cmdBuffer, const MipGenerator::Image& image, VkImageLayout finalLayout,
+                         VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask);
+
+    // Copy a color image into the next free readback slot and restore its layout; the
+    // image needs transfer source usage. At most one image per frame is captured. Returns
+    // false if no capture is requested, no slot is free or the format is not 8-bit RGBA/BGRA.
+    bool readbackImage(VkCommandBuffer cmdBuffer, VkImage image, VkImageLayout layout,
+                       VkFormat format, VkExtent2D extent, VkPipelineStageFlags srcStageMask,
+                       VkAccessFlags srcAccessMask);
+    // Hand captures whose frame has completed to the writer thread
+    void deliverReadbacks(uint64_t completedValue);
+
+    // Begin/end rendering the scene, either with a render pass or with dynamic rendering.
+    // The render area is renderExtent; with dynamic resolution endRendering() also records
+    // the upscale into the swapchain image, and with swapchain readback a requested
+    // capture of it. Clear values are ordered color, depth.
+    void beginRendering(VkCommandBuffer cmdBuffer, const std::array<VkClearValue, 2>& clearValues);
+    void endRendering(VkCommandBuffer cmdBuffer);
+    void recordUpscalePass(VkCommandBuffer cmdBuffer);
+
+    // Bracket a frame's command buffer with timestamps, read back once the frame slot is reused
+    void beginGpuFrameTimer(VkCommandBuffer cmdBuffer);
+    void endGpuFrameTimer(VkCommandBuffer cmdBuffer);
+    void updateGpuFrameTime();
+    // Point a pipeline at the render target: sets either renderPass or a chained
+    // VkPipelineRenderingCreateInfoKHR, which must outlive pipeline creation
+    void setupPipelineRenderingInfo(VkGraphicsPipelineCreateInfo& pipelineCI,
+                                    VkPipelineRenderingCreateInfoKHR& renderingCI);
 
 private:
     void handleAppCommandInternal(int32_t cmd);
+    // Cold start: instance, device and prepare() as a parallel startup graph
+    void startup();
+    RenderLoopState evaluateRenderLoopState() const;
+    int getPollTimeout(RenderLoopState state, std::chrono::steady_clock::time_point nextFrameTime) const;
+    void reportRenderLoopStats();
+    void setupFrameCapture();
+    void setupBenchmark();
+    void finishBenchmark();
+    bool createReadbackBuffer(ReadbackBuffer& buffer, VkDeviceSize size);
+    bool formatSupportsSampling(VkFormat format);
+    void createTextureImage(Texture& texture);
+    VkDeviceSize uploadTextureLevels(Texture& texture, uint32_t firstLevel, uint32_t levelCount);
+    void checkMemoryBudgets();
 };
@@ -4,10 +4,16 @@
  */
 
 #include <game-activity/native_app_glue/android_native_app_glue.h>
+#if SAMPLE_PARTICLES
+#include "Particles.hpp"
+using Sample = Particles;
+#else
 #include "Triangle.hpp"
+using Sample = Triangle;
+#endif
 
 // Global instance
-Triangle* vulkanExample = nullptr;
+VulkanExampleBase* vulkanExample = nullptr;
 
 /**
  * @brief Android main entry point for native activity
@@ -15,11 +21,11 @@ Triangle* vulkanExample = nullptr;
 void android_main(android_app* state) {
     LOGI("android_main: Starting Vulkan Example");
 
-    vulkanExample = new Triangle();
+    vulkanExample = new Sample();
     
     // Set up android app reference and callbacks
     state->userData = vulkanExample;
-    state->onAppCmd = Triangle::handleAppCommand;
+    state->onAppCmd = VulkanExampleBase::handleAppCommand;
     
     // Note: GameActivity uses a different input handling mechanism
     // Input events are processed through android_app_swap_input_buffers()
@@ -0,0 +1,12 @@
+#version 450
+
+layout (location = 0) in vec2 inUV;
+layout (location = 1) in vec4 inColor;
+
+layout (location = 0) out vec4 outFragColor;
+
+void main() {
+    // Round sprite with a soft edge; no discard so early depth/stencil stays enabled
+    float falloff = max(1.0 - dot(inUV, inUV), 0.0);
+    outFragColor = vec4(inColor.rgb, inColor.a * falloff);
+}
@@ -0,0 +1,40 @@
+#version 450
+
+// Camera facing quads, one instance per particle in sorted (back to front) order
+
+struct Particle {
+    vec4 position;  // xyz position, w remaining life in seconds
+    vec4 velocity;
+};
+
+struct SortKey {
+    float key;
+    uint index;
+};
+
+layout (std430, binding = 0) readonly buffer Particles { Particle particles[]; };
+layout (std430, binding = 1) readonly buffer SortKeys { SortKey keys[]; };
+
+layout (push_constant) uniform PushConstants {
+    mat4 viewProjection;
+    vec4 cameraRight;  // w: sprite half size
+    vec4 cameraUp;
+} pushConstants;
+
+layout (location = 0) out vec2 outUV;
+layout (location = 1) out vec4 outColor;
+
+void main() {
+    Particle particle = particles[keys[gl_InstanceIndex].index];
+
+    // Triangle strip corners (-1,-1), (1,-1), (-1,1), (1,1)
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1) * 2.0 - 1.0;
+    vec3 offset = (corner.x * pushConstants.cameraRight.xyz + corner.y * pushConstants.cameraUp.xyz) *
+                  pushConstants.cameraRight.w;
+    gl_Position = pushConstants.viewProjection * vec4(particle.position.xyz + offset, 1.0);
+
+    float life = clamp(particle.position.w / 8.0, 0.0, 1.0);
+    float speed = clamp(length(particle.velocity.xyz) * 0.5, 0.0, 1.0);
+    outUV = corner;
+    outColor = vec4(mix(vec3(1.0, 0.35, 0.1), vec3(0.2, 0.6, 1.0), speed), life * 0.6);
+}
@@ -1,11 +1,45 @@
 #version 450
 
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
+
 // Input from vertex shader
 layout (location = 0) in vec3 inColor;
+layout (location = 1) flat in float inTint;
+layout (location = 2) in vec2 inUV;
+
+layout (push_constant) uniform PushConstants {
+    vec4 grid;
+    float textureMinLod;  // Finest mip level uploaded so far
+    uint textureHandle;   // Bindless texture array index
+    uint shaderDataHandle;
+} pushConstants;
+
+#ifdef BINDLESS
+// Every registered texture, selected by handle
+layout (set = 0, binding = 0) uniform sampler2D textures[];
+#define colorMap textures[pushConstants.textureHandle]
+#else
+layout (binding = 1) uniform sampler2D colorMap;
+#endif
+
+// Same constant IDs as the vertex shader
+layout (constant_id = 0) const bool INSTANCED = false;
+layout (constant_id = 1) const bool TEXTURED = false;
 
 // Output color
 layout (location = 0) out vec4 outFragColor;
 
 void main() {
-    outFragColor = vec4(inColor, 1.0);
+    vec3 color = inColor;
+    if (INSTANCED) {
+        color *= inTint;
+    }
+    if (TEXTURED) {
+        // Clamp the LOD so mip levels that are still streaming in are never sampled
+        float lod = max(textureQueryLod(colorMap, inUV).y, pushConstants.textureMinLod);
+        color *= textureLod(colorMap, inUV, lod).rgb;
+    }
+    outFragColor = vec4(color, 1.0);
 }
@@ -1,20 +1,67 @@
 #version 450
 
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
+
+// Instance grid, x: columns, y: spacing, z: triangle scale; the LOD clamp and the
+// texture handle are for the fragment shader
+layout (push_constant) uniform PushConstants {
+    vec4 grid;
+    float textureMinLod;
+    uint textureHandle;
+    uint shaderDataHandle;
+} pushConstants;
+
+#ifdef BINDLESS
+// Matrices of every frame in the bindless storage buffer array, selected by handle
+layout (set = 0, binding = 1) readonly buffer ShaderData {
+    mat4 projectionMatrix;
+    mat4 modelMatrix;
+    mat4 viewMatrix;
+} shaderData[];
+#define ubo shaderData[pushConstants.shaderDataHandle]
+#else
 // Uniform buffer for matrices
 layout (binding = 0) uniform UBO {
     mat4 projectionMatrix;
     mat4 modelMatrix;
     mat4 viewMatrix;
 } ubo;
+#endif
+
+// Specialized per pipeline variant; without instancing the grid math is compiled out
+layout (constant_id = 0) const bool INSTANCED = false;
 
 // Vertex attributes
 layout (location = 0) in vec3 inPos;
 layout (location = 1) in vec3 inColor;
+// Grid cell of the instance, from the list of instances that passed frustum culling
+layout (location = 2) in uint inInstance;
 
 // Output to fragment shader
 layout (location = 0) out vec3 outColor;
+layout (location = 1) flat out float outTint;
+layout (location = 2) out vec2 outUV;
 
 void main() {
     outColor = inColor;
-    gl_Position = ubo.projectionMatrix * ubo.viewMatrix * ubo.modelMatrix * vec4(inPos, 1.0);
+    outTint = 1.0;
+    // The triangle spans [-1, 1], mapped onto the texture once
+    outUV = inPos.xy * 0.5 + 0.5;
+    vec3 localPos = inPos;
+    vec2 offset = vec2(0.0);
+    if (INSTANCED) {
+        // Instances are laid out on a grid centered on the origin, each a little darker
+        // or lighter than its neighbours
+        uint instance = inInstance;
+        uint columns = uint(pushConstants.grid.x);
+        vec2 cell = vec2(instance % columns, instance / columns) - 0.5 * float(columns - 1);
+        localPos *= pushConstants.grid.z;
+        offset = cell * pushConstants.grid.y;
+        outTint = 0.75 + 0.25 * fract(float(instance) * 0.618034);
+    }
+    vec4 position = ubo.modelMatrix * vec4(localPos, 1.0);
+    position.xy += offset;
+    gl_Position = ubo.projectionMatrix * ubo.viewMatrix * position;
 }
@@ -0,0 +1,20 @@
+#version 450
+
+// Offscreen scene color
+layout (binding = 0) uniform sampler2D samplerColor;
+
+layout (push_constant) uniform PushConstants {
+    vec2 uvScale;
+    vec2 uvClamp;
+} pushConstants;
+
+// Input from vertex shader
+layout (location = 0) in vec2 inUV;
+
+// Output color
+layout (location = 0) out vec4 outFragColor;
+
+void main() {
+    // Clamp to the last rendered texel center so bilinear filtering never reads outside the sub-rectangle
+    outFragColor = texture(samplerColor, min(inUV, pushConstants.uvClamp));
+}
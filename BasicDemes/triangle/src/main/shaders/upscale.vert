@@ -0,0 +1,17 @@
+#version 450
+
+// Scale and clamp of the rendered sub-rectangle inside the offscreen target
+layout (push_constant) uniform PushConstants {
+    vec2 uvScale;
+    vec2 uvClamp;
+} pushConstants;
+
+// Output to fragment shader
+layout (location = 0) out vec2 outUV;
+
+void main() {
+    // Full-screen triangle generated from the vertex index
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    outUV = uv * pushConstants.uvScale;
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}